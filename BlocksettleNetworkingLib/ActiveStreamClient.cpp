@@ -29,6 +29,11 @@ bool ActiveStreamClient::sendRawData(const std::string& data)
    return serverConnection_->sendRawData(connectionId_, data);
 }
 
+bool ActiveStreamClient::sendFramed(const std::shared_ptr<const std::string>& rawData)
+{
+   return serverConnection_->sendSharedRawData(connectionId_, rawData);
+}
+
 void ActiveStreamClient::notifyOnData(const std::string& data)
 {
    serverConnection_->notifyListenerOnData(connectionId_, data);
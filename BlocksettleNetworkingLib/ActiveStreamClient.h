@@ -37,6 +37,12 @@ public:
 public:
    virtual bool send(const std::string& data) = 0;
 
+   // framed data as passed to the stream, empty on error
+   virtual std::string frame(const std::string& data) const = 0;
+
+   // sends already framed data, the buffer can be shared by several clients
+   bool sendFramed(const std::shared_ptr<const std::string>& rawData);
+
    virtual void onRawDataReceived(const std::string& rawData) = 0;
 
 protected:
@@ -1503,7 +1503,7 @@ bool BlockchainAdapter::processSubscribeAddressTX(const bs::message::Envelope& e
       logger_->error("[{}] invalid address {}", __func__, addr);
       return true;
    }
-   const auto& itAddr = addrTxSubscriptions_.find(address);
+   const auto& itAddr = addrTxSubscriptions_.find(address.display());
    if (itAddr != addrTxSubscriptions_.end()) {
       logger_->debug("[{}] unsubscribing address {}", __func__, addr);
       unregisterWallet(addr);
@@ -1515,16 +1515,18 @@ bool BlockchainAdapter::processSubscribeAddressTX(const bs::message::Envelope& e
    addrWallet.addresses = { address };
    addrWallet.asNew = true;
    registerWallet(addr, addrWallet);
-   addrTxSubscriptions_[address] = { env.foreignId(), env.sender };
+   addrTxSubscriptions_[address.display()] = { env.foreignId(), env.sender };
    return true;
 }
 
 void BlockchainAdapter::processZcForAddrSubscriptions(const bs::TXEntry& entry)
 {
-   for (const auto& subscription : addrTxSubscriptions_) {
-      const auto& addrStr = subscription.first.display();
-      const auto& itId = entry.walletIds.find(addrStr);
-      if (itId == entry.walletIds.end()) {
+   if (addrTxSubscriptions_.empty()) {
+      return;
+   }
+   for (const auto& addrStr : entry.walletIds) {
+      const auto& itSub = addrTxSubscriptions_.find(addrStr);
+      if (itSub == addrTxSubscriptions_.end()) {
          continue;
       }
       logger_->debug("[{}] found ZC {} for {}", __func__, entry.value, addrStr);
@@ -1533,7 +1535,7 @@ void BlockchainAdapter::processZcForAddrSubscriptions(const bs::TXEntry& entry)
       msgResp->set_address(addrStr);
       msgResp->set_value(entry.value);
       msgResp->set_tx_hash(entry.txHash.toBinStr());
-      pushResponse(user_, subscription.second.subscriber
+      pushResponse(user_, itSub->second.subscriber
          , msg.SerializeAsString(), (SeqId)EnvelopeFlags::Publish);
    }
 }
@@ -183,7 +183,9 @@ protected:
       bs::message::SeqId                  msgId;
       std::shared_ptr<bs::message::User>  subscriber;
    };
-   std::map<bs::Address, AddressSubscription>   addrTxSubscriptions_;
+   // keyed by address display string - the same as wallet id that is used
+   // for its registration and then reported in TXEntry::walletIds
+   std::unordered_map<std::string, AddressSubscription>   addrTxSubscriptions_;
 
    struct Settings {
       std::string host;
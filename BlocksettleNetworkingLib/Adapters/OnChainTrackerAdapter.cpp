@@ -221,23 +221,18 @@ void OnChainTrackerAdapter::authAddressVerification()
          logger_->warn("[OnChainTrackerAdapter::authAddressVerification] update failed");
          return;
       }
-      for (const auto& addr : userAddresses_) {
-         const auto& cbAddrOPs = [this, addr](const OutpointBatch& opBatch)
-         {
-            try {
-               const auto& state = AuthAddressLogic::getAuthAddrState(*authVerificator_
-                  , opBatch);
-               completeAuthVerification(addr, state);
-            } catch (const AuthLogicException& e) {
-               logger_->error("[OnChainTrackerAdapter::authAddressVerification] failed "
-                  "to validate state for {}: {}", addr.display(), e.what());
-               completeAuthVerification(addr, AddressVerificationState::VerificationFailed);
-            } catch (const std::exception& e) {
-               logger_->error("[OnChainTrackerAdapter::authAddressVerification] auth state"
-                  " for {} validation error: {}", addr.display(), e.what());
-            }
-         };
-         authVerificator_->getOutpointsFor(addr, cbAddrOPs);
+      const auto& cbStates = [this](const AuthAddrStates& states)
+      {
+         for (const auto& state : states) {
+            completeAuthVerification(state.first, state.second);
+         }
+      };
+      const std::vector<bs::Address> addrs(userAddresses_.cbegin(), userAddresses_.cend());
+      try {
+         AuthAddressLogic::getAuthAddrStates(*authVerificator_, addrs, cbStates);
+      } catch (const std::exception& e) {
+         logger_->error("[OnChainTrackerAdapter::authAddressVerification] auth states"
+            " validation error: {}", e.what());
       }
    };
    authVerificator_->getValidationOutpointsBatch(cbOPs);
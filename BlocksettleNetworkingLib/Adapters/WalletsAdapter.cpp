@@ -233,13 +233,7 @@ std::shared_ptr<Wallet> WalletsAdapter::getWalletById(const std::string &walletI
 
 std::shared_ptr<Wallet> WalletsAdapter::getWalletByAddress(const bs::Address &address) const
 {
-   for (const auto &wallet : wallets_) {
-      if (wallet.second && (wallet.second->containsAddress(address)
-         || wallet.second->containsHiddenAddress(address))) {
-         return wallet.second;
-      }
-   }
-   return nullptr;
+   return addressIndex_.find(address);
 }
 
 std::shared_ptr<hd::Group> WalletsAdapter::getGroupByWalletId(const std::string &walletId) const
@@ -322,6 +316,7 @@ void WalletsAdapter::eraseWallet(const std::shared_ptr<Wallet> &wallet, bool unr
       pushRequest(ownUser_, blockchainUser_, msg.SerializeAsString());
    }
    wallets_.erase(wallet->walletId());
+   addressIndex_.eraseWallet(wallet->walletId());
 }
 
 bool WalletsAdapter::isAddressUsed(const bs::Address& addr, const std::string& walletId) const
@@ -383,8 +378,10 @@ void WalletsAdapter::addWallet(const std::shared_ptr<Wallet> &wallet)
    const auto &itWallet = wallets_.find(wallet->walletId());
    if (itWallet != wallets_.end()) {
       itWallet->second->merge(wallet);
+      addressIndex_.addWallet(itWallet->second, wallet->getAllAddresses());
    } else {
       wallets_[wallet->walletId()] = wallet;
+      addressIndex_.addWallet(wallet, wallet->getAllAddresses());
    }
 
    if ((wallet->type() == bs::core::wallet::Type::Authentication)) {
@@ -553,6 +550,7 @@ void WalletsAdapter::reset()
    prevHdWallets_.swap(hdWallets_);
    hdWallets_.clear();
    wallets_.clear();
+   addressIndex_.clear();
    walletNames_.clear();
    readyWallets_.clear();
    authAddressWallet_.reset();
@@ -637,6 +635,18 @@ void WalletsAdapter::addressAdded(const std::string &walletId)
    sendWalletChanged(walletId);
 }
 
+void WalletsAdapter::addressesAdded(const std::string &walletId
+   , const std::vector<bs::Address> &addrs)
+{
+   addressIndex_.add(walletId, addrs);
+}
+
+void WalletsAdapter::addressesRemoved(const std::string &walletId
+   , const std::vector<bs::Address> &addrs)
+{
+   addressIndex_.erase(walletId, addrs);
+}
+
 void WalletsAdapter::metadataChanged(const std::string &walletId)
 {
    WalletsMessage msg;
@@ -17,6 +17,7 @@
 #include "HDPath.h"
 #include "SignerClient.h"
 #include "Message/ThreadedAdapter.h"
+#include "Wallets/SyncAddressIndex.h"
 #include "Wallets/SyncWallet.h"
 
 namespace spdlog {
@@ -74,6 +75,8 @@ protected:
    virtual bool trackLiveAddresses() const { return true; }
 
    void addressAdded(const std::string &) override;
+   void addressesAdded(const std::string &, const std::vector<bs::Address> &) override;
+   void addressesRemoved(const std::string &, const std::vector<bs::Address> &) override;
    void balanceUpdated(const std::string &) override;
    void walletCreated(const std::string &) override;
    void walletDestroyed(const std::string &) override;
@@ -187,6 +190,7 @@ private:
    std::unordered_set<std::string>     loadingWallets_;
    std::shared_ptr<bs::sync::Wallet>   authAddressWallet_;
    mutable std::unordered_map<std::string, std::shared_ptr<bs::sync::hd::Group>> groupsByWalletId_;
+   bs::sync::AddressIndex           addressIndex_;
 
    class CCResolver : public bs::sync::CCDataResolver
    {
@@ -12,6 +12,7 @@
 #define __ADDRESS_VERIFICATION_POOL_H__
 
 #include "AuthAddress.h"
+#include "FastLock.h"
 
 #include <atomic>
 #include <functional>
@@ -57,7 +58,7 @@ private:
 
    using resultsCollection = std::unordered_map<std::string, std::queue<verificationCompletedCallback> >;
 
-   std::atomic_flag  pendingLockerFlag_ = ATOMIC_FLAG_INIT;
+   AdaptiveLock      pendingLockerFlag_;
    resultsCollection pendingResults_;
 
    std::shared_ptr<AddressVerificator>    verificator_;
@@ -149,11 +149,23 @@ void AddressVerificator::startAddressVerification()
 
 void AddressVerificator::refreshUserAddresses()
 {
-   std::lock_guard<std::mutex> lock(userAddressesMutex_);
-   logger_->debug("[AddressVerificator::refreshUserAddresses] updating {} user address[es]", userAddresses_.size());
-   for (const auto &addr : userAddresses_) {
-      AddCommandToQueue(CreateAddressValidationCommand(addr));
+   std::vector<std::shared_ptr<AddressVerificationData>> states;
+   {
+      std::lock_guard<std::mutex> lock(userAddressesMutex_);
+      logger_->debug("[AddressVerificator::refreshUserAddresses] updating {} user address[es]", userAddresses_.size());
+      if (userAddresses_.empty()) {
+         return;
+      }
+      states.reserve(userAddresses_.size());
+      for (const auto &addr : userAddresses_) {
+         auto state = std::make_shared<AddressVerificationData>();
+         state->address = addr;
+         state->currentState = AddressVerificationState::VerificationFailed;
+         states.push_back(state);
+      }
    }
+   //all addresses are validated with a single db request
+   AddCommandToQueue(CreateAddressValidationCommand(states));
 }
 
 void AddressVerificator::AddCommandToQueue(ExecutionCommand&& command)
@@ -163,47 +175,53 @@ void AddressVerificator::AddCommandToQueue(ExecutionCommand&& command)
    dataAvailable_.notify_all();
 }
 
-AddressVerificator::ExecutionCommand AddressVerificator::CreateAddressValidationCommand(const bs::Address &address)
+AddressVerificator::ExecutionCommand AddressVerificator::CreateAddressValidationCommand(
+   const std::vector<std::shared_ptr<AddressVerificationData>> &states)
 {
-   auto state = std::make_shared<AddressVerificationData>();
-
-   state->address = address;
-   state->currentState = AddressVerificationState::VerificationFailed;
-
-   return CreateAddressValidationCommand(state);
+   return [this, states]() {
+      this->validateAddresses(states);
+   };
 }
 
-AddressVerificator::ExecutionCommand AddressVerificator::CreateAddressValidationCommand(const std::shared_ptr<AddressVerificationData>& state)
-{
-   return [this, state]() {
-      this->validateAddress(state);
+void AddressVerificator::validateAddresses(const std::vector<std::shared_ptr<AddressVerificationData>> &states)
+{   // if we are here, that means that addresses were added, and now it is time to try to validate them
+   const auto returnResults = [this, &states] {
+      for (const auto &state : states) {
+         ReturnValidationResult(state);
+      }
    };
-}
 
-void AddressVerificator::validateAddress(const std::shared_ptr<AddressVerificationData> &state)
-{   // if we are here, that means that address was added, and now it is time to try to validate it
    if (bsAddressList_.empty()) {
-      state->currentState = AddressVerificationState::VerificationFailed;
-      ReturnValidationResult(state);
+      returnResults();
       return;
    }
 
    if (armory_ && (armory_->state() != ArmoryState::Ready)) {
-      logger_->error("[AddressVerificator::ValidateAddress] invalid BlockSettleDB state {}", (int)armory_->state());
-      state->currentState = AddressVerificationState::VerificationFailed;
-      ReturnValidationResult(state);
+      logger_->error("[AddressVerificator::validateAddresses] invalid BlockSettleDB state {}", (int)armory_->state());
+      returnResults();
       return;
    }
 
+   std::vector<bs::Address> addresses;
+   addresses.reserve(states.size());
+   for (const auto &state : states) {
+      addresses.push_back(state->address);
+   }
+
    try {
-      state->currentState = AuthAddressLogic::getAuthAddrState(*validationMgr_, state->address);
+      const auto &addrStates = AuthAddressLogic::getAuthAddrStates(*validationMgr_, addresses);
+      for (const auto &state : states) {
+         const auto it = addrStates.find(state->address);
+         if (it != addrStates.end()) {
+            state->currentState = it->second;
+         }
+      }
    }
    catch (const std::exception &e) {
-      logger_->error("[AddressVerificator::validateAddress] failed to validate state for {}: {}"
-         , state->address.display(), e.what());
-      state->currentState = AddressVerificationState::VerificationFailed;
+      logger_->error("[AddressVerificator::validateAddresses] failed to validate state for {} address[es]: {}"
+         , states.size(), e.what());
    }
-   ReturnValidationResult(state);
+   returnResults();
 }
 
 void AddressVerificator::ReturnValidationResult(const std::shared_ptr<AddressVerificationData>& state)
@@ -71,11 +71,13 @@ public:
 protected:
    void onNewBlock(unsigned int, unsigned int) override
    {
+      validationMgr_->resetAuthAddrStates();
       refreshUserAddresses();
    }
 
    void onZCReceived(const std::string& , const std::vector<bs::TXEntry>&) override
    {
+      validationMgr_->resetAuthAddrStates();
       refreshUserAddresses();
    }
 
@@ -88,10 +90,9 @@ private:
 
    void AddCommandToQueue(ExecutionCommand&& command);
 
-   ExecutionCommand CreateAddressValidationCommand(const bs::Address &address);
-   ExecutionCommand CreateAddressValidationCommand(const std::shared_ptr<AddressVerificationData>& state);
+   ExecutionCommand CreateAddressValidationCommand(const std::vector<std::shared_ptr<AddressVerificationData>>& states);
 
-   void validateAddress(const std::shared_ptr<AddressVerificationData>& state);
+   void validateAddresses(const std::vector<std::shared_ptr<AddressVerificationData>>& states);
 
    void ReturnValidationResult(const std::shared_ptr<AddressVerificationData>& state);
 
@@ -25,6 +25,68 @@ namespace {
       }
    }
 
+   AuthAddressValidator::AddressOutpoints splitOutpointBatch(
+      const std::vector<bs::Address> &addrs, const OutpointBatch &batch)
+   {
+      AuthAddressValidator::AddressOutpoints result;
+      for (const auto &addr : addrs) {
+         auto &addrBatch = result[addr];
+         addrBatch.heightCutoff_ = batch.heightCutoff_;
+         addrBatch.zcIndexCutoff_ = batch.zcIndexCutoff_;
+
+         const auto it = batch.outpoints_.find(addr.prefixed());
+         if (it != batch.outpoints_.end()) {
+            addrBatch.outpoints_.insert(*it);
+         }
+      }
+      return result;
+   }
+
+   //returns cached states and fills addresses missing from the cache
+   AuthAddrStates getCachedStates(const AuthAddressValidator &aav
+      , const std::vector<bs::Address> &addrs, unsigned int currentTop
+      , unsigned int &cacheId, std::vector<bs::Address> &missing)
+   {
+      if (currentTop == UINT32_MAX) {
+         throw std::runtime_error("invalid top height");
+      }
+      auto result = aav.getCachedAuthAddrStates(addrs, currentTop, cacheId);
+      for (const auto &addr : addrs) {
+         if (result.find(addr) == result.end()) {
+            missing.push_back(addr);
+         }
+      }
+      return result;
+   }
+
+   AuthAddrStates evaluateStates(const AuthAddressValidator &aav
+      , const AuthAddressValidator::AddressOutpoints &outpoints
+      , unsigned int currentTop, unsigned int cacheId)
+   {
+      AuthAddrStates result;
+      for (const auto &addrOutpoints : outpoints) {
+         AddressVerificationState state;
+         try {
+            state = AuthAddressLogic::getAuthAddrState(aav
+               , addrOutpoints.second, currentTop);
+         } catch (const std::exception &) {
+            state = AddressVerificationState::VerificationFailed;
+         }
+         result.emplace(addrOutpoints.first, state);
+      }
+      aav.cacheAuthAddrStates(result, cacheId);
+      return result;
+   }
+
+   //marks addresses without a state as failed
+   void failMissingStates(AuthAddrStates &states
+      , const std::vector<bs::Address> &addrs)
+   {
+      for (const auto &addr : addrs) {
+         states.emplace(addr, AddressVerificationState::VerificationFailed);
+      }
+   }
+
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -572,6 +634,9 @@ unsigned AuthAddressValidator::update(const OutpointBatch &batch)
    topBlock_ = batch.heightCutoff_ + 1;
    zcIndex_ = batch.zcIndexCutoff_;
 
+   //updates come on new blocks and ZC, cached auth address states are stale
+   resetAuthAddrStates();
+
    return opCount;
 }
 
@@ -1010,6 +1075,67 @@ void AuthAddressValidator::pushZC(const BinaryData &tx) const
    }
 }
 
+AuthAddressValidator::AddressOutpoints AuthAddressValidator::getOutpointsFor(
+   const std::vector<bs::Address> &addrs) const
+{
+   return splitOutpointBatch(addrs, getOutpointsForAddresses(addrs));
+}
+
+void AuthAddressValidator::getOutpointsFor(const std::vector<bs::Address> &addrs
+   , const std::function<void(const AddressOutpoints &)> &cb) const
+{
+   if (!lambdas_) {
+      return;
+   }
+   const auto &opLbd = [addrs, cb](const OutpointBatch &batch)
+   {
+      if (cb) {
+         cb(splitOutpointBatch(addrs, batch));
+      }
+   };
+   lambdas_->getOutpointsForAddresses(addrs, opLbd);
+}
+
+AuthAddrStates AuthAddressValidator::getCachedAuthAddrStates(
+   const std::vector<bs::Address> &addrs, unsigned int topBlock
+   , unsigned int &cacheId) const
+{
+   std::lock_guard<std::mutex> lock(authStatesMutex_);
+   if (topBlock != authStatesTop_) {
+      authStates_.clear();
+      authStatesTop_ = topBlock;
+      ++authStatesId_;
+   }
+   cacheId = authStatesId_;
+
+   AuthAddrStates result;
+   for (const auto &addr : addrs) {
+      const auto it = authStates_.find(addr);
+      if (it != authStates_.end()) {
+         result.insert(*it);
+      }
+   }
+   return result;
+}
+
+void AuthAddressValidator::cacheAuthAddrStates(const AuthAddrStates &states
+   , unsigned int cacheId) const
+{
+   std::lock_guard<std::mutex> lock(authStatesMutex_);
+   //states evaluated before the cache was dropped are outdated
+   if (cacheId != authStatesId_) {
+      return;
+   }
+   authStates_.insert(states.cbegin(), states.cend());
+}
+
+void AuthAddressValidator::resetAuthAddrStates()
+{
+   std::lock_guard<std::mutex> lock(authStatesMutex_);
+   authStates_.clear();
+   ++authStatesId_;
+}
+
 OutpointBatch AuthAddressValidator::getOutpointsForAddresses(const std::vector<bs::Address> &addrs
    , unsigned int topBlock, unsigned int zcIndex) const
 {
@@ -1152,17 +1278,22 @@ bool AuthAddressLogic::isValid(
 ////
 AddressVerificationState AuthAddressLogic::getAuthAddrState(const AuthAddressValidator &aav
    , const OutpointBatch &batch)
+{
+   auto currentTop = aav.topBlock();
+   if (currentTop == UINT32_MAX) {
+      throw std::runtime_error("invalid top height");
+   }
+   return getAuthAddrState(aav, batch, currentTop);
+}
+
+AddressVerificationState AuthAddressLogic::getAuthAddrState(const AuthAddressValidator &aav
+   , const OutpointBatch &batch, unsigned int currentTop)
 {   /***
    Validity is unique. This means there should be only one output chain
    defining validity. Any concurent path, whether partial or full,
    invalidates the user address.
    ***/
 
-   auto currentTop = aav.topBlock();
-   if (currentTop == UINT32_MAX) {
-      throw std::runtime_error("invalid top height");
-   }
-
    const auto &pathState = getAddrPathsStatus(aav, batch);
    if (!pathState.isInitialized()) {
       // uninitialized path state, this happens on corrupt data from db
@@ -1215,6 +1346,66 @@ AddressVerificationState AuthAddressLogic::getAuthAddrState(
    return getAuthAddrState(aav, aav.getOutpointsFor(addr));
 }
 
+AuthAddrStates AuthAddressLogic::getAuthAddrStates(
+   const AuthAddressValidator &aav, const std::vector<bs::Address> &addrs)
+{
+   const auto currentTop = aav.topBlock();
+   unsigned int cacheId = 0;
+   std::vector<bs::Address> missing;
+   auto result = getCachedStates(aav, addrs, currentTop, cacheId, missing);
+   if (missing.empty()) {
+      return result;
+   }
+
+   const auto &states = evaluateStates(aav, aav.getOutpointsFor(missing)
+      , currentTop, cacheId);
+   result.insert(states.cbegin(), states.cend());
+   return result;
+}
+
+void AuthAddressLogic::getAuthAddrStates(const AuthAddressValidator &aav
+   , const std::vector<bs::Address> &addrs, const AuthAddrStatesCb &cb)
+{
+   //errors are reported through cb with the affected addresses failed
+   const auto currentTop = aav.topBlock();
+   unsigned int cacheId = 0;
+   std::vector<bs::Address> missing;
+   AuthAddrStates result;
+   try {
+      result = getCachedStates(aav, addrs, currentTop, cacheId, missing);
+   } catch (const std::exception &) {
+      failMissingStates(result, addrs);
+      missing.clear();
+   }
+   if (missing.empty()) {
+      if (cb) {
+         cb(result);
+      }
+      return;
+   }
+
+   const auto &opLbd = [&aav, result, missing, currentTop, cacheId, cb]
+      (const AuthAddressValidator::AddressOutpoints &outpoints) mutable
+   {
+      try {
+         const auto &states = evaluateStates(aav, outpoints, currentTop, cacheId);
+         result.insert(states.cbegin(), states.cend());
+      } catch (const std::exception &) {}
+      failMissingStates(result, missing);
+      if (cb) {
+         cb(result);
+      }
+   };
+   try {
+      aav.getOutpointsFor(missing, opLbd);
+   } catch (const std::exception &) {
+      failMissingStates(result, missing);
+      if (cb) {
+         cb(result);
+      }
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 std::pair<bs::Address, UTXO> AuthAddressLogic::getRevokeData(
    const AuthAddressValidator &aav, const bs::Address &addr)
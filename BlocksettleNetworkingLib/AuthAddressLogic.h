@@ -12,7 +12,9 @@
 #define _H_AUTHADDRESSLOGIC
 
 #include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 
 #include "Address.h"
@@ -211,6 +213,8 @@ struct ValidationAddressStruct
 
 
 class AuthAddressValidator;
+using AuthAddrStates = std::map<bs::Address, AddressVerificationState>;
+
 struct AuthValidatorCallbacks
 {
    virtual void shutdown() {}
@@ -300,6 +304,22 @@ public:
    OutpointBatch getOutpointsFor(const bs::Address &) const;
    void getOutpointsFor(const bs::Address &
       , const std::function<void(const OutpointBatch &)> &) const;
+
+   //one db request for all addresses, result has a batch per address
+   using AddressOutpoints = std::map<bs::Address, OutpointBatch>;
+   AddressOutpoints getOutpointsFor(const std::vector<bs::Address> &) const;
+   void getOutpointsFor(const std::vector<bs::Address> &
+      , const std::function<void(const AddressOutpoints &)> &) const;
+
+   /*
+   Auth address states are cached for the current top block. The cache is
+   dropped on top block change and on every update, as new blocks and ZC
+   can change the state of both user and validation addresses.
+   */
+   AuthAddrStates getCachedAuthAddrStates(const std::vector<bs::Address> &
+      , unsigned int topBlock, unsigned int &cacheId) const;
+   void cacheAuthAddrStates(const AuthAddrStates &, unsigned int cacheId) const;
+   void resetAuthAddrStates();
    std::vector<UTXO> getUTXOsFor(const bs::Address &, bool withZC = false) const;
    void pushZC(const BinaryData &tx) const;
    void getValidationOutpointsBatch(const std::function<void(OutpointBatch)> &);
@@ -338,6 +358,11 @@ private:
    std::mutex  updateMutex_;
    std::thread updateThread_;
    std::atomic_bool  updateThreadRunning_{ false };
+
+   mutable std::mutex      authStatesMutex_;
+   mutable AuthAddrStates  authStates_;
+   mutable unsigned int    authStatesTop_ = UINT32_MAX;
+   mutable unsigned int    authStatesId_ = 0;
 };
 
 ////
@@ -385,6 +410,18 @@ namespace AuthAddressLogic
       , const bs::Address &);
    AddressVerificationState getAuthAddrState(const AuthAddressValidator &
       , const OutpointBatch &);
+   AddressVerificationState getAuthAddrState(const AuthAddressValidator &
+      , const OutpointBatch &, unsigned int currentTop);
+
+   /*
+   Batch versions fetch outpoints of all addresses not in the validator
+   cache with one db request. Validator should outlive the callback.
+   */
+   AuthAddrStates getAuthAddrStates(const AuthAddressValidator &
+      , const std::vector<bs::Address> &);
+   using AuthAddrStatesCb = std::function<void(const AuthAddrStates &)>;
+   void getAuthAddrStates(const AuthAddressValidator &
+      , const std::vector<bs::Address> &, const AuthAddrStatesCb &);
 
    bool isValid(const AuthAddressValidator &, const bs::Address &);
 
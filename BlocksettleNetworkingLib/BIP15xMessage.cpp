@@ -85,6 +85,89 @@ BinaryData MessageBuilder::build() const
    return packet_;
 }
 
+size_t bs::network::bip15x::packetSize(size_t dataSize, bool encrypted)
+{
+   return sizeof(uint32_t) + sizeof(uint8_t) + dataSize + (encrypted ? POLY1305MACLEN : 0);
+}
+
+namespace {
+   // don't keep occasional big batches' memory around
+   constexpr size_t kMaxPooledSize = 1024 * 1024;
+}
+
+BatchBuilder::BatchBuilder()
+   : buffer_(std::make_shared<DataSlice::Buffer>())
+{}
+
+void BatchBuilder::reserve(size_t nbPackets, size_t totalDataSize, bool encrypted)
+{
+   frames_.reserve(frames_.size() + nbPackets);
+   buffer_->reserve(buffer_->size() + packetSize(0, encrypted) * nbPackets + totalDataSize);
+}
+
+void BatchBuilder::add(const uint8_t *data, uint32_t dataSize, uint8_t type
+   , BIP151Connection *conn)
+{
+   const size_t plainTextLen = packetSize(dataSize, false);
+   const uint32_t packetLen = uint32_t(plainTextLen - sizeof(uint32_t));
+   auto &buffer = *buffer_;
+   const size_t offset = buffer.size();
+
+   // Serialize straight into output buffer if no encryption is needed
+   auto &plain = conn ? plain_ : buffer;
+   const size_t plainOffset = conn ? 0 : offset;
+   plain.resize(plainOffset + plainTextLen);
+   auto ptr = plain.data() + plainOffset;
+   std::memcpy(ptr, &packetLen, sizeof(packetLen));
+   ptr[sizeof(uint32_t)] = type;
+   if (dataSize) {
+      std::memcpy(ptr + sizeof(uint32_t) + sizeof(uint8_t), data, dataSize);
+   }
+
+   if (!conn) {
+      frames_.emplace_back(offset, plainTextLen);
+      return;
+   }
+
+   const size_t cipherTextLen = plainTextLen + POLY1305MACLEN;
+   buffer.resize(offset + cipherTextLen);
+   int rc = conn->assemblePacket(plain_.data(), plainTextLen, buffer.data() + offset, cipherTextLen);
+   if (rc != 0) {
+      buffer.resize(offset);
+      throw std::runtime_error("failed to encrypt packet, aborting");
+   }
+   frames_.emplace_back(offset, cipherTextLen);
+}
+
+void BatchBuilder::add(const std::string &data, MsgType type, BIP151Connection *conn)
+{
+   add(reinterpret_cast<const uint8_t*>(data.data()), uint32_t(data.size()), uint8_t(type), conn);
+}
+
+BinaryDataRef BatchBuilder::packet(size_t index) const
+{
+   const auto &frame = frames_.at(index);
+   return BinaryDataRef(buffer_->data() + frame.first, frame.second);
+}
+
+bs::network::DataSlice BatchBuilder::slice(size_t index) const
+{
+   const auto &frame = frames_.at(index);
+   return DataSlice(buffer_, frame.first, frame.second);
+}
+
+void BatchBuilder::clear()
+{
+   // Buffer could be still referenced by slices queued for sending
+   if ((buffer_.use_count() > 1) || (buffer_->capacity() > kMaxPooledSize)) {
+      buffer_ = std::make_shared<DataSlice::Buffer>();
+   }
+   else {
+      buffer_->clear();
+   }
+   frames_.clear();
+}
+
 Message Message::parse(const BinaryDataRef &packet)
 {
    try {
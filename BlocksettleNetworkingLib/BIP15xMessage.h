@@ -17,6 +17,7 @@
 #include "BinaryData.h"
 #include "BIP150_151.h"
 #include "BIP15x_Handshake.h"
+#include "DataSlice.h"
 
 // The message format is as follows:
 //
@@ -76,6 +77,47 @@ namespace bs {
             BinaryData packet_;
          };
 
+         // Builds several packets for the same connection into one contiguous
+         // buffer. Plain packet is serialized into reusable scratch space and
+         // encrypted straight to its place in output buffer, so reserve()
+         // with total payload size avoids any allocation per packet.
+         // Packets must be sent in the order they were added.
+         // Meant to be kept per connection: clear() reuses the buffer unless
+         // slices of previous batch are still alive. Not thread-safe.
+         class BatchBuilder
+         {
+         public:
+            BatchBuilder();
+
+            void reserve(size_t nbPackets, size_t totalDataSize, bool encrypted);
+
+            // Appends packet, encrypts it if conn is set
+            void add(const uint8_t *data, uint32_t dataSize, uint8_t type
+               , BIP151Connection *conn);
+            void add(const std::string &data, MsgType type, BIP151Connection *conn);
+
+            size_t size() const { return frames_.size(); }
+            bool empty() const { return frames_.empty(); }
+            size_t bufferSize() const { return buffer_->size(); }
+
+            // Valid until next add() or clear()
+            BinaryDataRef packet(size_t index) const;
+
+            // Keeps the buffer alive, can be passed on without copying
+            // once all packets are added
+            DataSlice slice(size_t index) const;
+
+            void clear();
+
+         private:
+            std::shared_ptr<DataSlice::Buffer> buffer_;
+            std::vector<uint8_t> plain_;
+            std::vector<std::pair<size_t, size_t>> frames_;   // offset, size
+         };
+
+         // Size of serialized packet on the wire
+         size_t packetSize(size_t dataSize, bool encrypted);
+
          // A class used to represent messages on the wire that need to be decrypted.
          class Message
          {
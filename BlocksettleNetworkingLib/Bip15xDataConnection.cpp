@@ -90,8 +90,8 @@ Bip15xDataConnection::Bip15xDataConnection(const std::shared_ptr<spdlog::logger>
       return conn_->send(d);
    });
 
-   transport_->setNotifyDataCb([this](const std::string &d) {
-      listener_->OnDataReceived(d);
+   transport_->setNotifyDataSliceCb([this](const bs::network::DataSlice &d) {
+      listener_->OnDataSliceReceived(d);
    });
 
    transport_->setSocketErrorCb([this](DataConnectionListener::DataConnectionError e) {
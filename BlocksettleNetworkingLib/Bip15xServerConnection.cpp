@@ -79,14 +79,20 @@ Bip15xServerConnection::Bip15xServerConnection(const std::shared_ptr<spdlog::log
       listener_->onClientError(id, err, details);
    });
 
-   transport_->setDataReceivedCb([this](const std::string &clientId, const std::string &data) {
-      listener_->OnDataFromClient(clientId, data);
+   transport_->setDataSliceReceivedCb([this](const std::string &clientId
+      , const bs::network::DataSlice &data) {
+      listener_->OnDataSliceFromClient(clientId, data);
    });
 
    transport_->setSendDataCb([this](const std::string &clientId, const std::string &data) {
       return server_->SendDataToClient(clientId, data);
    });
 
+   transport_->setSendDataSliceCb([this](const std::string &clientId
+      , const bs::network::DataSlice &data) {
+      return server_->SendDataSliceToClient(clientId, data);
+   });
+
    transport_->setConnectedCb([this](const std::string &clientId, const ServerConnectionListener::Details &details) {
       {
          std::lock_guard<std::mutex> lock(mutex_);
@@ -129,11 +135,6 @@ bool Bip15xServerConnection::SendDataToClient(const std::string &clientId, const
 bool Bip15xServerConnection::SendDataToAllClients(const std::string &data)
 {
    std::lock_guard<std::mutex> lock(mutex_);
-   size_t cntClients = clients_.size();
-   for (const auto &item : clients_) {
-      if (SendDataToClient(item, data)) {
-         cntClients--;
-      }
-   }
-   return (cntClients == 0);
+   const std::vector<std::string> clientIds(clients_.cbegin(), clients_.cend());
+   return transport_->sendDataBatch(clientIds, data);
 }
@@ -30,24 +30,6 @@ std::shared_ptr<ColoredCoinZCSnapshot> ColoredCoinTrackerAsync::zcSnapshot() con
    return std::atomic_load_explicit(&zcSnapshot_, std::memory_order_acquire);
 }
 
-const std::shared_ptr<BinaryData> ColoredCoinTrackerAsync::getScrAddrPtr(
-   const std::map<BinaryData, OpPtrSet>& addrMap
-   , const BinaryData& scrAddr) const
-{
-   auto scrAddrIter = addrMap.find(scrAddr.getRef());
-   if (scrAddrIter == addrMap.end()) {
-      return nullptr;
-   }
-   if (scrAddrIter->second.size() == 0) {
-      return nullptr;
-   }
-   auto& obj = *scrAddrIter->second.begin();
-   if (obj == nullptr) {
-      return nullptr;
-   }
-   return obj->getScrAddr();
-}
-
 uint64_t ColoredCoinTrackerAsync::getCcOutputValue(
    const std::shared_ptr<ColoredCoinSnapshot>& ssPtr
    , const std::shared_ptr<ColoredCoinZCSnapshot>& zcPtr
@@ -59,48 +41,32 @@ uint64_t ColoredCoinTrackerAsync::getCcOutputValue(
       UINT64_MAX if it was revoked.
    */
 
-   auto getOpPtr = [&ssPtr, &hash, &txOutIndex](void)->
-      std::shared_ptr<CcOutpoint>
-   {
-      if (ssPtr == nullptr) {
-         return nullptr;
-      }
-      auto hashIter = ssPtr->utxoSet_.find(hash);
-      if (hashIter == ssPtr->utxoSet_.end()) {
-         return nullptr;
-      }
-      auto idIter = hashIter->second.find(txOutIndex);
-      if (idIter == hashIter->second.end()) {
-         return nullptr;
-      }
-      return idIter->second;
-   };
-
    //try to grab the cc output
-   auto ccPtr = getOpPtr();
-
+   const CcOutput* ccPtr = nullptr;
+   if (ssPtr != nullptr) {
+      ccPtr = ssPtr->utxoSet_.find(hash, txOutIndex);
+   }
 
    if (ccPtr != nullptr) {
       //check this cc addr isnt revoked
-      if (ssPtr != nullptr) {
-         auto revokedIter = ssPtr->revokedAddresses_.find(*ccPtr->getScrAddr());
-         if (revokedIter != ssPtr->revokedAddresses_.end() &&
-            height > revokedIter->second) {
-            return UINT64_MAX;
-         }
+      auto revokedIter = ssPtr->revokedAddresses_.find(
+         ssPtr->utxoSet_.scrAddr(*ccPtr));
+      if (revokedIter != ssPtr->revokedAddresses_.end() &&
+         height > revokedIter->second) {
+         return UINT64_MAX;
       }
 
       //check the cc isn't spent by a zc
       if (zcPtr == nullptr) {
-         return ccPtr->value();
+         return ccPtr->value_;
       }
       auto spentIter = zcPtr->spentOutputs_.find(hash);
       if (spentIter == zcPtr->spentOutputs_.end()) {
-         return ccPtr->value();
+         return ccPtr->value_;
       }
       auto indexIter = spentIter->second.find(txOutIndex);
       if (indexIter == spentIter->second.end()) {
-         return ccPtr->value();
+         return ccPtr->value_;
       }
       return 0;
    }
@@ -109,15 +75,11 @@ uint64_t ColoredCoinTrackerAsync::getCcOutputValue(
    if (zcPtr == nullptr) {
       return 0;
    }
-   auto spentIter = zcPtr->utxoSet_.find(hash);
-   if (spentIter == zcPtr->utxoSet_.end()) {
-      return 0;
-   }
-   auto indexIter = spentIter->second.find(txOutIndex);
-   if (indexIter == spentIter->second.end()) {
+   auto zcOutput = zcPtr->utxoSet_.find(hash, txOutIndex);
+   if (zcOutput == nullptr) {
       return 0;
    }
-   return indexIter->second->value();
+   return zcOutput->value_;
 }
 
 uint64_t ColoredCoinTrackerAsync::getCcOutputValue(
@@ -230,21 +192,13 @@ void ColoredCoinTrackerAsync::processTxBatch(
 
          //purge utxo set of all spent CC outputs
          for (auto& input : parsedTx.outpoints_) {
-            auto hashIter = ssPtr->utxoSet_.find(input.first);
-            if (hashIter == ssPtr->utxoSet_.end()) {
+            if (!ssPtr->utxoSet_.hasTx(input.first)) {
                throw ColoredCoinException("missing outpoint hash");
             }
-            auto idIter = hashIter->second.find(input.second);
-            if (idIter == hashIter->second.end()) {
-               throw ColoredCoinException("missing outpoint index");
-            }
-            //remove from scrAddr to utxo map
-            eraseScrAddrOp(ssPtr, idIter->second);
 
-            //remove from utxo set
-            hashIter->second.erase(idIter);
-            if (hashIter->second.size() == 0) {
-               ssPtr->utxoSet_.erase(hashIter);
+            //remove from utxo set and scrAddr to utxo map
+            if (!ssPtr->utxoSet_.erase(input.first, input.second)) {
+               throw ColoredCoinException("missing outpoint index");
             }
          }
 
@@ -349,31 +303,14 @@ void ColoredCoinTrackerAsync::processZcBatch(
 
          //purge utxo set of all spent CC outputs
          for (auto& input : parsedTx.outpoints_) {
-            auto hashIter = ssPtr->utxoSet_.find(input.first);
-            if (hashIter != ssPtr->utxoSet_.end()) {
-               auto idIter = hashIter->second.find(input.second);
-               if (idIter != hashIter->second.end()) {
-                  //spent confirmed output, mark it in zc snapshot
-                  auto spentIter = zcPtr->spentOutputs_.find(input.first);
-                  if (spentIter == zcPtr->spentOutputs_.end()) {
-                     spentIter = zcPtr->spentOutputs_.insert(
-                        std::make_pair(input.first, std::set<unsigned>())).first;
-                  }
-
-                  spentIter->second.insert(input.second);
-                  continue;
-               }
+            if (ssPtr->utxoSet_.find(input.first, input.second) != nullptr) {
+               //spent confirmed output, mark it in zc snapshot
+               zcPtr->spentOutputs_[input.first].insert(input.second);
+               continue;
             }
 
             //not a confirmed output, remove from zc utxo set instead
-            auto zcHashIter = zcPtr->utxoSet_.find(input.first);
-            if (zcHashIter == zcPtr->utxoSet_.end()) {
-               continue;
-            }
-            zcHashIter->second.erase(input.second);
-            if (zcHashIter->second.size() == 0) {
-               zcPtr->utxoSet_.erase(zcHashIter);
-            }
+            zcPtr->utxoSet_.erase(input.first, input.second);
          }
 
          if (parsedTx.isInitialized()) {
@@ -383,7 +320,7 @@ void ColoredCoinTrackerAsync::processZcBatch(
             for (unsigned i = 0; i < parsedTx.outputs_.size(); i++) {
                //add the utxo
                auto& output = parsedTx.outputs_[i];
-               addZcUtxo(ssPtr, zcPtr, parsedTx.txHash_, i, output.first, output.second);
+               addZcUtxo(zcPtr, parsedTx.txHash_, i, output.first, output.second);
             }
          }
       }
@@ -433,7 +370,7 @@ void ColoredCoinTrackerAsync::processRevocationBatch(
             if (iter != revocationAddresses_.end()) {
                continue;
             }
-            ssPtr->revokedAddresses_.insert(std::make_pair(scrAddr, tx.second->getTxHeight()));
+            ssPtr->revokedAddresses_.emplace(scrAddr, tx.second->getTxHeight());
          }
       }
       if (cb) {
@@ -469,9 +406,9 @@ void ColoredCoinTrackerAsync::update(const AddrSetCb &cb)
    std::set<BinaryData> addrSet;
 
    //current set of live user addresses
-   for (auto& addrRef : ssPtr->scrAddrCcSet_) {
-      addrSet.insert(addrRef.first);
-   }
+   ssPtr->utxoSet_.forEachAddress([&addrSet](const BinaryDataRef &scrAddr) {
+      addrSet.insert(BinaryData(scrAddr));
+   });
    //origin and revocation addresses
    addrSet.insert(originAddresses_.cbegin(), originAddresses_.cend());
    addrSet.insert(revocationAddresses_.cbegin(), revocationAddresses_.cend());
@@ -535,12 +472,7 @@ void ColoredCoinTrackerAsync::update(const AddrSetCb &cb)
                }
 
                //or was it a valid CC?
-               auto hashIter = ssPtr->utxoSet_.find(op.txHash_);
-               if (hashIter == ssPtr->utxoSet_.end()) {
-                  continue;
-               }
-               auto idIter = hashIter->second.find(op.txOutIndex_);
-               if (idIter == hashIter->second.end()) {
+               if (ssPtr->utxoSet_.find(op.txHash_, op.txOutIndex_) == nullptr) {
                   continue;
                }
                //mark the spender for CC settlement
@@ -567,10 +499,16 @@ void ColoredCoinTrackerAsync::update(const AddrSetCb &cb)
 
             //track new addresses
             std::set<BinaryData> toReg;
-            for (const auto &addr : ssPtr->scrAddrCcSet_) {
-               if (addrSet.find(addr.first) == addrSet.end()) {
-                  toReg.insert(addr.first);
+            ssPtr->utxoSet_.forEachAddress([&addrSet, &toReg](const BinaryDataRef &scrAddr) {
+               BinaryData addr(scrAddr);
+               if (addrSet.find(addr) == addrSet.end()) {
+                  toReg.insert(std::move(addr));
                }
+            });
+
+            //drop ids of spent outputs
+            if (ssPtr->utxoSet_.needsCompaction()) {
+               ssPtr->utxoSet_.compact();
             }
 
             //swap new snapshot in
@@ -626,14 +564,13 @@ void ColoredCoinTrackerAsync::zcUpdate(const AddrSetCb &cb)
    addrSet.insert(originAddresses_.begin(), originAddresses_.end());
 
    //current set of live user addresses
+   const auto addAddress = [&addrSet](const BinaryDataRef &scrAddr) {
+      addrSet.insert(BinaryData(scrAddr));
+   };
    if (currentSs != nullptr) {
-      for (const auto &addrRef : currentSs->scrAddrCcSet_) {
-         addrSet.insert(addrRef.first);
-      }
-   }
-   for (const auto &addrRef : ssPtr->scrAddrCcSet_) {
-      addrSet.insert(addrRef.first);
+      currentSs->utxoSet_.forEachAddress(addAddress);
    }
+   ssPtr->utxoSet_.forEachAddress(addAddress);
 
    //note: we dont deal with unconfirmed revocations
    auto lbd = [this, cb, currentSs, ssPtr, addrSet]
@@ -655,7 +592,7 @@ void ColoredCoinTrackerAsync::zcUpdate(const AddrSetCb &cb)
             continue;
          }
          for (auto& op : iter->second) {
-            addZcUtxo(currentSs, ssPtr, op.txHash_, op.txOutIndex_, op.value_, scrAddr);
+            addZcUtxo(ssPtr, op.txHash_, op.txOutIndex_, op.value_, scrAddr);
          }
       }
 
@@ -693,11 +630,12 @@ void ColoredCoinTrackerAsync::zcUpdate(const AddrSetCb &cb)
 
          //track new addresses
          std::set<BinaryData> toReg;
-         for (const auto &addr : ssPtr->scrAddrCcSet_) {
-            if (addrSet.find(addr.first) == addrSet.end()) {
-               toReg.insert(addr.first);
+         ssPtr->utxoSet_.forEachAddress([&addrSet, &toReg](const BinaryDataRef &scrAddr) {
+            BinaryData addr(scrAddr);
+            if (addrSet.find(addr) == addrSet.end()) {
+               toReg.insert(std::move(addr));
             }
-         }
+         });
 
          //swap the new snapshot in
          std::atomic_store_explicit(&zcSnapshot_, ssPtr, std::memory_order_release);
@@ -733,9 +671,11 @@ void ColoredCoinTrackerAsync::purgeZc(const ResultCb &cb)
 
    //grab height for all our active zc
    std::set<BinaryData> txHashes;
-   for (const auto &hashPair : zcPtr->utxoSet_) {
-      txHashes.insert(hashPair.first);
-   }
+   zcPtr->utxoSet_.forEachTx([&txHashes]
+      (const BinaryDataRef &txHash, const CcUtxoStore::Outputs &)
+   {
+      txHashes.insert(BinaryData(txHash));
+   });
    const auto getTxBatchLbd = [this, cb, zcPtr, currentSs]
       (const AsyncClient::TxBatchResult &txBatch, std::exception_ptr exPtr) mutable
    {
@@ -762,8 +702,7 @@ void ColoredCoinTrackerAsync::purgeZc(const ResultCb &cb)
             if (originAddresses_.find(scrAddr) == originAddresses_.end()) {
                continue;
             }
-            addZcUtxo(currentSs, zcPtr,
-               tx.first, i, txOut.getValue(), scrAddr);
+            addZcUtxo(zcPtr, tx.first, i, txOut.getValue(), scrAddr);
          }
       }
 
@@ -817,174 +756,64 @@ std::vector<std::shared_ptr<CcOutpoint>> ColoredCoinTrackerAsync::getSpendableOu
 
    auto ssPtr = snapshot();
    auto zcPtr = zcSnapshot();
-   if (ssPtr != nullptr) {
-      auto iter = ssPtr->scrAddrCcSet_.find(scrAddr.getRef());
-      if (iter != ssPtr->scrAddrCcSet_.end()) {
-         auto revokeIter = ssPtr->revokedAddresses_.find(scrAddr);
-         if (revokeIter != ssPtr->revokedAddresses_.end()) {
-            return {};
-         }
-
-         if (zcPtr != nullptr) {
-            for (auto& ccOp : iter->second) {
-               //is this outpoint spent by a zc?
-               auto zcSpentIter = zcPtr->spentOutputs_.find(ccOp->getTxHash()->getRef());
-               if (zcSpentIter != zcPtr->spentOutputs_.end()) {
-                  auto idIter = zcSpentIter->second.find(ccOp->index());
-                  if (idIter != zcSpentIter->second.end()) {
-                     continue;
-                  }
-               }
+   //outpoints share hash and scrAddr copies
+   const auto scrAddrPtr = std::make_shared<BinaryData>(scrAddr);
+   std::shared_ptr<BinaryData> hashPtr;
+   const auto addOutpoint = [&result, &scrAddrPtr, &hashPtr, &zcPtr]
+      (const BinaryDataRef &txHash, const CcOutput &output)
+   {
+      if ((hashPtr == nullptr) || (txHash != hashPtr->getRef())) {
+         hashPtr = std::make_shared<BinaryData>(txHash);
+      }
 
-               result.push_back(ccOp);
-            }
-         } else {
-            for (auto& ccOp : iter->second) {
-               result.push_back(ccOp);
+      //is this outpoint spent by a zc?
+      if (zcPtr != nullptr) {
+         auto zcSpentIter = zcPtr->spentOutputs_.find(*hashPtr);
+         if (zcSpentIter != zcPtr->spentOutputs_.end()) {
+            auto idIter = zcSpentIter->second.find(output.index_);
+            if (idIter != zcSpentIter->second.end()) {
+               return;
             }
          }
       }
+
+      auto opPtr = std::make_shared<CcOutpoint>(output.value_, output.index_);
+      opPtr->setTxHash(hashPtr);
+      opPtr->setScrAddr(scrAddrPtr);
+      result.push_back(opPtr);
+   };
+
+   if (ssPtr != nullptr && ssPtr->utxoSet_.hasAddress(scrAddr)) {
+      auto revokeIter = ssPtr->revokedAddresses_.find(scrAddr);
+      if (revokeIter != ssPtr->revokedAddresses_.end()) {
+         return {};
+      }
+      ssPtr->utxoSet_.forEachAddressOutput(scrAddr, addOutpoint);
    }
 
    if (zcPtr == nullptr) {
       return result;
    }
-   auto zcIter = zcPtr->scrAddrCcSet_.find(scrAddr.getRef());
-   if (zcIter != zcPtr->scrAddrCcSet_.end()) {
-      for (auto& ccOp : zcIter->second) {
-         result.push_back(ccOp);
-      }
-   }
+   zcPtr->utxoSet_.forEachAddressOutput(scrAddr, addOutpoint);
 
    return result;
 }
 
-void ColoredCoinTrackerAsync::eraseScrAddrOp(
-   const std::shared_ptr<ColoredCoinSnapshot> &ssPtr
-   , const std::shared_ptr<CcOutpoint>& opPtr)
-{
-   if (ssPtr == nullptr) {
-      return;
-   }
-   auto scrAddrIter = ssPtr->scrAddrCcSet_.find(opPtr->getScrAddr()->getRef());
-   if (scrAddrIter == ssPtr->scrAddrCcSet_.end()) {
-      return;
-   }
-   scrAddrIter->second.erase(opPtr);
-   if (scrAddrIter->second.size() == 0) {
-      ssPtr->scrAddrCcSet_.erase(scrAddrIter);
-   }
-}
-
-void ColoredCoinTrackerAsync::addScrAddrOp(
-   std::map<BinaryData, OpPtrSet>& addrMap
-   , const std::shared_ptr<CcOutpoint>& opPtr)
-{
-   auto scrAddrIter = addrMap.find(opPtr->getScrAddr()->getRef());
-   if (scrAddrIter == addrMap.end()) {
-      scrAddrIter = addrMap.insert(std::make_pair(
-         opPtr->getScrAddr()->getRef(), OpPtrSet())).first;
-   }
-
-   scrAddrIter->second.insert(opPtr);
-}
-
 void ColoredCoinTrackerAsync::addUtxo(
    const std::shared_ptr<ColoredCoinSnapshot>& ssPtr
    , const BinaryData& txHash, unsigned txOutIndex
    , uint64_t value, const BinaryData& scrAddr)
 {
-   std::shared_ptr<BinaryData> hashPtr;
-   auto hashIter = ssPtr->utxoSet_.find(txHash.getRef());
-   if (hashIter == ssPtr->utxoSet_.end()) {
-      //create hash shared_ptr and map entry
-      hashPtr = std::make_shared<BinaryData>(txHash);
-      hashIter = ssPtr->utxoSet_.insert(std::make_pair(
-         hashPtr->getRef(), std::map<unsigned, std::shared_ptr<CcOutpoint>>())).first;
-   } else {
-      //already have this hash entry, recover the hash shared_ptr
-      if (hashIter->second.size() == 0)
-         throw ColoredCoinException("empty utxo hash map");
-
-      auto opPtr = hashIter->second.begin()->second;
-      if (opPtr == nullptr) {
-         throw ColoredCoinException("null utxo ptr");
-      }
-      hashPtr = opPtr->getTxHash();
-   }
-
-   //create output ptr
-   auto opPtr = std::make_shared<CcOutpoint>(value, txOutIndex);
-   opPtr->setTxHash(hashPtr);
-
-   auto scrAddrPtr = getScrAddrPtr(ssPtr->scrAddrCcSet_, scrAddr);
-   if (scrAddrPtr == nullptr) {
-      scrAddrPtr = std::make_shared<BinaryData>(scrAddr);
-   }
-   opPtr->setScrAddr(scrAddrPtr);
-
-   //add to utxo set
-   hashIter->second.insert(std::make_pair(txOutIndex, opPtr));
-
-   //add to scrAddr to utxo map
-   addScrAddrOp(ssPtr->scrAddrCcSet_, opPtr);
+   //add to utxo set and scrAddr to utxo map
+   ssPtr->utxoSet_.add(txHash, txOutIndex, value, scrAddr);
 }
 
 void ColoredCoinTrackerAsync::addZcUtxo(
-   const std::shared_ptr<ColoredCoinSnapshot>& ssPtr
-   , const std::shared_ptr<ColoredCoinZCSnapshot>& zcPtr
+   const std::shared_ptr<ColoredCoinZCSnapshot>& zcPtr
    , const BinaryData& txHash, unsigned txOutIndex
    , uint64_t value, const BinaryData& scrAddr)
 {
-   std::shared_ptr<BinaryData> hashPtr;
-   auto hashIter = zcPtr->utxoSet_.find(txHash.getRef());
-   if (hashIter == zcPtr->utxoSet_.end()) {
-      //dont have this entry, does the snapshot carry the hash shared_ptr?
-      auto ssIter = ssPtr->utxoSet_.find(txHash.getRef());
-      if (ssIter != ssPtr->utxoSet_.end() && ssIter->second.size() != 0) {
-         hashPtr = ssIter->second.begin()->second->getTxHash();
-      } else {
-         //otherwise created the hash shared_ptr
-         hashPtr = std::make_shared<BinaryData>(txHash);
-      }
-
-      //add the hash entry to the zc snapshot utxo map
-      hashIter = zcPtr->utxoSet_.insert(std::make_pair(
-         hashPtr->getRef(), std::map<unsigned, std::shared_ptr<CcOutpoint>>())).first;
-   } else {
-      //already have this hash entry, recover the hash shared_ptr
-      if (hashIter->second.size() == 0) {
-         throw ColoredCoinException("empty utxo hash map");
-      }
-      auto opPtr = hashIter->second.begin()->second;
-      if (opPtr == nullptr) {
-         throw ColoredCoinException("null utxo ptr");
-      }
-      hashPtr = opPtr->getTxHash();
-   }
-
-   //create output ptr
-   auto opPtr = std::make_shared<CcOutpoint>(value, txOutIndex);
-   opPtr->setTxHash(hashPtr);
-
-   //look for ths scrAddr shared_ptr in the confirmed snapshot 
-   auto scrAddrPtr = getScrAddrPtr(ssPtr->scrAddrCcSet_, scrAddr);
-   if (scrAddrPtr == nullptr) {
-      //missing from that snapshot, is it in the zc snapshot instead?
-      scrAddrPtr = getScrAddrPtr(zcPtr->scrAddrCcSet_, scrAddr);
-
-      //otherwise create it
-      if (scrAddrPtr == nullptr)
-         scrAddrPtr = std::make_shared<BinaryData>(scrAddr);
-   }
-
-   opPtr->setScrAddr(scrAddrPtr);
-
-   //add to utxo set
-   hashIter->second.insert(std::make_pair(txOutIndex, opPtr));
-
-   //add to scrAddr to utxo map
-   addScrAddrOp(zcPtr->scrAddrCcSet_, opPtr);
+   zcPtr->utxoSet_.add(txHash, txOutIndex, value, scrAddr);
 }
 
 void ColoredCoinTrackerAsync::reorg(bool hard)
@@ -71,23 +71,10 @@ private:
       uint64_t value, const BinaryData& scrAddr);
 
    void addZcUtxo(
-      const std::shared_ptr<ColoredCoinSnapshot>&,
       const std::shared_ptr<ColoredCoinZCSnapshot>&,
       const BinaryData& txHash, unsigned txOutIndex,
       uint64_t value, const BinaryData& scrAddr);
 
-   const std::shared_ptr<BinaryData> getScrAddrPtr(
-      const std::map<BinaryData, OpPtrSet>&,
-      const BinaryData&) const;
-
-   void eraseScrAddrOp(
-      const std::shared_ptr<ColoredCoinSnapshot> &,
-      const std::shared_ptr<CcOutpoint>&);
-   
-   void addScrAddrOp(
-      std::map<BinaryData, OpPtrSet>&,
-      const std::shared_ptr<CcOutpoint>&);
-
    uint64_t getCcOutputValue(
       const std::shared_ptr<ColoredCoinSnapshot> &
       , const std::shared_ptr<ColoredCoinZCSnapshot>&
@@ -0,0 +1,296 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#include "CcUtxoStore.h"
+
+#include <stdexcept>
+
+namespace {
+   const size_t kMinSlots = 1024;
+
+   //small tables are not worth rebuilding
+   const size_t kMinCompactIds = 64 * 1024;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CcIdTable::Index::Index(size_t slotCount)
+   : mask_(slotCount - 1)
+   , slots_(new std::atomic<uint32_t>[slotCount])
+   , entries_(new Entry[slotCount / 2])
+{
+   for (size_t i = 0; i < slotCount; ++i) {
+      slots_[i].store(kInvalidId, std::memory_order_relaxed);
+   }
+}
+
+////
+size_t CcIdTable::slotOf(const Index& index, const uint8_t* data, size_t size)
+{
+   //linear probing, the table is kept at most half full
+   auto slot = static_cast<size_t>((static_cast<uint64_t>(CcKeyHash{}(data, size))
+      * 0x9E3779B97F4A7C15ULL) >> 32) & index.mask_;
+   while (true) {
+      const auto id = index.slots_[slot].load(std::memory_order_acquire);
+      if (id == kInvalidId) {
+         return slot;
+      }
+      const auto& entry = index.entries_[id];
+      if ((entry.size_ == size) && (std::memcmp(entry.data_, data, size) == 0)) {
+         return slot;
+      }
+      slot = (slot + 1) & index.mask_;
+   }
+}
+
+////
+CcIdTable::Index* CcIdTable::grow()
+{
+   const auto current = index_.load(std::memory_order_relaxed);
+   const auto count = size_.load(std::memory_order_relaxed);
+   auto index = std::make_unique<Index>(
+      std::max(kMinSlots, current ? (current->mask_ + 1) * 2 : 0));
+   for (uint32_t id = 0; id < count; ++id) {
+      const auto& entry = current->entries_[id];
+      index->entries_[id] = entry;
+      index->slots_[slotOf(*index, entry.data_, entry.size_)].store(
+         id, std::memory_order_relaxed);
+   }
+
+   //readers may still walk the old index, it's retired but not freed
+   index_.store(index.get(), std::memory_order_release);
+   indices_.push_back(std::move(index));
+   return indices_.back().get();
+}
+
+////
+uint32_t CcIdTable::find(const BinaryData& value) const
+{
+   const auto index = index_.load(std::memory_order_acquire);
+   if (index == nullptr) {
+      return kInvalidId;
+   }
+   return index->slots_[slotOf(*index, value.getPtr(), value.getSize())].load(
+      std::memory_order_acquire);
+}
+
+////
+uint32_t CcIdTable::insert(const BinaryData& value)
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   const auto count = size_.load(std::memory_order_relaxed);
+   auto index = index_.load(std::memory_order_relaxed);
+   if ((index == nullptr) || ((static_cast<size_t>(count) + 1) * 2 > index->mask_ + 1)) {
+      index = grow();
+   }
+   auto& slot = index->slots_[slotOf(*index, value.getPtr(), value.getSize())];
+   const auto existingId = slot.load(std::memory_order_relaxed);
+   if (existingId != kInvalidId) {
+      return existingId;
+   }
+   if (count >= kInvalidId) {
+      throw std::runtime_error("id table is full");
+   }
+
+   //values are never moved, refs handed out stay valid
+   const auto size = value.getSize();
+   uint8_t* data = nullptr;
+   if (size > kChunkSize / 4) {
+      large_.emplace_back(new uint8_t[size]);
+      data = large_.back().get();
+   }
+   else {
+      if (chunkUsed_ + size > kChunkSize) {
+         chunks_.emplace_back(new uint8_t[kChunkSize]);
+         chunkUsed_ = 0;
+      }
+      data = chunks_.back().get() + chunkUsed_;
+      chunkUsed_ += size;
+   }
+   if (size > 0) {
+      std::memcpy(data, value.getPtr(), size);
+   }
+
+   const auto id = count;
+   index->entries_[id] = { data, static_cast<uint32_t>(size) };
+   size_.store(id + 1, std::memory_order_release);
+   slot.store(id, std::memory_order_release);
+   return id;
+}
+
+////
+BinaryDataRef CcIdTable::get(uint32_t id) const
+{
+   //any index loaded after the count has the entry
+   if (id >= size_.load(std::memory_order_acquire)) {
+      throw std::runtime_error("invalid id");
+   }
+   const auto& entry = index_.load(std::memory_order_acquire)->entries_[id];
+   return BinaryDataRef(entry.data_, entry.size_);
+}
+
+////
+size_t CcIdTable::size() const
+{
+   return size_.load(std::memory_order_acquire);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint32_t CcUtxoStore::txId(const BinaryData& txHash) const
+{
+   if (ids_ == nullptr) {
+      return CcIdTable::kInvalidId;
+   }
+   return ids_->txHashes_.find(txHash);
+}
+
+////
+uint32_t CcUtxoStore::addrId(const BinaryData& scrAddr) const
+{
+   if (ids_ == nullptr) {
+      return CcIdTable::kInvalidId;
+   }
+   return ids_->scrAddrs_.find(scrAddr);
+}
+
+////
+const CcOutput* CcUtxoStore::find(const BinaryData& txHash, unsigned txOutIndex) const
+{
+   const auto utxoIter = utxos_.find(txId(txHash));
+   if (utxoIter == utxos_.end()) {
+      return nullptr;
+   }
+   const auto& outputs = utxoIter->second;
+   const auto outIter = std::lower_bound(outputs.begin(), outputs.end(), txOutIndex,
+      [](const CcOutput& output, unsigned index) { return output.index_ < index; });
+   if (outIter == outputs.end() || outIter->index_ != txOutIndex) {
+      return nullptr;
+   }
+   return &*outIter;
+}
+
+////
+bool CcUtxoStore::hasTx(const BinaryData& txHash) const
+{
+   return utxos_.count(txId(txHash)) > 0;
+}
+
+////
+bool CcUtxoStore::hasAddress(const BinaryData& scrAddr) const
+{
+   return addresses_.count(addrId(scrAddr)) > 0;
+}
+
+////
+BinaryDataRef CcUtxoStore::scrAddr(const CcOutput& output) const
+{
+   return ids_->scrAddrs_.get(output.scrAddrId_);
+}
+
+////
+bool CcUtxoStore::add(const BinaryData& txHash, unsigned txOutIndex,
+   uint64_t value, const BinaryData& scrAddr)
+{
+   if (ids_ == nullptr) {
+      ids_ = std::make_shared<Ids>();
+   }
+   const auto tId = ids_->txHashes_.insert(txHash);
+
+   auto& outputs = utxos_[tId];
+   auto outIter = std::lower_bound(outputs.begin(), outputs.end(), txOutIndex,
+      [](const CcOutput& output, unsigned index) { return output.index_ < index; });
+   if (outIter != outputs.end() && outIter->index_ == txOutIndex) {
+      return false;
+   }
+   const auto aId = ids_->scrAddrs_.insert(scrAddr);
+   outputs.insert(outIter, { txOutIndex, aId, value });
+
+   const OutpointId opId{ tId, txOutIndex };
+   auto& addrOutpoints = addresses_[aId];
+   addrOutpoints.insert(std::upper_bound(
+      addrOutpoints.begin(), addrOutpoints.end(), opId), opId);
+   return true;
+}
+
+////
+void CcUtxoStore::eraseAddressEntry(uint32_t aId, const OutpointId& opId)
+{
+   auto addrOutpoints = addresses_.findMutable(aId);
+   if (addrOutpoints == nullptr) {
+      return;
+   }
+   const auto opIter = std::lower_bound(addrOutpoints->begin(), addrOutpoints->end(), opId);
+   if (opIter != addrOutpoints->end() && *opIter == opId) {
+      addrOutpoints->erase(opIter);
+   }
+   if (addrOutpoints->empty()) {
+      addresses_.erase(aId);
+   }
+}
+
+////
+bool CcUtxoStore::erase(const BinaryData& txHash, unsigned txOutIndex)
+{
+   const auto tId = txId(txHash);
+   if (find(txHash, txOutIndex) == nullptr) {
+      return false;
+   }
+
+   auto outputs = utxos_.findMutable(tId);
+   const auto outIter = std::lower_bound(outputs->begin(), outputs->end(), txOutIndex,
+      [](const CcOutput& output, unsigned index) { return output.index_ < index; });
+   eraseAddressEntry(outIter->scrAddrId_, { tId, txOutIndex });
+
+   outputs->erase(outIter);
+   if (outputs->empty()) {
+      utxos_.erase(tId);
+   }
+   return true;
+}
+
+////
+void CcUtxoStore::eraseTx(const BinaryData& txHash)
+{
+   const auto tId = txId(txHash);
+   const auto utxoIter = utxos_.find(tId);
+   if (utxoIter == utxos_.end()) {
+      return;
+   }
+   for (const auto& output : utxoIter->second) {
+      eraseAddressEntry(output.scrAddrId_, { tId, output.index_ });
+   }
+   utxos_.erase(tId);
+}
+
+////
+bool CcUtxoStore::needsCompaction() const
+{
+   if (ids_ == nullptr) {
+      return false;
+   }
+   const auto idCount = ids_->txHashes_.size() + ids_->scrAddrs_.size();
+   const auto liveCount = utxos_.size() + addresses_.size();
+   return (idCount > kMinCompactIds) && (idCount > 2 * liveCount);
+}
+
+////
+void CcUtxoStore::compact()
+{
+   CcUtxoStore result;
+   forEachTx([this, &result](const BinaryDataRef& txHash, const Outputs& outputs)
+   {
+      const BinaryData txHashData(txHash.getPtr(), txHash.getSize());
+      for (const auto& output : outputs) {
+         const auto addr = scrAddr(output);
+         result.add(txHashData, output.index_, output.value_
+            , BinaryData(addr.getPtr(), addr.getSize()));
+      }
+   });
+   *this = std::move(result);
+}
@@ -0,0 +1,294 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#ifndef CC_UTXO_STORE_H
+#define CC_UTXO_STORE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "BinaryData.h"
+#include "PersistentMap.h"
+
+////
+struct CcKeyHash
+{
+   //keys are tx hashes and prefixed scrAddr, their tail bytes are random
+   size_t operator() (const uint8_t *data, size_t size) const
+   {
+      size_t result = 0;
+      const auto len = std::min(size, sizeof(result));
+      if (len > 0) {
+         std::memcpy(&result, data + size - len, len);
+      }
+      return result;
+   }
+
+   size_t operator() (const BinaryData& key) const
+   {
+      return (*this)(key.getPtr(), key.getSize());
+   }
+};
+
+////
+/*
+Append-only table of tx hashes or scrAddrs with 32-bit ids. Values are
+packed in large chunks and indexed with an open addressing hash table.
+Ids and returned refs are valid for the lifetime of the table.
+Thread-safe, shared between snapshot versions. Reads are lock-free: the
+index is published via an atomic pointer and replaced on growth, retired
+indices are kept until the table is destroyed. Writers are serialized.
+*/
+class CcIdTable
+{
+public:
+   static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+   CcIdTable() = default;
+   CcIdTable(const CcIdTable&) = delete;
+   CcIdTable& operator = (const CcIdTable&) = delete;
+
+   uint32_t find(const BinaryData&) const;
+   uint32_t insert(const BinaryData&);
+   BinaryDataRef get(uint32_t id) const;
+
+   size_t size(void) const;
+
+private:
+   struct Entry
+   {
+      const uint8_t* data_;
+      uint32_t size_;
+   };
+
+   //entries are written before their slot or count is published
+   struct Index
+   {
+      explicit Index(size_t slotCount);
+
+      const size_t mask_;
+      std::unique_ptr<std::atomic<uint32_t>[]> slots_;
+      std::unique_ptr<Entry[]> entries_;  //(mask_ + 1) / 2 capacity
+   };
+
+   static size_t slotOf(const Index&, const uint8_t*, size_t);
+   Index* grow(void);
+
+private:
+   static constexpr size_t kChunkSize = 64 * 1024;
+
+   std::atomic<Index*> index_{ nullptr };
+   std::atomic<uint32_t> size_{ 0 };
+
+   //guarded by mutex_
+   std::mutex mutex_;
+   std::vector<std::unique_ptr<Index>> indices_;
+   std::vector<std::unique_ptr<uint8_t[]>> chunks_;
+   std::vector<std::unique_ptr<uint8_t[]>> large_;
+   size_t chunkUsed_ = kChunkSize;
+};
+
+////
+struct CcOutput
+{
+   uint32_t index_;
+   uint32_t scrAddrId_;
+   uint64_t value_;
+
+   bool operator==(const CcOutput& rhs) const
+   {
+      return index_ == rhs.index_ && scrAddrId_ == rhs.scrAddrId_
+         && value_ == rhs.value_;
+   }
+};
+
+////
+/*
+Outpoints of a snapshot: per tx arrays of outputs sorted by index, and per
+scrAddr arrays of outpoint ids, kept in persistent maps keyed by interned
+ids. 16 bytes per output and 8 per address entry, no per outpoint heap
+objects. Copies share structure and id tables with the original.
+
+Lookups take full hashes and prefixed scrAddrs.
+*/
+class CcUtxoStore
+{
+public:
+   using Outputs = std::vector<CcOutput>;
+
+   ////
+   const CcOutput* find(const BinaryData& txHash, unsigned txOutIndex) const;
+   bool hasTx(const BinaryData& txHash) const;
+   bool hasAddress(const BinaryData& scrAddr) const;
+   BinaryDataRef scrAddr(const CcOutput&) const;
+
+   size_t txCount(void) const { return utxos_.size(); }
+   size_t addressCount(void) const { return addresses_.size(); }
+
+   //f(BinaryDataRef txHash, const Outputs&)
+   template<class F> void forEachTx(const F&) const;
+
+   //f(BinaryDataRef scrAddr)
+   template<class F> void forEachAddress(const F&) const;
+
+   //f(BinaryDataRef txHash, const CcOutput&), in txHash, txOutIndex order
+   template<class F> void forEachAddressOutput(const BinaryData& scrAddr, const F&) const;
+
+   //reports txs with changed outputs since base, which is either an older
+   //version of this store or an empty one
+   //f(BinaryDataRef txHash, const Outputs* baseOutputs, const Outputs* outputs)
+   template<class F> void diff(const CcUtxoStore& base, const F&) const;
+
+   ////
+   //returns false if the outpoint is already there
+   bool add(const BinaryData& txHash, unsigned txOutIndex,
+      uint64_t value, const BinaryData& scrAddr);
+
+   //returns false if the outpoint is missing
+   bool erase(const BinaryData& txHash, unsigned txOutIndex);
+
+   void eraseTx(const BinaryData& txHash);
+
+   ////
+   //ids of erased values are never reused, true once they outnumber live ones
+   bool needsCompaction(void) const;
+
+   //rebuilds id tables with live values only, the store is no longer
+   //related to its other versions (see diff())
+   void compact(void);
+
+   bool sharesIds(const CcUtxoStore& other) const
+   {
+      return !ids_ || !other.ids_ || (ids_ == other.ids_);
+   }
+
+private:
+   struct Ids
+   {
+      CcIdTable txHashes_;
+      CcIdTable scrAddrs_;
+   };
+
+   struct OutpointId
+   {
+      uint32_t txId_;
+      uint32_t index_;
+
+      bool operator<(const OutpointId& rhs) const
+      {
+         return (txId_ != rhs.txId_) ? (txId_ < rhs.txId_) : (index_ < rhs.index_);
+      }
+      bool operator==(const OutpointId& rhs) const
+      {
+         return (txId_ == rhs.txId_) && (index_ == rhs.index_);
+      }
+   };
+
+   uint32_t txId(const BinaryData&) const;
+   uint32_t addrId(const BinaryData&) const;
+   void eraseAddressEntry(uint32_t addrId, const OutpointId&);
+
+private:
+   //created on first add, shared by copies
+   std::shared_ptr<Ids> ids_;
+
+   //<txId, outputs>
+   bs::PersistentMap<uint32_t, Outputs> utxos_;
+
+   //<scrAddrId, sorted outpoint ids>
+   bs::PersistentMap<uint32_t, std::vector<OutpointId>> addresses_;
+};
+
+////
+template<class F>
+void CcUtxoStore::forEachTx(const F& f) const
+{
+   for (const auto& utxo : utxos_) {
+      f(ids_->txHashes_.get(utxo.first), utxo.second);
+   }
+}
+
+template<class F>
+void CcUtxoStore::forEachAddress(const F& f) const
+{
+   for (const auto& addr : addresses_) {
+      f(ids_->scrAddrs_.get(addr.first));
+   }
+}
+
+template<class F>
+void CcUtxoStore::forEachAddressOutput(const BinaryData& scrAddr, const F& f) const
+{
+   const auto addrIter = addresses_.find(addrId(scrAddr));
+   if (addrIter == addresses_.end()) {
+      return;
+   }
+
+   std::vector<std::pair<BinaryDataRef, const CcOutput*>> outputs;
+   outputs.reserve(addrIter->second.size());
+   for (const auto& opId : addrIter->second) {
+      const auto utxoIter = utxos_.find(opId.txId_);
+      if (utxoIter == utxos_.end()) {
+         continue;
+      }
+      const auto& txOutputs = utxoIter->second;
+      const auto outIter = std::lower_bound(txOutputs.begin(), txOutputs.end(), opId.index_,
+         [](const CcOutput& output, uint32_t index) { return output.index_ < index; });
+      if (outIter != txOutputs.end() && outIter->index_ == opId.index_) {
+         outputs.emplace_back(ids_->txHashes_.get(opId.txId_), &*outIter);
+      }
+   }
+
+   //ids follow insertion order, keep the hash order of former outpoint sets
+   std::sort(outputs.begin(), outputs.end(),
+      [](const std::pair<BinaryDataRef, const CcOutput*>& lhs,
+         const std::pair<BinaryDataRef, const CcOutput*>& rhs)
+   {
+      const auto cmp = std::memcmp(lhs.first.getPtr(), rhs.first.getPtr(),
+         std::min(lhs.first.getSize(), rhs.first.getSize()));
+      if (cmp != 0) {
+         return cmp < 0;
+      }
+      if (lhs.first.getSize() != rhs.first.getSize()) {
+         return lhs.first.getSize() < rhs.first.getSize();
+      }
+      return lhs.second->index_ < rhs.second->index_;
+   });
+
+   for (const auto& output : outputs) {
+      f(output.first, *output.second);
+   }
+}
+
+template<class F>
+void CcUtxoStore::diff(const CcUtxoStore& base, const F& f) const
+{
+   //ids are only meaningful within one family of versions
+   if (!sharesIds(base)) {
+      throw std::invalid_argument("unrelated utxo store");
+   }
+   const auto& ids = ids_ ? ids_ : base.ids_;
+   utxos_.diff(base.utxos_, [&ids, &f](uint32_t txId
+      , const Outputs* baseOutputs, const Outputs* outputs)
+   {
+      if (baseOutputs && outputs && (*baseOutputs == *outputs)) {
+         return;
+      }
+      f(ids->txHashes_.get(txId), baseOutputs, outputs);
+   });
+}
+
+#endif // CC_UTXO_STORE_H
@@ -15,6 +15,7 @@
 
 #include <string>
 #include <memory>
+#include "StreamFramer.h"
 
 namespace bs {
    namespace celer {
@@ -24,7 +25,7 @@ namespace bs {
       public:
          ClientConnection(const std::shared_ptr<spdlog::logger>& logger)
             : _S(logger)
-            , pendingDataSize_(0)
+            , framer_(std::make_unique<bs::network::VarintFrameParser>(kMaxSizeBytes))
          {}
 
          ~ClientConnection() noexcept = default;
@@ -38,82 +39,39 @@ namespace bs {
       public:
          bool send(const std::string& data) override
          {
-            auto size = data.size();
-            char sizeBuffer[4];
-            uint32_t bufferLength = 0;
-
-            while (true) {
-               if (bufferLength == 4) {
-                  return false;
-               }
-
-               sizeBuffer[bufferLength] = size & 0x7f;
-               size = size >> 7;
-               if (size == 0) {
-                  break;
-               }
+            const auto message = frame(data);
+            if (message.empty()) {
+               return false;
+            }
+            return _S::sendRawData(message);
+         }
 
-               sizeBuffer[bufferLength] |= 0x80;
-               ++bufferLength;
+         // returns empty string if data is too large
+         std::string frame(const std::string& data) const
+         {
+            auto message = bs::network::VarintFrameParser::encodePrefix(data.size(), kMaxSizeBytes);
+            if (message.empty()) {
+               return {};
             }
-            return _S::sendRawData(std::string((char*)sizeBuffer, bufferLength + 1) + data);
+            message.append(data);
+            return message;
          }
 
       protected:
          void onRawDataReceived(const std::string& rawData) override
          {
-            pendingData_.append(rawData);
-
-            while (!pendingData_.empty()) {
-               if (pendingDataSize_ == 0) {
-                  const char* sizeBuffer = pendingData_.c_str();
-
-                  int offset = 0;
-                  int sizeBytesCount = 0;
-
-                  while (true) {
-                     if (offset >= pendingData_.size()) {
-                        _S::logger_->error("[CelerClientConnection] not all size bytes received");
-                        return;
-                     }
-
-                     if (sizeBuffer[offset] & 0x80) {
-                        if (offset == 3) {
-                           // we do not expect more than 4 bytes for size
-                           _S::logger_->error("[CelerClientConnection] could not decode size");
-                           return;
-                        }
-
-                        offset += 1;
-                     } else {
-                        break;
-                     }
-                  }
-
-                  sizeBytesCount = offset + 1;
-
-                  while (offset >= 0) {
-                     pendingDataSize_ = pendingDataSize_ << 7;
-                     pendingDataSize_ |= (sizeBuffer[offset] & 0x7f);
-                     offset -= 1;
-                  }
-
-                  pendingData_ = pendingData_.substr(sizeBytesCount);
-               }
-
-               if (pendingDataSize_ > pendingData_.size()) {
-                  break;
-               }
-
-               _S::notifyOnData(pendingData_.substr(0, pendingDataSize_));
-               pendingData_ = pendingData_.substr(pendingDataSize_);
-               pendingDataSize_ = 0;
+            const bool result = framer_.process(rawData, [this](std::string_view message) {
+               _S::notifyOnData(std::string(message));
+            });
+            if (!result) {
+               // we do not expect more than 4 bytes for size
+               _S::logger_->error("[CelerClientConnection] could not decode size");
             }
          }
 
       private:
-         size_t      pendingDataSize_;
-         std::string pendingData_;
+         static constexpr size_t kMaxSizeBytes = 4;
+         bs::network::StreamFramer framer_;
       };
 
    }  //namespace celer
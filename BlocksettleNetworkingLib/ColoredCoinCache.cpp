@@ -11,56 +11,43 @@
 
 #include "ColoredCoinCache.h"
 
+#include <lmdbpp.h>
 #include "ColoredCoinLogic.h"
 #include "cc_snapshots.pb.h"
 
 namespace {
 
-   std::shared_ptr<BinaryData> getOrInsert(const BinaryData &hash, std::map<BinaryData, std::shared_ptr<BinaryData>> &txHashes)
-   {
-      auto &elem = txHashes[hash];
-      if (!elem) {
-         elem = std::make_shared<BinaryData>(hash);
-      }
-      return elem;
-   }
+   const uint8_t kCheckpointPrefix = 0xCC;
+   const uint8_t kRecordVersion = 2;
+   const uint8_t kFullRecord = 0;
+   const uint8_t kDeltaRecord = 1;
+
+   // Many small deltas for blocks without CC activity add up as well
+   const uint32_t kMaxDeltaRecords = 256;
 
-   void serializeUtxoSet(const CcUtxoSet &utxoSet, bs::cc_snapshots::ColoredCoinSnapshot &msg)
+   const size_t kMinMapSize = 16 * 1024 * 1024;
+   const size_t kMapSizeStep = 1024 * 1024;
+
+   void serializeUtxoSet(const CcUtxoStore &utxoSet, bs::cc_snapshots::ColoredCoinSnapshot &msg)
    {
-      for (const auto &utxo : utxoSet) {
-         for (const auto &item : utxo.second) {
-            const auto &point = *item.second;
+      utxoSet.forEachTx([&utxoSet, &msg](const BinaryDataRef &txHash
+         , const CcUtxoStore::Outputs &outputs)
+      {
+         for (const auto &output : outputs) {
             auto d = msg.add_outpoints();
-            d->set_value(point.value());
-            d->set_index(point.index());
-            d->set_tx_hash(point.getTxHash()->toBinStr());
-            d->set_scr_addr(point.getScrAddr()->toBinStr());
+            d->set_value(output.value_);
+            d->set_index(output.index_);
+            d->set_tx_hash(txHash.toBinStr());
+            d->set_scr_addr(utxoSet.scrAddr(output).toBinStr());
          }
-      }
+      });
    }
 
-   bool deserializeUtxoSet(const bs::cc_snapshots::ColoredCoinSnapshot &msg, CcUtxoSet &utxoSet, ScrAddrCcSet &scrAddrCcSet)
+   bool deserializeUtxoSet(const bs::cc_snapshots::ColoredCoinSnapshot &msg, CcUtxoStore &utxoSet)
    {
-      std::map<BinaryData, std::shared_ptr<BinaryData>> txHashes;
-      std::map<BinaryData, std::shared_ptr<BinaryData>> scrAddresses;
-
       for (const auto &d : msg.outpoints()) {
-         auto point = std::make_shared<CcOutpoint>(d.value(), d.index());
-         const auto txHash = BinaryData::fromString(d.tx_hash());
-         const auto scrAddr = BinaryData::fromString(d.scr_addr());
-
-         point->setTxHash(getOrInsert(txHash, txHashes));
-         point->setScrAddr(getOrInsert(scrAddr, scrAddresses));
-
-         auto &utxo = utxoSet[txHash];
-         auto utxoItem = utxo.emplace(point->index(), point);
-         if (!utxoItem.second) {
-            return false;
-         }
-
-         auto &scrAddrSet = scrAddrCcSet[scrAddr];
-         auto scrAddrItem = scrAddrSet.emplace(point);
-         if (!scrAddrItem.second) {
+         if (!utxoSet.add(BinaryData::fromString(d.tx_hash()), d.index()
+            , d.value(), BinaryData::fromString(d.scr_addr()))) {
             return false;
          }
       }
@@ -91,6 +78,227 @@ namespace {
       }
    }
 
+
+   ////
+   void putBytes(BinaryWriter &bw, const BinaryDataRef &data)
+   {
+      bw.put_var_int(data.getSize());
+      bw.put_BinaryDataRef(data);
+   }
+
+   BinaryDataRef getBytes(BinaryRefReader &brr)
+   {
+      const auto len = brr.get_var_int();
+      return brr.get_BinaryDataRef(static_cast<uint32_t>(len));
+   }
+
+   BinaryData checkpointKey(uint32_t seq)
+   {
+      BinaryWriter bwKey;
+      bwKey.put_uint8_t(kCheckpointPrefix);
+      bwKey.put_uint32_t(seq, BE);
+      return bwKey.getData();
+   }
+
+   /*
+   Record layout:
+      version, type, startHeight, processedHeight
+      block hash at startHeight - 1, coinsPerShare, origin addresses
+      address table: scrAddrs referred to by utxo entries
+      utxo entries: txHash, flag (0 - erased), outputs (index, value, address id)
+      tx history entries: txHash, flag, indices
+      revoked address entries: scrAddr, flag, height
+   Delta entries replace whole values of changed keys. Full record is a
+   delta from the empty snapshot.
+   */
+   void putUtxoDiff(BinaryWriter &bw, const CcUtxoStore &base, const CcUtxoStore &utxos)
+   {
+      using Outputs = CcUtxoStore::Outputs;
+      BinaryWriter entries;
+      size_t count = 0;
+      std::map<uint32_t, uint64_t> addrIds;
+      std::vector<BinaryDataRef> addresses;
+
+      utxos.diff(base, [&](const BinaryDataRef &txHash
+         , const Outputs *, const Outputs *outputs)
+      {
+         ++count;
+         putBytes(entries, txHash);
+         entries.put_uint8_t(outputs ? 1 : 0);
+         if (!outputs) {
+            return;
+         }
+         entries.put_var_int(outputs->size());
+         for (const auto &output : *outputs) {
+            auto addrIt = addrIds.find(output.scrAddrId_);
+            if (addrIt == addrIds.end()) {
+               addrIt = addrIds.emplace(output.scrAddrId_, addresses.size()).first;
+               addresses.push_back(utxos.scrAddr(output));
+            }
+            entries.put_var_int(output.index_);
+            entries.put_uint64_t(output.value_);
+            entries.put_var_int(addrIt->second);
+         }
+      });
+
+      bw.put_var_int(addresses.size());
+      for (const auto &addr : addresses) {
+         putBytes(bw, addr);
+      }
+      bw.put_var_int(count);
+      bw.put_BinaryData(entries.getData());
+   }
+
+   void putHistoryDiff(BinaryWriter &bw, const OutPointsSet &base, const OutPointsSet &history)
+   {
+      BinaryWriter entries;
+      size_t count = 0;
+      history.diff(base, [&entries, &count](const BinaryData &txHash
+         , const std::set<unsigned> *baseIndices, const std::set<unsigned> *indices)
+      {
+         if (baseIndices && indices && (*baseIndices == *indices)) {
+            return;
+         }
+         ++count;
+         putBytes(entries, txHash);
+         entries.put_uint8_t(indices ? 1 : 0);
+         if (!indices) {
+            return;
+         }
+         entries.put_var_int(indices->size());
+         for (const auto index : *indices) {
+            entries.put_var_int(index);
+         }
+      });
+      bw.put_var_int(count);
+      bw.put_BinaryData(entries.getData());
+   }
+
+   void putRevokedDiff(BinaryWriter &bw, const CcMap<unsigned> &base, const CcMap<unsigned> &revoked)
+   {
+      BinaryWriter entries;
+      size_t count = 0;
+      revoked.diff(base, [&entries, &count](const BinaryData &scrAddr
+         , const unsigned *baseHeight, const unsigned *height)
+      {
+         if (baseHeight && height && (*baseHeight == *height)) {
+            return;
+         }
+         ++count;
+         putBytes(entries, scrAddr);
+         entries.put_uint8_t(height ? 1 : 0);
+         if (height) {
+            entries.put_uint32_t(*height);
+         }
+      });
+      bw.put_var_int(count);
+      bw.put_BinaryData(entries.getData());
+   }
+
+   ////
+   void readUtxos(BinaryRefReader &brr, ColoredCoinSnapshot &snapshot)
+   {
+      std::vector<BinaryData> addresses(brr.get_var_int());
+      for (auto &addr : addresses) {
+         addr = getBytes(brr);
+      }
+
+      const auto count = brr.get_var_int();
+      for (uint64_t i = 0; i < count; ++i) {
+         const BinaryData txHash(getBytes(brr));
+         snapshot.utxoSet_.eraseTx(txHash);
+         if (brr.get_uint8_t() == 0) {
+            continue;
+         }
+
+         const auto nbOutputs = brr.get_var_int();
+         for (uint64_t j = 0; j < nbOutputs; ++j) {
+            const auto index = static_cast<unsigned>(brr.get_var_int());
+            const auto value = brr.get_uint64_t();
+            const auto addrId = brr.get_var_int();
+            if (addrId >= addresses.size()) {
+               throw std::runtime_error("invalid address id");
+            }
+            if (!snapshot.utxoSet_.add(txHash, index, value, addresses[addrId])) {
+               throw std::runtime_error("duplicate outpoint");
+            }
+         }
+      }
+   }
+
+   void readHistory(BinaryRefReader &brr, ColoredCoinSnapshot &snapshot)
+   {
+      const auto count = brr.get_var_int();
+      for (uint64_t i = 0; i < count; ++i) {
+         BinaryData txHash(getBytes(brr));
+         if (brr.get_uint8_t() == 0) {
+            snapshot.txHistory_.erase(txHash);
+            continue;
+         }
+         auto &indices = snapshot.txHistory_[txHash];
+         indices.clear();
+         const auto nbIndices = brr.get_var_int();
+         for (uint64_t j = 0; j < nbIndices; ++j) {
+            indices.insert(static_cast<unsigned>(brr.get_var_int()));
+         }
+      }
+   }
+
+   void readRevoked(BinaryRefReader &brr, ColoredCoinSnapshot &snapshot)
+   {
+      const auto count = brr.get_var_int();
+      for (uint64_t i = 0; i < count; ++i) {
+         BinaryData scrAddr(getBytes(brr));
+         if (brr.get_uint8_t() == 0) {
+            snapshot.revokedAddresses_.erase(scrAddr);
+            continue;
+         }
+         snapshot.revokedAddresses_[scrAddr] = brr.get_uint32_t();
+      }
+   }
+
+   // Returns true for full record
+   bool readRecord(BinaryRefReader &brr, ColoredCoinCheckpoints::State &state)
+   {
+      if (brr.get_uint8_t() != kRecordVersion) {
+         throw std::runtime_error("unsupported checkpoint version");
+      }
+      const bool full = (brr.get_uint8_t() == kFullRecord);
+      if (full) {
+         state.snapshot = std::make_shared<ColoredCoinSnapshot>();
+      }
+      else if (!state.snapshot) {
+         throw std::runtime_error("delta without full checkpoint");
+      }
+      state.startHeight = brr.get_uint32_t();
+      state.processedHeight = brr.get_uint32_t();
+      state.blockHash = getBytes(brr);
+
+      const auto coinsPerShare = brr.get_uint64_t();
+      std::set<BinaryData> originAddresses;
+      const auto nbOrigins = brr.get_var_int();
+      for (uint64_t i = 0; i < nbOrigins; ++i) {
+         originAddresses.insert(getBytes(brr));
+      }
+      if (full) {
+         state.coinsPerShare = coinsPerShare;
+         state.originAddresses = std::move(originAddresses);
+      }
+      else if ((coinsPerShare != state.coinsPerShare)
+         || (originAddresses != state.originAddresses)) {
+         throw std::runtime_error("checkpoint instrument mismatch");
+      }
+
+      readUtxos(brr, *state.snapshot);
+      readHistory(brr, *state.snapshot);
+      readRevoked(brr, *state.snapshot);
+
+      if (!brr.isEndOfStream()) {
+         throw std::runtime_error("unexpected checkpoint data");
+      }
+      return full;
+   }
+
 } // namespace
 
 std::string serializeColoredCoinSnapshot(const std::shared_ptr<ColoredCoinSnapshot> &snapshot)
@@ -139,7 +347,7 @@ std::shared_ptr<ColoredCoinSnapshot> deserializeColoredCoinSnapshot(const std::s
 
    auto snapshot = std::make_shared<ColoredCoinSnapshot>();
 
-   result = deserializeUtxoSet(msg, snapshot->utxoSet_, snapshot->scrAddrCcSet_);
+   result = deserializeUtxoSet(msg, snapshot->utxoSet_);
    if (!result) {
       return {};
    }
@@ -163,8 +371,8 @@ std::shared_ptr<ColoredCoinZCSnapshot> deserializeColoredCoinZcSnapshot(const st
 
    auto snapshot = std::make_shared<ColoredCoinZCSnapshot>();
 
-   result = deserializeUtxoSet(msg, snapshot->utxoSet_, snapshot->scrAddrCcSet_);
-   if (!result || snapshot->utxoSet_.empty()) {
+   result = deserializeUtxoSet(msg, snapshot->utxoSet_);
+   if (!result || (snapshot->utxoSet_.txCount() == 0)) {
       return {};
    }
 
@@ -172,3 +380,184 @@ std::shared_ptr<ColoredCoinZCSnapshot> deserializeColoredCoinZcSnapshot(const st
 
    return snapshot;
 }
+
+
+ColoredCoinCheckpoints::ColoredCoinCheckpoints(const std::string &filename)
+   : mapSize_(kMinMapSize)
+{
+   dbEnv_ = std::make_shared<LMDBEnv>();
+   dbEnv_->open(filename);
+   dbEnv_->setMapSize(mapSize_);
+   db_ = std::make_unique<LMDB>(dbEnv_.get(), "cc_checkpoints");
+}
+
+ColoredCoinCheckpoints::~ColoredCoinCheckpoints()
+{
+   db_->close();
+   dbEnv_->close();
+}
+
+ColoredCoinCheckpoints::State ColoredCoinCheckpoints::load()
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   State state;
+   uint32_t lastSeq = 0;
+   uint32_t lastFullSeq = 0;
+   size_t fullSize = 0;
+   size_t deltaSize = 0;
+
+   try {
+      LMDBEnv::Transaction tx(dbEnv_.get(), LMDB::ReadOnly);
+      auto dbIter = db_->begin();
+
+      BinaryWriter bwKey;
+      bwKey.put_uint8_t(kCheckpointPrefix);
+      CharacterArrayRef keyRef(bwKey.getSize(), bwKey.getData().getPtr());
+
+      dbIter.seek(keyRef, LMDB::Iterator::Seek_GE);
+
+      for (; dbIter.isValid(); dbIter.advance()) {
+         auto iterkey = dbIter.key();
+         auto itervalue = dbIter.value();
+
+         BinaryRefReader brrKey(BinaryDataRef((uint8_t*)iterkey.mv_data, iterkey.mv_size));
+         if ((brrKey.getSizeRemaining() != 5) || (brrKey.get_uint8_t() != kCheckpointPrefix)) {
+            break;
+         }
+         lastSeq = brrKey.get_uint32_t(BE);
+
+         //parsed in place, record data is not copied out of the map
+         BinaryRefReader brrVal(BinaryDataRef((uint8_t*)itervalue.mv_data, itervalue.mv_size));
+         if (readRecord(brrVal, state)) {
+            lastFullSeq = lastSeq;
+            fullSize = itervalue.mv_size;
+            deltaSize = 0;
+         }
+         else {
+            deltaSize += itervalue.mv_size;
+         }
+      }
+   }
+   catch (const std::exception &) {
+      return {};
+   }
+   if (!state.snapshot) {
+      return {};
+   }
+
+   last_ = state;
+   nextSeq_ = lastSeq + 1;
+   lastFullSeq_ = lastFullSeq;
+   fullSize_ = fullSize;
+   deltaSize_ = deltaSize;
+   return state;
+}
+
+bool ColoredCoinCheckpoints::append(const State &state)
+{
+   if (!state.snapshot) {
+      return false;
+   }
+   std::lock_guard<std::mutex> lock(mutex_);
+
+   const bool full = !last_.snapshot || (deltaSize_ > fullSize_)
+      || (nextSeq_ - lastFullSeq_ > kMaxDeltaRecords)
+      || (state.coinsPerShare != last_.coinsPerShare)
+      || (state.originAddresses != last_.originAddresses)
+      || !state.snapshot->utxoSet_.sharesIds(last_.snapshot->utxoSet_);
+   const ColoredCoinSnapshot empty;
+   const auto &base = full ? empty : *last_.snapshot;
+
+   BinaryWriter bw;
+   bw.put_uint8_t(kRecordVersion);
+   bw.put_uint8_t(full ? kFullRecord : kDeltaRecord);
+   bw.put_uint32_t(state.startHeight);
+   bw.put_uint32_t(state.processedHeight);
+   putBytes(bw, state.blockHash);
+   bw.put_uint64_t(state.coinsPerShare);
+   bw.put_var_int(state.originAddresses.size());
+   for (const auto &addr : state.originAddresses) {
+      putBytes(bw, addr);
+   }
+   putUtxoDiff(bw, base.utxoSet_, state.snapshot->utxoSet_);
+   putHistoryDiff(bw, base.txHistory_, state.snapshot->txHistory_);
+   putRevokedDiff(bw, base.revokedAddresses_, state.snapshot->revokedAddresses_);
+
+   if (!write(bw.getData(), full)) {
+      return false;
+   }
+   last_ = state;
+   if (full) {
+      fullSize_ = bw.getSize();
+      deltaSize_ = 0;
+   }
+   else {
+      deltaSize_ += bw.getSize();
+   }
+   return true;
+}
+
+void ColoredCoinCheckpoints::reset()
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   try {
+      LMDBEnv::Transaction tx(dbEnv_.get(), LMDB::ReadWrite);
+      eraseAll();
+   }
+   catch (const std::exception &) {}
+
+   last_ = {};
+   fullSize_ = 0;
+   deltaSize_ = 0;
+}
+
+bool ColoredCoinCheckpoints::write(const BinaryData &record, bool full)
+{
+   try {
+      //full record is written before old ones are freed
+      const auto required = 2 * (fullSize_ + deltaSize_ + record.getSize()) + kMinMapSize;
+      if (mapSize_ < required) {
+         mapSize_ = (2 * required + kMapSizeStep - 1) / kMapSizeStep * kMapSizeStep;
+         dbEnv_->setMapSize(mapSize_);
+      }
+
+      LMDBEnv::Transaction tx(dbEnv_.get(), LMDB::ReadWrite);
+      if (full) {
+         eraseAll();
+         lastFullSeq_ = nextSeq_;
+      }
+      const auto key = checkpointKey(nextSeq_);
+      CharacterArrayRef keyRef(key.getSize(), key.getPtr());
+      CharacterArrayRef dataRef(record.getSize(), record.getPtr());
+      db_->insert(keyRef, dataRef);
+   }
+   catch (const std::exception &) {
+      return false;
+   }
+   ++nextSeq_;
+   return true;
+}
+
+void ColoredCoinCheckpoints::eraseAll()
+{
+   std::vector<BinaryData> keys;
+   auto dbIter = db_->begin();
+
+   BinaryWriter bwKey;
+   bwKey.put_uint8_t(kCheckpointPrefix);
+   CharacterArrayRef keyRef(bwKey.getSize(), bwKey.getData().getPtr());
+
+   dbIter.seek(keyRef, LMDB::Iterator::Seek_GE);
+   for (; dbIter.isValid(); dbIter.advance()) {
+      auto iterkey = dbIter.key();
+      BinaryDataRef keyBDR((uint8_t*)iterkey.mv_data, iterkey.mv_size);
+      if ((keyBDR.getSize() == 0) || (keyBDR.getPtr()[0] != kCheckpointPrefix)) {
+         break;
+      }
+      keys.emplace_back(keyBDR);
+   }
+   for (const auto &key : keys) {
+      CharacterArrayRef delKeyRef(key.getSize(), key.getPtr());
+      db_->erase(delKeyRef);
+   }
+}
@@ -12,11 +12,17 @@
 #ifndef COLORED_COIN_CACHE_H
 #define COLORED_COIN_CACHE_H
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include "BinaryData.h"
 
 struct ColoredCoinSnapshot;
 struct ColoredCoinZCSnapshot;
+class LMDB;
+class LMDBEnv;
 
 std::string serializeColoredCoinSnapshot(const std::shared_ptr<ColoredCoinSnapshot> &snapshot);
 std::string serializeColoredCoinZcSnapshot(const std::shared_ptr<ColoredCoinZCSnapshot> &snapshot);
@@ -25,4 +31,62 @@ std::string serializeColoredCoinZcSnapshot(const std::shared_ptr<ColoredCoinZCSn
 std::shared_ptr<ColoredCoinSnapshot> deserializeColoredCoinSnapshot(const std::string &data);
 std::shared_ptr<ColoredCoinZCSnapshot> deserializeColoredCoinZcSnapshot(const std::string &data);
 
+// Tracker state checkpoints stored in LMDB as an append-only list of records.
+// First record holds a full snapshot, next ones only the difference from the
+// previous checkpoint, so storing a checkpoint per block costs O(changes).
+// Records are compacted into a single full one when deltas outgrow it or
+// the snapshot ids were rebuilt (see CcUtxoStore::compact()).
+// Records are read straight from the memory-mapped DB on load.
+// Each record carries the hash of its last included block and the instrument
+// parameters, so the caller can verify them before resuming (see State).
+class ColoredCoinCheckpoints
+{
+public:
+   struct State
+   {
+      std::shared_ptr<ColoredCoinSnapshot> snapshot;
+      unsigned startHeight{};       // first block height not in the snapshot
+      unsigned processedHeight{};
+      BinaryData blockHash;         // hash of block at startHeight - 1
+
+      // instrument the snapshot belongs to
+      std::set<BinaryData> originAddresses;
+      uint64_t coinsPerShare{};
+   };
+
+   ColoredCoinCheckpoints(const std::string &filename);
+   ~ColoredCoinCheckpoints();
+
+   ColoredCoinCheckpoints(const ColoredCoinCheckpoints&) = delete;
+   ColoredCoinCheckpoints& operator = (const ColoredCoinCheckpoints&) = delete;
+
+   // Replays all records. Returns null snapshot if there are none or in case
+   // of errors, then the caller should scan from scratch. Block hash and
+   // instrument should be checked by the caller, reset() if they don't match.
+   State load();
+
+   // Snapshot should not be modified after that (new versions are derived
+   // from it by copying), it's kept as base for the next delta.
+   bool append(const State &);
+
+   // Drops all records, e.g. after reorg
+   void reset();
+
+private:
+   bool write(const BinaryData &record, bool full);
+   void eraseAll();
+
+private:
+   std::shared_ptr<LMDBEnv>   dbEnv_;
+   std::unique_ptr<LMDB>      db_;
+   std::mutex  mutex_;
+
+   State       last_;            // base for the next delta record
+   uint32_t    nextSeq_{};
+   uint32_t    lastFullSeq_{};
+   size_t      fullSize_{};      // size of the last full record
+   size_t      deltaSize_{};     // size of delta records after it
+   size_t      mapSize_{};
+};
+
 #endif
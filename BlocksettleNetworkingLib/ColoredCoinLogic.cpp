@@ -10,6 +10,12 @@
 */
 #include "ColoredCoinLogic.h"
 
+#include <future>
+#include <mutex>
+
+#include "ColoredCoinCache.h"
+#include "Executor.h"
+
 /***
 
 #1: Add CC origin address
@@ -88,11 +94,10 @@ Parsing CC tx:
 
 namespace  {
 
-   bool opExists(const CcUtxoSet &utxoSet
+   bool opExists(const CcUtxoStore &utxoSet
       , const BinaryData &txHash, uint32_t txOutIndex, bool strict = true)
    {
-      auto hashIter = utxoSet.find(txHash);
-      if (hashIter == utxoSet.end()) {
+      if (!utxoSet.hasTx(txHash)) {
          return false;
       }
       if (txOutIndex == UINT32_MAX) {
@@ -102,12 +107,357 @@ namespace  {
 
          return true;
       }
-      auto idIter = hashIter->second.find(txOutIndex);
-      if (idIter == hashIter->second.end()) {
+      return (utxoSet.find(txHash, txOutIndex) != nullptr);
+   };
+
+   bool isSpentByZc(const std::shared_ptr<ColoredCoinZCSnapshot>& zcPtr
+      , const BinaryData& txHash, unsigned txOutIndex)
+   {
+      auto zcSpentIter = zcPtr->spentOutputs_.find(txHash);
+      if (zcSpentIter == zcPtr->spentOutputs_.end()) {
          return false;
       }
-      return true;
+      return (zcSpentIter->second.find(txOutIndex) != zcSpentIter->second.end());
+   }
+
+   using Clock = std::chrono::steady_clock;
+
+   std::chrono::microseconds elapsed(const Clock::time_point &since)
+   {
+      return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since);
+   }
+
+   //header callback is not invoked on Armory errors, don't wait forever
+   const auto kHeaderTimeout = std::chrono::seconds(30);
+   const size_t kHeaderSize = 80;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CcTxData::CcTxData(const Tx& tx) :
+   height_(tx.getTxHeight()), isSegWit_(tx.isSegWit())
+{
+   txHash_ = tx.getThisHash();
+   if (!isSegWit_) {
+      return;
+   }
+
+   inputs_.reserve(tx.getNumTxIn());
+   for (unsigned i = 0; i < tx.getNumTxIn(); i++) {
+      auto&& input = tx.getTxInCopy(i);
+      auto&& outpoint = input.getOutPoint();
+      inputs_.emplace_back(outpoint.getTxHash(), outpoint.getTxOutIndex());
+   }
+
+   outputs_.reserve(tx.getNumTxOut());
+   for (size_t i = 0; i < tx.getNumTxOut(); ++i) {
+      auto&& output = tx.getTxOutCopy(i);
+      outputs_.push_back({ output.getValue(),
+         BtcUtils::getTxOutScriptType(output.getScriptRef()) == TXOUT_SCRIPT_P2WPKH,
+         output.getScrAddressStr() });
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*
+Feeds txs to the settlement walk in ColoredCoinTracker::update().
+
+Without an executor, txs are fetched when a batch is requested and decoded
+in the DB callback. Spentness of new CC outputs is requested once the whole
+batch is applied, which matches the sequential walk.
+
+With an executor (pipelined mode):
+   - fetched txs are decoded in parallel on executor threads,
+   - spentness is requested for every kSpentnessChunk new CC outputs while
+     the rest of the batch is still being applied,
+   - spender txs from each spentness reply are prefetched right away, so
+     the next batch is mostly fetched and decoded by the time it's needed.
+
+Applying txs stays sequential: each tx depends on the snapshot state left
+by the previous ones.
+*/
+class CcTxPipeline
+{
+public:
+   struct FetchedTx
+   {
+      explicit FetchedTx(const Tx& tx) :
+         tx_(tx), data_(tx)
+      {}
+
+      Tx tx_;
+      const CcTxData data_;
+   };
+   using FetchedTxPtr = std::shared_ptr<FetchedTx>;
+
+   CcTxPipeline(const std::shared_ptr<ArmoryConnection>& connPtr,
+      const std::shared_ptr<bs::Executor>& executor) :
+      state_(std::make_shared<State>(connPtr, executor))
+   {}
+
+   //txs for given hashes in processing order, missing txs are skipped
+   std::vector<FetchedTxPtr> get(const std::set<BinaryData>&);
+
+   //drops a processed tx
+   void release(const BinaryData& txHash);
+
+   //tracks spender of a new CC output
+   void addSpentness(const BinaryData& txHash, unsigned txOutIndex);
+
+   //spender hashes of all outputs added since the last call
+   std::set<BinaryData> collectSpenders(void);
+
+   ColoredCoinTracker::UpdateTimings timings(void) const;
+
+private:
+   //shared with DB callbacks and executor tasks
+   struct State
+   {
+      State(const std::shared_ptr<ArmoryConnection>& connPtr,
+         const std::shared_ptr<bs::Executor>& executor) :
+         connPtr_(connPtr), executor_(executor)
+      {}
+
+      const std::shared_ptr<ArmoryConnection> connPtr_;
+      const std::shared_ptr<bs::Executor> executor_;
+
+      std::mutex mutex_;
+      std::map<BinaryData, std::shared_future<FetchedTxPtr>> txs_;
+
+      std::atomic<int64_t> decodeUs_{ 0 };
+   };
+   using Promises = std::map<BinaryData, std::promise<FetchedTxPtr>>;
+
+   static void fetch(const std::shared_ptr<State>&, const std::set<BinaryData>&);
+   static void decode(const std::shared_ptr<State>&,
+      const std::shared_ptr<Promises>&, const AsyncClient::TxBatchResult&);
+
+   void flushSpentness(void);
+
+private:
+   //enough to keep a few requests in flight during a big batch
+   static constexpr size_t kSpentnessChunk = 512;
+   static constexpr size_t kDecodeChunk = 64;
+
+   std::shared_ptr<State> state_;
+
+   std::map<BinaryData, std::set<unsigned>> spentnessToTrack_;
+   size_t spentnessOutputs_ = 0;
+   std::vector<std::future<std::set<BinaryData>>> spentness_;
+
+   ColoredCoinTracker::UpdateTimings timings_;
+};
+
+////
+void CcTxPipeline::fetch(const std::shared_ptr<State>& state,
+   const std::set<BinaryData>& hashes)
+{
+   //only request txs that are neither fetched nor in flight
+   auto promises = std::make_shared<Promises>();
+   std::set<BinaryData> toFetch;
+   {
+      std::lock_guard<std::mutex> lock(state->mutex_);
+      for (const auto& hash : hashes) {
+         if (state->txs_.find(hash) != state->txs_.end()) {
+            continue;
+         }
+         auto& prom = (*promises)[hash];
+         state->txs_.emplace(hash, prom.get_future().share());
+         toFetch.insert(hash);
+      }
+   }
+   if (toFetch.empty()) {
+      return;
+   }
+
+   auto txLbd = [state, promises]
+      (const AsyncClient::TxBatchResult &batch, std::exception_ptr exPtr)
+   {
+      if (exPtr != nullptr) {
+         for (auto& prom : *promises) {
+            prom.second.set_exception(exPtr);
+         }
+         return;
+      }
+      decode(state, promises, batch);
    };
+   if (!state->connPtr_->getTXsByHash(toFetch, txLbd, false)) {
+      const auto exPtr = std::make_exception_ptr(
+         ColoredCoinException("invalid DB state/connection"));
+      for (auto& prom : *promises) {
+         prom.second.set_exception(exPtr);
+      }
+   }
+}
+
+////
+void CcTxPipeline::decode(const std::shared_ptr<State>& state,
+   const std::shared_ptr<Promises>& promises,
+   const AsyncClient::TxBatchResult& batch)
+{
+   std::map<BinaryData, std::shared_ptr<const Tx>> txMap;
+   for (const auto& tx : batch) {
+      txMap[tx.first] = tx.second;
+   }
+
+   using Item = std::pair<std::shared_ptr<const Tx>, std::promise<FetchedTxPtr>*>;
+   auto items = std::make_shared<std::vector<Item>>();
+   items->reserve(promises->size());
+   for (auto& prom : *promises) {
+      const auto txIter = txMap.find(prom.first);
+      items->emplace_back(
+         (txIter != txMap.end()) ? txIter->second : nullptr, &prom.second);
+   }
+
+   //tasks own the promises, if executor drops them waiters get broken_promise
+   auto decodeRange = [state, promises, items](size_t begin, size_t end)
+   {
+      const auto start = Clock::now();
+      for (size_t i = begin; i < end; i++) {
+         auto& item = (*items)[i];
+         if (item.first == nullptr) {
+            item.second->set_value(nullptr);
+            continue;
+         }
+         try {
+            item.second->set_value(std::make_shared<FetchedTx>(*item.first));
+         }
+         catch (...) {
+            item.second->set_exception(std::current_exception());
+         }
+      }
+      state->decodeUs_ += elapsed(start).count();
+   };
+
+   if (state->executor_ == nullptr) {
+      decodeRange(0, items->size());
+      return;
+   }
+   for (size_t begin = 0; begin < items->size(); begin += kDecodeChunk) {
+      const auto end = std::min(begin + kDecodeChunk, items->size());
+      state->executor_->post([decodeRange, begin, end] {
+         decodeRange(begin, end);
+      });
+   }
+}
+
+////
+std::vector<CcTxPipeline::FetchedTxPtr> CcTxPipeline::get(
+   const std::set<BinaryData>& hashes)
+{
+   fetch(state_, hashes);
+
+   std::vector<std::shared_future<FetchedTxPtr>> futures;
+   futures.reserve(hashes.size());
+   {
+      std::lock_guard<std::mutex> lock(state_->mutex_);
+      for (const auto& hash : hashes) {
+         futures.push_back(state_->txs_.at(hash));
+      }
+   }
+
+   const auto start = Clock::now();
+   std::vector<FetchedTxPtr> result;
+   result.reserve(futures.size());
+   for (const auto& fut : futures) {
+      auto txPtr = fut.get();
+      if (txPtr != nullptr) {
+         result.emplace_back(std::move(txPtr));
+      }
+   }
+   timings_.fetchWait_ += elapsed(start);
+
+   std::sort(result.begin(), result.end(),
+      [](const FetchedTxPtr& lhs, const FetchedTxPtr& rhs)->bool
+   {
+      return TxComparator()(lhs->tx_, rhs->tx_);
+   });
+   timings_.txCount_ += result.size();
+   return result;
+}
+
+////
+void CcTxPipeline::release(const BinaryData& txHash)
+{
+   std::lock_guard<std::mutex> lock(state_->mutex_);
+   state_->txs_.erase(txHash);
+}
+
+////
+void CcTxPipeline::addSpentness(const BinaryData& txHash, unsigned txOutIndex)
+{
+   spentnessToTrack_[txHash].insert(txOutIndex);
+   if ((state_->executor_ != nullptr) && (++spentnessOutputs_ >= kSpentnessChunk)) {
+      flushSpentness();
+   }
+}
+
+////
+void CcTxPipeline::flushSpentness()
+{
+   if (spentnessToTrack_.empty()) {
+      return;
+   }
+   auto toTrack = std::move(spentnessToTrack_);
+   spentnessToTrack_.clear();
+   spentnessOutputs_ = 0;
+
+   auto spentnessProm = std::make_shared<std::promise<std::set<BinaryData>>>();
+   auto state = state_;
+   auto spentnessLbd = [spentnessProm, state]
+      (const std::map<BinaryData, std::map<unsigned int, SpentnessResult>> &batch
+         , std::exception_ptr exPtr)
+   {
+      if (exPtr != nullptr) {
+         spentnessProm->set_exception(exPtr);
+         return;
+      }
+
+      //aggregate spender hashes
+      std::set<BinaryData> spenderHashes;
+      for (auto& spentness : batch) {
+         for (auto& hashPair : spentness.second) {
+            if (hashPair.second.spender_.getSize() == 32) {
+               spenderHashes.insert(hashPair.second.spender_);
+            }
+         }
+      }
+
+      //spenders make the next batch, start fetching them now
+      if (state->executor_ != nullptr) {
+         fetch(state, spenderHashes);
+      }
+      spentnessProm->set_value(std::move(spenderHashes));
+   };
+
+   auto spentnessFut = spentnessProm->get_future();
+   if (!state_->connPtr_->getSpentnessForOutputs(toTrack, spentnessLbd)) {
+      throw ColoredCoinException("invalid DB state/connection");
+   }
+   spentness_.emplace_back(std::move(spentnessFut));
+}
+
+////
+std::set<BinaryData> CcTxPipeline::collectSpenders()
+{
+   flushSpentness();
+
+   const auto start = Clock::now();
+   std::set<BinaryData> result;
+   for (auto& fut : spentness_) {
+      const auto spenderHashes = fut.get();
+      result.insert(spenderHashes.cbegin(), spenderHashes.cend());
+   }
+   spentness_.clear();
+   timings_.spentnessWait_ += elapsed(start);
+   return result;
+}
+
+////
+ColoredCoinTracker::UpdateTimings CcTxPipeline::timings() const
+{
+   auto result = timings_;
+   result.decode_ = std::chrono::microseconds(state_->decodeUs_.load());
+   return result;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -176,23 +526,19 @@ void ColoredCoinTracker::setReadyCb(ColoredCoinTrackerInterface::SnapshotUpdated
    readyCb_ = std::move(cb);
 }
 
-////
-const std::shared_ptr<BinaryData> ColoredCoinTracker::getScrAddrPtr(
-   const std::map<BinaryData, OpPtrSet>& addrMap
-   , const BinaryData& scrAddr) const
+void ColoredCoinTracker::setPipelineExecutor(const std::shared_ptr<bs::Executor>& executor)
 {
-   auto scrAddrIter = addrMap.find(scrAddr.getRef());
-   if (scrAddrIter == addrMap.end()) {
-      return nullptr;
-   }
-   if (scrAddrIter->second.size() == 0) {
-      return nullptr;
-   }
-   auto& obj = *scrAddrIter->second.begin();
-   if (obj == nullptr) {
-      return nullptr;
-   }
-   return obj->getScrAddr();
+   executor_ = executor;
+}
+
+void ColoredCoinTracker::setUpdateTimingsCb(UpdateTimingsCb cb)
+{
+   updateTimingsCb_ = std::move(cb);
+}
+
+void ColoredCoinTracker::setCheckpoints(const std::shared_ptr<ColoredCoinCheckpoints>& checkpoints)
+{
+   checkpoints_ = checkpoints;
 }
 
 ////
@@ -207,47 +553,27 @@ uint64_t ColoredCoinTracker::getCcOutputValue(
       UINT64_MAX if it was revoked.
    */
 
-   auto getOpPtr = [&ssPtr, &hash, &txOutIndex](void)->
-      std::shared_ptr<CcOutpoint>
-   {
-      if (ssPtr == nullptr) {
-         return nullptr;
-      }
-      auto hashIter = ssPtr->utxoSet_.find(hash);
-      if (hashIter == ssPtr->utxoSet_.end()) {
-         return nullptr;
-      }
-      auto idIter = hashIter->second.find(txOutIndex);
-      if (idIter == hashIter->second.end()) {
-         return nullptr;
-      }
-      return idIter->second;
-   };
-
    //try to grab the cc output
-   auto ccPtr = getOpPtr();
+   const CcOutput* ccPtr = nullptr;
+   if (ssPtr != nullptr) {
+      ccPtr = ssPtr->utxoSet_.find(hash, txOutIndex);
+   }
 
    if (ccPtr != nullptr) {
       //check this cc addr isnt revoked
-      if (ssPtr != nullptr) {
-         auto revokedIter = ssPtr->revokedAddresses_.find(*ccPtr->getScrAddr());
-         if (revokedIter != ssPtr->revokedAddresses_.end() &&
-            height > revokedIter->second) {
-            return UINT64_MAX;
-         }
+      auto revokedIter = ssPtr->revokedAddresses_.find(
+         ssPtr->utxoSet_.scrAddr(*ccPtr));
+      if (revokedIter != ssPtr->revokedAddresses_.end() &&
+         height > revokedIter->second) {
+         return UINT64_MAX;
       }
 
       //check the cc isn't spent by a zc
       if (zcPtr == nullptr) {
-         return ccPtr->value();
-      }
-      auto spentIter = zcPtr->spentOutputs_.find(hash);
-      if (spentIter == zcPtr->spentOutputs_.end()) {
-         return ccPtr->value();
+         return ccPtr->value_;
       }
-      auto indexIter = spentIter->second.find(txOutIndex);
-      if (indexIter == spentIter->second.end()) {
-         return ccPtr->value();
+      if (!isSpentByZc(zcPtr, hash, txOutIndex)) {
+         return ccPtr->value_;
       }
       return 0;
    }
@@ -256,15 +582,11 @@ uint64_t ColoredCoinTracker::getCcOutputValue(
    if (zcPtr == nullptr) {
       return 0;
    }
-   auto spentIter = zcPtr->utxoSet_.find(hash);
-   if (spentIter == zcPtr->utxoSet_.end()) {
+   auto zcOutput = zcPtr->utxoSet_.find(hash, txOutIndex);
+   if (zcOutput == nullptr) {
       return 0;
    }
-   auto indexIter = spentIter->second.find(txOutIndex);
-   if (indexIter == spentIter->second.end()) {
-      return 0;
-   }
-   return indexIter->second->value();
+   return zcOutput->value_;
 }
 
 ////
@@ -306,6 +628,15 @@ ParsedCcTx ColoredCoinTracker::processTx(
    const std::shared_ptr<ColoredCoinSnapshot> &ssPtr
    , const std::shared_ptr<ColoredCoinZCSnapshot>& zcPtr
    , const Tx& tx) const
+{
+   return processTx(ssPtr, zcPtr, CcTxData(tx));
+}
+
+////
+ParsedCcTx ColoredCoinTracker::processTx(
+   const std::shared_ptr<ColoredCoinSnapshot> &ssPtr
+   , const std::shared_ptr<ColoredCoinZCSnapshot>& zcPtr
+   , const CcTxData& tx) const
 {
    /*
    Core CC logic, modify with utmost care
@@ -313,26 +644,22 @@ ParsedCcTx ColoredCoinTracker::processTx(
 
    ParsedCcTx result;
 
-   if (!tx.isSegWit())
+   if (!tx.isSegWit_)
       return result;
 
    //how many inputs are CC
    uint64_t ccValue = 0;
-   for (unsigned i = 0; i < tx.getNumTxIn(); i++) {
-      auto&& input = tx.getTxInCopy(i); //TODO: work on refs instead of copies
-      auto&& outpoint = input.getOutPoint();
-
+   for (const auto& outpoint : tx.inputs_) {
       auto val = getCcOutputValue(
          ssPtr, zcPtr,
-         outpoint.getTxHash(), outpoint.getTxOutIndex(),
-         tx.getTxHeight());
+         outpoint.first, outpoint.second,
+         tx.height_);
 
       if (val == UINT64_MAX || val == 0) {
          continue;
       }
       //keep track of CC outpoints
-      result.outpoints_.push_back(
-         std::make_pair(outpoint.getTxHash(), outpoint.getTxOutIndex()));
+      result.outpoints_.push_back(outpoint);
 
       //tally CC value
       ccValue += val;
@@ -345,9 +672,8 @@ ParsedCcTx ColoredCoinTracker::processTx(
 
    //this tx consumes CC outputs, let's check the new outputs
    uint64_t outputValue = 0;
-   for (size_t i = 0; i < tx.getNumTxOut(); ++i) {
-      auto&& output = tx.getTxOutCopy(i); //TODO: work on refs instead of copies
-      auto&& val = output.getValue();
+   for (const auto& output : tx.outputs_) {
+      const auto val = output.value_;
 
       //is the value a multiple of the CC coins per share?
       if (val % coinsPerShare_ != 0) {
@@ -362,8 +688,7 @@ ParsedCcTx ColoredCoinTracker::processTx(
          break;
       }
       //is the output P2WPKH?
-      if (BtcUtils::getTxOutScriptType(output.getScriptRef()) != 
-         TXOUT_SCRIPT_P2WPKH) {
+      if (!output.isP2WPKH_) {
          break;
       }
 
@@ -371,7 +696,7 @@ ParsedCcTx ColoredCoinTracker::processTx(
       outputValue += val;
 
       //add to the result's list of CC outputs
-      result.outputs_.push_back(std::make_pair(val, output.getScrAddressStr()));
+      result.outputs_.push_back(std::make_pair(val, output.scrAddr_));
    }
 
    /*
@@ -385,7 +710,7 @@ ParsedCcTx ColoredCoinTracker::processTx(
    }
    //we got this far, this is a good CC tx, set the txhash in the result
    //struct to flag it as valid and return
-   result.txHash_ = tx.getThisHash();
+   result.txHash_ = tx.txHash_;
    return result;
 }
 
@@ -426,15 +751,15 @@ std::vector<Tx> ColoredCoinTracker::grabTxBatch(
 ////
 std::set<BinaryData> ColoredCoinTracker::processTxBatch(
    std::shared_ptr<ColoredCoinSnapshot>& ssPtr,
-   const std::set<BinaryData>& hashes, bool parseFirst)
+   const std::set<BinaryData>& hashes, bool parseFirst,
+   CcTxPipeline& pipeline)
 {
    std::set<BinaryData> spenderHashes;
 
    //grab listed tx
-   auto&& txBatch = grabTxBatch(hashes);
+   auto&& txBatch = pipeline.get(hashes);
 
    std::shared_ptr<ColoredCoinZCSnapshot> zcPtr = nullptr;
-   std::map<BinaryData, std::set<unsigned>> spentnessToTrack;
 
    uint32_t newProcessedHeight = UINT32_MAX;
 
@@ -442,7 +767,7 @@ std::set<BinaryData> ColoredCoinTracker::processTxBatch(
    auto txIter = txBatch.begin();
    while (txIter != txBatch.end()) {
       //check outpoints are covered by the processed height
-      auto& tx = *txIter;
+      auto& tx = (*txIter)->tx_;
       bool skip = false;
 
       for (auto& opId : tx.getOpIdVec())
@@ -466,7 +791,7 @@ std::set<BinaryData> ColoredCoinTracker::processTxBatch(
          */
          while (txIter != txBatch.end())
          {
-            spenderHashes.insert(txIter->getThisHash());
+            spenderHashes.insert((*txIter)->tx_.getThisHash());
             ++txIter;
          }
          break;
@@ -475,25 +800,18 @@ std::set<BinaryData> ColoredCoinTracker::processTxBatch(
       parseFirst = false;
 
       //parse the tx
-      auto&& parsedTx = processTx(ssPtr, zcPtr, tx);
+      auto&& parsedTx = processTx(ssPtr, zcPtr, (*txIter)->data_);
+      pipeline.release((*txIter)->data_.txHash_);
 
       //purge utxo set of all spent CC outputs
       for (auto& input : parsedTx.outpoints_) {
-         auto hashIter = ssPtr->utxoSet_.find(input.first);
-         if (hashIter == ssPtr->utxoSet_.end()) {
+         if (!ssPtr->utxoSet_.hasTx(input.first)) {
             throw ColoredCoinException("missing outpoint hash");
          }
-         auto idIter = hashIter->second.find(input.second);
-         if (idIter == hashIter->second.end()) {
-            throw ColoredCoinException("missing outpoint index");
-         }
-         //remove from scrAddr to utxo map
-         eraseScrAddrOp(ssPtr, idIter->second);
 
-         //remove from utxo set
-         hashIter->second.erase(idIter);
-         if (hashIter->second.size() == 0) {
-            ssPtr->utxoSet_.erase(hashIter);
+         //remove from utxo set and scrAddr to utxo map
+         if (!ssPtr->utxoSet_.erase(input.first, input.second)) {
+            throw ColoredCoinException("missing outpoint index");
          }
       }
 
@@ -501,16 +819,13 @@ std::set<BinaryData> ColoredCoinTracker::processTxBatch(
          //This tx creates valid CC utxos, add them to the map and 
          //track the spender hashes if any
 
-         auto spentnessIter = spentnessToTrack.insert(
-            std::make_pair(parsedTx.txHash_, std::set<unsigned>())).first;
-
          for (unsigned i = 0; i < parsedTx.outputs_.size(); i++) {
             //add the utxo
             auto& output = parsedTx.outputs_[i];
             addUtxo(ssPtr, parsedTx.txHash_, i, output.first, output.second);
 
             //add the index to the spentness fetch packet
-            spentnessIter->second.insert(i);
+            pipeline.addSpentness(parsedTx.txHash_, i);
          }
       }
 
@@ -527,35 +842,9 @@ std::set<BinaryData> ColoredCoinTracker::processTxBatch(
       processedHeight_ = newProcessedHeight;
    }
 
-   //check new utxo list
-   auto spentnessProm = std::make_shared<
-      std::promise<std::map<BinaryData, std::map<unsigned int, SpentnessResult>>>>();
-   auto spentnessFut = spentnessProm->get_future();
-   auto spentnessLbd = [spentnessProm]
-      (const std::map<BinaryData, std::map<unsigned int, SpentnessResult>> &batch
-         , std::exception_ptr exPtr)
-   {
-      if (exPtr != nullptr) {
-         spentnessProm->set_exception(exPtr);
-      }
-      else {
-         spentnessProm->set_value(batch);
-      }
-   };
-   if (!connPtr_->getSpentnessForOutputs(spentnessToTrack, spentnessLbd)) {
-      throw ColoredCoinException("invalid DB state/connection");
-   }
-   auto&& spentnessBatch = spentnessFut.get();
-
-   //aggregate spender hashes
-   for (auto& spentness : spentnessBatch) {
-      auto& spentnessMap = spentness.second;
-      for (auto& hashPair : spentnessMap) {
-         if (hashPair.second.spender_.getSize() == 32) {
-            spenderHashes.insert(hashPair.second.spender_);
-         }
-      }
-   }
+   //check new utxo list, aggregate spender hashes
+   auto&& newSpenders = pipeline.collectSpenders();
+   spenderHashes.insert(newSpenders.begin(), newSpenders.end());
    return spenderHashes;
 }
 
@@ -611,40 +900,21 @@ std::set<BinaryData> ColoredCoinTracker::processZcBatch(
       
       //purge utxo set of all spent CC outputs
       for (auto& input : parsedTx.outpoints_) {
-         auto hashIter = ssPtr->utxoSet_.find(input.first);
-         if (hashIter != ssPtr->utxoSet_.end()) {
-            auto idIter = hashIter->second.find(input.second);
-            if (idIter != hashIter->second.end()) {
-               //spent confirmed output, mark it in zc snapshot
-               auto spentIter = zcPtr->spentOutputs_.find(input.first);
-               if (spentIter == zcPtr->spentOutputs_.end()) {
-                  spentIter = zcPtr->spentOutputs_.insert(
-                     std::make_pair(input.first, std::set<unsigned>())).first;
-               }
-
-               spentIter->second.insert(input.second);
-               continue;
-            }
+         if (ssPtr->utxoSet_.find(input.first, input.second) != nullptr) {
+            //spent confirmed output, mark it in zc snapshot
+            zcPtr->spentOutputs_[input.first].insert(input.second);
+            continue;
          }
 
          //not a confirmed output, remove from zc utxo set instead
-         auto zcHashIter = zcPtr->utxoSet_.find(input.first);
-         if (zcHashIter == zcPtr->utxoSet_.end()) {
+         if (!zcPtr->utxoSet_.hasTx(input.first)) {
             continue;
          }
 
-         zcHashIter->second.erase(input.second);
-         if (zcHashIter->second.size() == 0)
-            zcPtr->utxoSet_.erase(zcHashIter);
+         zcPtr->utxoSet_.erase(input.first, input.second);
 
          //add to spent outputs as well
-         auto zcSpentIter = zcPtr->spentOutputs_.find(input.first);
-         if (zcSpentIter == zcPtr->spentOutputs_.end()) {
-            zcSpentIter = zcPtr->spentOutputs_.insert(
-               std::make_pair(input.first, std::set<unsigned>())).first;
-         }
-
-         zcSpentIter->second.insert(input.second);
+         zcPtr->spentOutputs_[input.first].insert(input.second);
       }
 
       if (parsedTx.hasOutputs()) {
@@ -657,7 +927,7 @@ std::set<BinaryData> ColoredCoinTracker::processZcBatch(
          for (unsigned i = 0; i < parsedTx.outputs_.size(); i++) {
             //add the utxo
             auto& output = parsedTx.outputs_[i];
-            addZcUtxo(ssPtr, zcPtr, parsedTx.txHash_, i, output.first, output.second);
+            addZcUtxo(zcPtr, parsedTx.txHash_, i, output.first, output.second);
 
             insertIter->second.insert(i);
          }
@@ -740,7 +1010,7 @@ void ColoredCoinTracker::processRevocationBatch(
          if (iter != revocationAddresses_.end()) {
             continue;
          }
-         ssPtr->revokedAddresses_.insert(std::make_pair(scrAddr, tx.second->getTxHeight()));
+         ssPtr->revokedAddresses_.emplace(scrAddr, tx.second->getTxHeight());
       }
    }
 }
@@ -766,6 +1036,8 @@ std::set<BinaryData> ColoredCoinTracker::collectRevokeAddresses() const
 ////
 std::set<BinaryData> ColoredCoinTracker::update()
 {
+   const auto updateStart = Clock::now();
+
    //create new snapshot
    auto ssPtr = std::make_shared<ColoredCoinSnapshot>();
 
@@ -775,6 +1047,9 @@ std::set<BinaryData> ColoredCoinTracker::update()
       update it. We do not need the current snapshot past that point
       and the new one is meant to replace it once it's ready. Therefor
       we will perform the copy in a dedicated scope.
+
+      The copy shares all containers' nodes with the current snapshot,
+      only the parts modified below are cloned.
       */
       auto currentSs = snapshot();
       if (currentSs != nullptr) {
@@ -788,9 +1063,9 @@ std::set<BinaryData> ColoredCoinTracker::update()
    addrSet.insert(revokeAddrs.cbegin(), revokeAddrs.cend());
 
    //current set of live user addresses
-   for (auto& addrRef : ssPtr->scrAddrCcSet_) {
-      addrSet.insert(addrRef.first);
-   }
+   ssPtr->utxoSet_.forEachAddress([&addrSet](const BinaryDataRef& scrAddr) {
+      addrSet.insert(BinaryData(scrAddr));
+   });
 
    auto promPtr = std::make_shared<std::promise<OutpointBatch>>();
    auto fut = promPtr->get_future();
@@ -870,12 +1145,7 @@ std::set<BinaryData> ColoredCoinTracker::update()
             }
             
             //or was it a valid CC?
-            auto hashIter = ssPtr->utxoSet_.find(op.txHash_);
-            if (hashIter == ssPtr->utxoSet_.end()) {
-               continue;
-            }
-            auto idIter = hashIter->second.find(op.txOutIndex_);
-            if (idIter == hashIter->second.end()) {
+            if (ssPtr->utxoSet_.find(op.txHash_, op.txOutIndex_) == nullptr) {
                continue;
             }
             //mark the spender for CC settlement
@@ -888,6 +1158,9 @@ std::set<BinaryData> ColoredCoinTracker::update()
    processRevocationBatch(ssPtr, revokesToCheck);
 
    //process settlements
+   CcTxPipeline pipeline(connPtr_, executor_);
+   unsigned rounds = 0;
+   const auto settleStart = Clock::now();
    bool parseLowest = false;
    while (true) {
       if (hashesToCheck.empty()) {
@@ -895,8 +1168,9 @@ std::set<BinaryData> ColoredCoinTracker::update()
       }
 
       //run through the batch of transactions
-      auto&& newHashSet = processTxBatch(ssPtr, hashesToCheck, parseLowest);
+      auto&& newHashSet = processTxBatch(ssPtr, hashesToCheck, parseLowest, pipeline);
       parseLowest = false;
+      ++rounds;
    
       //currate the left overs
       bool allIncluded = true;
@@ -920,25 +1194,49 @@ std::set<BinaryData> ColoredCoinTracker::update()
 
       hashesToCheck = std::move(newHashSet);
    }
+   auto timings = pipeline.timings();
+   timings.apply_ = elapsed(settleStart) - timings.fetchWait_ - timings.spentnessWait_;
+   timings.rounds_ = rounds;
 
    //update cutoff
    startHeight_ = outpointData.heightCutoff_ + 1;
 
    //track new addresses
    std::set<BinaryData> toReg;
-   for (auto& addr : ssPtr->scrAddrCcSet_) {
-      if (addrSet.find(addr.first) == addrSet.end()) {
-         toReg.insert(addr.first);
+   ssPtr->utxoSet_.forEachAddress([&addrSet, &toReg](const BinaryDataRef& scrAddr) {
+      BinaryData addr(scrAddr);
+      if (addrSet.find(addr) == addrSet.end()) {
+         toReg.insert(std::move(addr));
       }
+   });
+
+   //drop ids of spent outputs, the next checkpoint record is a full one
+   if (ssPtr->utxoSet_.needsCompaction()) {
+      ssPtr->utxoSet_.compact();
    }
 
    //swap new snapshot in
    std::atomic_store_explicit(&snapshot_, ssPtr, std::memory_order_release);
    snapshotUpdated();
 
+   //ssPtr is not modified past this point, it's the base for the next delta
+   if (checkpoints_ != nullptr) {
+      //hash is stored to detect reorgs that happened while offline
+      auto blockHash = getBlockHash(startHeight_ - 1);
+      if (!blockHash.empty()) {
+         checkpoints_->append({ ssPtr, startHeight_, processedHeight_
+            , std::move(blockHash), originAddresses_, coinsPerShare_ });
+      }
+   }
+
    //purge zc container
    purgeZc();
 
+   if (updateTimingsCb_) {
+      timings.total_ = elapsed(updateStart);
+      updateTimingsCb_(timings);
+   }
+
    //register new addresses
    return toReg;
 }
@@ -961,14 +1259,14 @@ std::set<BinaryData> ColoredCoinTracker::zcUpdate()
    auto &&addrSet = collectOriginAddresses();
 
    //current set of live user addresses
+   const auto addAddress = [&addrSet](const BinaryDataRef& scrAddr) {
+      addrSet.insert(BinaryData(scrAddr));
+   };
    if (currentSs != nullptr) {
-      for (auto& addrRef : currentSs->scrAddrCcSet_)
-         addrSet.insert(addrRef.first);
+      currentSs->utxoSet_.forEachAddress(addAddress);
    }
+   ssPtr->utxoSet_.forEachAddress(addAddress);
 
-   for (auto& addrRef : ssPtr->scrAddrCcSet_) {
-      addrSet.insert(addrRef.first);
-   }
    //note: we dont deal with unconfirmed revocations
    auto promPtr = std::make_shared<std::promise<OutpointBatch>>();
    auto fut = promPtr->get_future();
@@ -1000,7 +1298,7 @@ std::set<BinaryData> ColoredCoinTracker::zcUpdate()
          continue;
       }
       for (auto& op : iter->second) {
-         addZcUtxo(currentSs, ssPtr, op.txHash_, op.txOutIndex_, op.value_, scrAddr);
+         addZcUtxo(ssPtr, op.txHash_, op.txOutIndex_, op.value_, scrAddr);
       }
    }
 
@@ -1058,11 +1356,12 @@ std::set<BinaryData> ColoredCoinTracker::zcUpdate()
 
    //track new addresses
    std::set<BinaryData> toReg;
-   for (auto& addr : ssPtr->scrAddrCcSet_) {
-      if (addrSet.find(addr.first) == addrSet.end()) {
-         toReg.insert(addr.first);
+   ssPtr->utxoSet_.forEachAddress([&addrSet, &toReg](const BinaryDataRef& scrAddr) {
+      BinaryData addr(scrAddr);
+      if (addrSet.find(addr) == addrSet.end()) {
+         toReg.insert(std::move(addr));
       }
-   }
+   });
 
    //swap the new snapshot in
    std::atomic_store_explicit(&zcSnapshot_, ssPtr, std::memory_order_release);
@@ -1086,8 +1385,11 @@ void ColoredCoinTracker::purgeZc()
       if (currentZcSs == nullptr)
          return;
 
-      for (auto& hashPair : currentZcSs->utxoSet_)
-         txHashes.insert(hashPair.first);
+      currentZcSs->utxoSet_.forEachTx([&txHashes]
+         (const BinaryDataRef& txHash, const CcUtxoStore::Outputs&)
+      {
+         txHashes.insert(BinaryData(txHash));
+      });
    }
 
    auto promPtr = std::make_shared<std::promise<AsyncClient::TxBatchResult>>();
@@ -1127,8 +1429,7 @@ void ColoredCoinTracker::purgeZc()
          if (originAddresses_.find(scrAddr) == originAddresses_.end()) {
             continue;
          }
-         addZcUtxo(currentSs, zcPtr, 
-            tx.first, i, txOut.getValue(), scrAddr);
+         addZcUtxo(zcPtr, tx.first, i, txOut.getValue(), scrAddr);
       }
    }
 
@@ -1168,55 +1469,40 @@ ColoredCoinTracker::getSpendableOutpointsForAddress(
    if (scrAddr.getSize() != 21 && scrAddr.getSize() != 33)
       throw ColoredCoinException("only takes prefixed addresses");
 
-   if (ssPtr != nullptr) {
-      auto iter = ssPtr->scrAddrCcSet_.find(scrAddr.getRef());
-      if (iter != ssPtr->scrAddrCcSet_.end()) {
-         auto revokeIter = ssPtr->revokedAddresses_.find(scrAddr);
-         if (revokeIter != ssPtr->revokedAddresses_.end()) {
-            return {};
-         }
+   //outpoints share hash and scrAddr copies
+   const auto scrAddrPtr = std::make_shared<BinaryData>(scrAddr);
+   std::shared_ptr<BinaryData> hashPtr;
+   const auto addOutpoint = [&result, &scrAddrPtr, &hashPtr, &zcPtr]
+      (const BinaryDataRef& txHash, const CcOutput& output)
+   {
+      if ((hashPtr == nullptr) || (txHash != hashPtr->getRef())) {
+         hashPtr = std::make_shared<BinaryData>(txHash);
+      }
 
-         if (zcPtr != nullptr) {
-            for (auto& ccOp : iter->second) {
-               //is this outpoint spent by a zc?
-               auto zcSpentIter = zcPtr->spentOutputs_.find(ccOp->getTxHash()->getRef());
-               if (zcSpentIter != zcPtr->spentOutputs_.end()) {
-                  auto idIter = zcSpentIter->second.find(ccOp->index());
-                  if (idIter != zcSpentIter->second.end()) {
-                     continue;
-                  }
-               }
+      //is this outpoint spent by a zc?
+      if ((zcPtr != nullptr) && isSpentByZc(zcPtr, *hashPtr, output.index_)) {
+         return;
+      }
 
-               result.push_back(ccOp);
-            }
-         }
-         else {
-            for (auto& ccOp : iter->second) {
-               result.push_back(ccOp);
-            }
-         }
+      auto opPtr = std::make_shared<CcOutpoint>(output.value_, output.index_);
+      opPtr->setTxHash(hashPtr);
+      opPtr->setScrAddr(scrAddrPtr);
+      result.push_back(opPtr);
+   };
+
+   if (ssPtr != nullptr && ssPtr->utxoSet_.hasAddress(scrAddr)) {
+      auto revokeIter = ssPtr->revokedAddresses_.find(scrAddr);
+      if (revokeIter != ssPtr->revokedAddresses_.end()) {
+         return {};
       }
+      ssPtr->utxoSet_.forEachAddressOutput(scrAddr, addOutpoint);
    }
 
    if (zcPtr == nullptr || confirmedOnly) {
       return result;
    }
 
-   //this formating is painful to read   
-   auto zcIter = zcPtr->scrAddrCcSet_.find(scrAddr.getRef());
-   if (zcIter != zcPtr->scrAddrCcSet_.end()) {
-      for (auto& ccOp : zcIter->second) {
-         //is this outpoint spent by a zc?
-         auto zcSpentIter = zcPtr->spentOutputs_.find(ccOp->getTxHash()->getRef());
-         if (zcSpentIter != zcPtr->spentOutputs_.end()) {
-            auto idIter = zcSpentIter->second.find(ccOp->index());
-            if (idIter != zcSpentIter->second.end())
-               continue;
-         }
-
-         result.push_back(ccOp);
-      }
-   }
+   zcPtr->utxoSet_.forEachAddressOutput(scrAddr, addOutpoint);
 
    return result;
 }
@@ -1304,142 +1590,48 @@ bool ColoredCoinTrackerClient::isTxHashValidHistory(
    return result;
 }
 
-////
-void ColoredCoinTracker::eraseScrAddrOp(
-   const std::shared_ptr<ColoredCoinSnapshot> &ssPtr
-   , const std::shared_ptr<CcOutpoint>& opPtr)
-{
-   if (ssPtr == nullptr) {
-      return;
-   }
-   auto scrAddrIter = ssPtr->scrAddrCcSet_.find(opPtr->getScrAddr()->getRef());
-   if (scrAddrIter == ssPtr->scrAddrCcSet_.end()) {
-      return;
-   }
-   scrAddrIter->second.erase(opPtr);
-   if (scrAddrIter->second.size() == 0) {
-      ssPtr->scrAddrCcSet_.erase(scrAddrIter);
-   }
-}
-
-////
-void ColoredCoinTracker::addScrAddrOp(
-   std::map<BinaryData, OpPtrSet>& addrMap
-   , const std::shared_ptr<CcOutpoint>& opPtr)
-{
-   auto scrAddrIter = addrMap.find(opPtr->getScrAddr()->getRef());
-   if (scrAddrIter == addrMap.end()) {
-      scrAddrIter = addrMap.insert(std::make_pair(
-         opPtr->getScrAddr()->getRef(), OpPtrSet())).first;
-   }
-
-   scrAddrIter->second.insert(opPtr);
-}
-
 ////
 void ColoredCoinTracker::addUtxo(
    const std::shared_ptr<ColoredCoinSnapshot>& ssPtr
    , const BinaryData& txHash, unsigned txOutIndex
    , uint64_t value, const BinaryData& scrAddr)
 {
-   std::shared_ptr<BinaryData> hashPtr;
-   auto hashIter = ssPtr->utxoSet_.find(txHash.getRef());
-   if (hashIter == ssPtr->utxoSet_.end()) {
-      //create hash shared_ptr and map entry
-      hashPtr = std::make_shared<BinaryData>(txHash);
-      hashIter = ssPtr->utxoSet_.insert(std::make_pair(
-         hashPtr->getRef(), std::map<unsigned, std::shared_ptr<CcOutpoint>>())).first;
-   }
-   else {
-      //already have this hash entry, recover the hash shared_ptr
-      if (hashIter->second.size() == 0)
-         throw ColoredCoinException("empty utxo hash map");
-
-      auto opPtr = hashIter->second.begin()->second;
-      if (opPtr == nullptr) {
-         throw ColoredCoinException("null utxo ptr");
-      }
-      hashPtr = opPtr->getTxHash();
-   }
-
    ssPtr->txHistory_[txHash].insert(txOutIndex);
 
-   //create output ptr
-   auto opPtr = std::make_shared<CcOutpoint>(value, txOutIndex);
-   opPtr->setTxHash(hashPtr);
-
-   auto scrAddrPtr = getScrAddrPtr(ssPtr->scrAddrCcSet_, scrAddr);
-   if (scrAddrPtr == nullptr) {
-      scrAddrPtr = std::make_shared<BinaryData>(scrAddr);
-   }
-   opPtr->setScrAddr(scrAddrPtr);
-
-   //add to utxo set
-   hashIter->second.insert(std::make_pair(txOutIndex, opPtr));
-
-   //add to scrAddr to utxo map
-   addScrAddrOp(ssPtr->scrAddrCcSet_, opPtr);
+   //add to utxo set and scrAddr to utxo map
+   ssPtr->utxoSet_.add(txHash, txOutIndex, value, scrAddr);
 }
 
 ////
 void ColoredCoinTracker::addZcUtxo(
-   const std::shared_ptr<ColoredCoinSnapshot>& ssPtr
-   , const std::shared_ptr<ColoredCoinZCSnapshot>& zcPtr
+   const std::shared_ptr<ColoredCoinZCSnapshot>& zcPtr
    , const BinaryData& txHash, unsigned txOutIndex
    , uint64_t value, const BinaryData& scrAddr)
 {
-   std::shared_ptr<BinaryData> hashPtr;
-   auto hashIter = zcPtr->utxoSet_.find(txHash.getRef());
-   if (hashIter == zcPtr->utxoSet_.end()) {
-      //dont have this entry, does the snapshot carry the hash shared_ptr?
-      auto ssIter = ssPtr->utxoSet_.find(txHash.getRef());
-      if (ssIter != ssPtr->utxoSet_.end() && ssIter->second.size() != 0) {
-         hashPtr = ssIter->second.begin()->second->getTxHash();
-      }
-      else {
-         //otherwise created the hash shared_ptr
-         hashPtr = std::make_shared<BinaryData>(txHash);
-      }
+   zcPtr->utxoSet_.add(txHash, txOutIndex, value, scrAddr);
+}
+
+////
+BinaryData ColoredCoinTracker::getBlockHash(unsigned height) const
+{
+   auto promPtr = std::make_shared<std::promise<BinaryData>>();
+   auto fut = promPtr->get_future();
+   auto lbd = [promPtr](const BinaryData &header)
+   {
+      promPtr->set_value(header);
+   };
 
-      //add the hash entry to the zc snapshot utxo map
-      hashIter = zcPtr->utxoSet_.insert(std::make_pair(
-         hashPtr->getRef(), std::map<unsigned, std::shared_ptr<CcOutpoint>>())).first;
+   if (!connPtr_->getHeaderByHeight(height, lbd)) {
+      return {};
    }
-   else {
-      //already have this hash entry, recover the hash shared_ptr
-      if (hashIter->second.size() == 0) {
-         throw ColoredCoinException("empty utxo hash map");
-      }
-      auto opPtr = hashIter->second.begin()->second;
-      if (opPtr == nullptr) {
-         throw ColoredCoinException("null utxo ptr");
-      }
-      hashPtr = opPtr->getTxHash();
+   if (fut.wait_for(kHeaderTimeout) != std::future_status::ready) {
+      return {};
    }
-
-   //create output ptr
-   auto opPtr = std::make_shared<CcOutpoint>(value, txOutIndex);
-   opPtr->setTxHash(hashPtr);
-
-   //look for ths scrAddr shared_ptr in the confirmed snapshot 
-   auto scrAddrPtr = getScrAddrPtr(ssPtr->scrAddrCcSet_, scrAddr);
-   if (scrAddrPtr == nullptr) {
-      //missing from that snapshot, is it in the zc snapshot instead?
-      scrAddrPtr = getScrAddrPtr(zcPtr->scrAddrCcSet_, scrAddr);
-
-      //otherwise create it
-      if (scrAddrPtr == nullptr) {
-         scrAddrPtr = std::make_shared<BinaryData>(scrAddr);
-      }
+   const auto header = fut.get();
+   if (header.getSize() != kHeaderSize) {
+      return {};
    }
-
-   opPtr->setScrAddr(scrAddrPtr);
-
-   //add to utxo set
-   hashIter->second.insert(std::make_pair(txOutIndex, opPtr));
-
-   //add to scrAddr to utxo map
-   addScrAddrOp(zcPtr->scrAddrCcSet_, opPtr);
+   return BtcUtils::getHash256(header);
 }
 
 ////
@@ -1459,6 +1651,10 @@ void ColoredCoinTracker::reorg(bool hard)
    startHeight_ = 0;
    zcCutOff_ = 0;
 
+   if (checkpoints_ != nullptr) {
+      checkpoints_->reset();
+   }
+
    snapshotUpdated();
    zcSnapshotUpdated();
 }
@@ -1498,6 +1694,34 @@ bool ColoredCoinTracker::goOnline()
    for (auto& addr : revocationAddresses_) {
       addrVec.push_back(addr);
    }
+
+   /*
+   Resume from the last checkpoint, update() will only scan blocks past
+   it. Addresses of the restored snapshot have to be registered here as
+   update() only returns the ones it discovers.
+   */
+   if (checkpoints_ != nullptr) {
+      const auto checkpoint = checkpoints_->load();
+      const bool isValid = (checkpoint.snapshot != nullptr)
+         && (checkpoint.coinsPerShare == coinsPerShare_)
+         && (checkpoint.originAddresses == originAddresses_)
+         && (checkpoint.startHeight > 0) && !checkpoint.blockHash.empty()
+         && (checkpoint.blockHash == getBlockHash(checkpoint.startHeight - 1));
+      if ((checkpoint.snapshot != nullptr) && !isValid) {
+         //stale chain or another instrument, scan from scratch
+         checkpoints_->reset();
+      }
+      else if (isValid) {
+         checkpoint.snapshot->utxoSet_.forEachAddress(
+            [&addrVec](const BinaryDataRef& scrAddr) {
+            addrVec.emplace_back(scrAddr);
+         });
+         startHeight_ = checkpoint.startHeight;
+         processedHeight_ = checkpoint.processedHeight;
+         std::atomic_store_explicit(
+            &snapshot_, checkpoint.snapshot, std::memory_order_release);
+      }
+   }
    auto &&regID = walletObj_->registerAddresses(addrVec, false);
    while (true) {
       /*
@@ -11,6 +11,9 @@
 #ifndef _H_COLOREDCOINLOGIC
 #define _H_COLOREDCOINLOGIC
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <vector>
 #include <set>
 #include <map>
@@ -18,6 +21,12 @@
 
 #include "Address.h"
 #include "ArmoryConnection.h"
+#include "CcUtxoStore.h"
+#include "PersistentMap.h"
+
+namespace bs {
+   class Executor;
+}
 
 ////
 class ColoredCoinException : public std::runtime_error
@@ -44,6 +53,29 @@ struct ParsedCcTx
    bool hasOutputs(void) const { return isInitialized() && !outputs_.empty(); }
 };
 
+////
+//tx fields used by CC parsing, decoded once per tx
+struct CcTxData
+{
+   struct Output
+   {
+      uint64_t value_;
+      bool isP2WPKH_;
+      BinaryData scrAddr_;
+   };
+
+   BinaryData txHash_;
+   unsigned height_ = UINT32_MAX;
+   bool isSegWit_ = false;
+
+   //spent outpoints <txHash, txOutId>, only set for segwit txs
+   std::vector<std::pair<BinaryData, unsigned>> inputs_;
+   std::vector<Output> outputs_;
+
+   CcTxData(void) = default;
+   explicit CcTxData(const Tx&);
+};
+
 ////
 struct CcTxCandidate
 {
@@ -59,6 +91,7 @@ struct CcTxCandidate
 using CcTxCandidateCb = std::function<void(const CcTxCandidate &)>;
 
 ////
+//returned by outpoint queries, snapshots keep outputs in CcUtxoStore
 struct CcOutpoint
 {
 private:
@@ -121,23 +154,25 @@ struct BinaryDataCompare
    }
 };
    
-using OpPtrSet = std::set<std::shared_ptr<CcOutpoint>, CcOutpointCompare>;
-using CcUtxoSet = std::map<BinaryData, std::map<unsigned, std::shared_ptr<CcOutpoint>>>;
-using ScrAddrCcSet = std::map<BinaryData, OpPtrSet>;
-using OutPointsSet = std::map<BinaryData, std::set<unsigned>>;
+/*
+Snapshot containers share structure between versions: copying a snapshot
+is cheap and a new version only clones the parts it modifies. Use find()
+for lookups and findMutable()/operator[]/emplace()/erase() for changes.
+*/
+template<class V>
+using CcMap = bs::PersistentMap<BinaryData, V, CcKeyHash>;
+
+using OutPointsSet = CcMap<std::set<unsigned>>;
 
 ////
 struct ColoredCoinSnapshot
 {
 public:
-   //<txHash, <txOutId, outpoint>>
-   CcUtxoSet utxoSet_;
-
-   //<prefixed scrAddr, <outpoints>>
-   ScrAddrCcSet scrAddrCcSet_;
+   //<txHash, <txOutId, output>> and <prefixed scrAddr, <outpoints>>
+   CcUtxoStore utxoSet_;
 
    //<prefixed scrAddr, height of revoke tx>
-   std::map<BinaryData, unsigned> revokedAddresses_;
+   CcMap<unsigned> revokedAddresses_;
 
    //<txHash, txOutId>
    OutPointsSet txHistory_;
@@ -147,11 +182,8 @@ public:
 struct ColoredCoinZCSnapshot
 {
 public:
-   //<txHash, <txOutId, outpoint>>
-   CcUtxoSet utxoSet_;
-
-   //<prefixed scrAddr, <outpoints>>
-   ScrAddrCcSet scrAddrCcSet_;
+   //<txHash, <txOutId, output>> and <prefixed scrAddr, <outpoints>>
+   CcUtxoStore utxoSet_;
 
    //<hash, <txOutIds>>
    OutPointsSet spentOutputs_;
@@ -159,6 +191,8 @@ public:
 
 ////
 class ColoredCoinTracker;
+class CcTxPipeline;
+class ColoredCoinCheckpoints;
 
 ////
 class ColoredCoinACT : public ArmoryCallbackTarget
@@ -294,6 +328,34 @@ private:
    SnapshotUpdatedCb zcSnapshotUpdatedCb_;
    SnapshotUpdatedCb readyCb_;
 
+public:
+   //stages of a single update() call
+   struct UpdateTimings
+   {
+      std::chrono::microseconds total_{ 0 };
+
+      //waiting for tx batches to be fetched and decoded
+      std::chrono::microseconds fetchWait_{ 0 };
+
+      //tx decoding, summed over all threads
+      std::chrono::microseconds decode_{ 0 };
+
+      //CC validation and snapshot changes
+      std::chrono::microseconds apply_{ 0 };
+
+      //waiting for spentness of new CC outputs
+      std::chrono::microseconds spentnessWait_{ 0 };
+
+      unsigned rounds_ = 0;
+      size_t txCount_ = 0;
+   };
+   using UpdateTimingsCb = std::function<void(const UpdateTimings&)>;
+
+private:
+   std::shared_ptr<bs::Executor> executor_;
+   UpdateTimingsCb updateTimingsCb_;
+   std::shared_ptr<ColoredCoinCheckpoints> checkpoints_;
+
 protected:
    std::shared_ptr<AsyncClient::BtcWallet> walletObj_;
    std::shared_ptr<ColoredCoinACT>  actPtr_;
@@ -306,11 +368,16 @@ private:
       const std::shared_ptr<ColoredCoinSnapshot> &,
       const std::shared_ptr<ColoredCoinZCSnapshot>&,
       const Tx&) const;
+   ParsedCcTx processTx(
+      const std::shared_ptr<ColoredCoinSnapshot> &,
+      const std::shared_ptr<ColoredCoinZCSnapshot>&,
+      const CcTxData&) const;
 
    ////
    std::set<BinaryData> processTxBatch(
       std::shared_ptr<ColoredCoinSnapshot>&,
-      const std::set<BinaryData>&, bool parseLowest);
+      const std::set<BinaryData>&, bool parseLowest,
+      CcTxPipeline&);
 
    std::set<BinaryData> processZcBatch(
       const std::shared_ptr<ColoredCoinSnapshot>&,
@@ -331,28 +398,16 @@ private:
       uint64_t value, const BinaryData& scrAddr);
 
    void addZcUtxo(
-      const std::shared_ptr<ColoredCoinSnapshot>&,
       const std::shared_ptr<ColoredCoinZCSnapshot>&,
       const BinaryData& txHash, unsigned txOutIndex,
       uint64_t value, const BinaryData& scrAddr);
 
-   ////
-   const std::shared_ptr<BinaryData> getScrAddrPtr(
-      const std::map<BinaryData, OpPtrSet>&,
-      const BinaryData&) const;
-
-   ////
-   void eraseScrAddrOp(
-      const std::shared_ptr<ColoredCoinSnapshot> &,
-      const std::shared_ptr<CcOutpoint>&);
-   
-   void addScrAddrOp(
-      std::map<BinaryData, OpPtrSet>&,
-      const std::shared_ptr<CcOutpoint>&);
-
    std::set<BinaryData> collectOriginAddresses() const;
    std::set<BinaryData> collectRevokeAddresses() const;
 
+   ////
+   BinaryData getBlockHash(unsigned height) const;
+
    ////
    void waitOnRefresh(const std::string&);
    void pushRefreshID(std::vector<BinaryData>&);
@@ -395,6 +450,24 @@ public:
    void setZcSnapshotUpdatedCb(SnapshotUpdatedCb cb) override;
    void setReadyCb(SnapshotUpdatedCb cb) override;
 
+   /*
+   Enables pipelined settlement walk in update(): txs are decoded in
+   parallel on executor threads, spender txs are prefetched while the
+   current batch is being applied. Should be set before goOnline().
+   */
+   void setPipelineExecutor(const std::shared_ptr<bs::Executor>&);
+
+   //invoked from the notification thread after each update()
+   void setUpdateTimingsCb(UpdateTimingsCb cb);
+
+   /*
+   Resumes from the last stored checkpoint in goOnline(), so only blocks
+   past it are scanned, and stores a new one after each update(). Stored
+   checkpoints are discarded if their block is no longer in the main chain
+   or they belong to another instrument. Should be set before goOnline().
+   */
+   void setCheckpoints(const std::shared_ptr<ColoredCoinCheckpoints>&);
+
    ////
    static uint64_t getCcOutputValue(
       const std::shared_ptr<ColoredCoinSnapshot> &
@@ -12,6 +12,7 @@
 #define __DATA_CONNECTION_LISTENER_H__
 
 #include <string>
+#include "DataSlice.h"
 
 class DataConnectionListener
 {
@@ -26,6 +27,7 @@ public:
       HeartbeatWaitFailed,
       ConnectionTimeout,
       ProtocolViolation,
+      SendBufferOverflow,
    };
 
 public:
@@ -40,6 +42,8 @@ public:
 
 public:
    virtual void OnDataReceived(const std::string& data) = 0;
+   // Zero-copy variant used by transports that support it. Default copies data.
+   virtual void OnDataSliceReceived(const bs::network::DataSlice &data) { OnDataReceived(data.toString()); }
    virtual void OnConnected() = 0;
    virtual void OnDisconnected() = 0;
    virtual void OnError(DataConnectionError errorCode) = 0;
@@ -0,0 +1,91 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#ifndef DATA_SLICE_H
+#define DATA_SLICE_H
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bs {
+   namespace network {
+
+      // Ref-counted read-only view into a received data buffer.
+      // Keeps the buffer alive, but transport can't reuse it until all slices
+      // are released, so long-lived copies should be made with toString().
+      class DataSlice
+      {
+      public:
+         using Buffer = std::vector<uint8_t>;
+
+         DataSlice() = default;
+         DataSlice(std::shared_ptr<const Buffer> buffer, size_t offset, size_t size)
+            : buffer_(std::move(buffer)), offset_(offset), size_(size)
+         {
+            if (!buffer_ || (offset_ + size_ > buffer_->size())) {
+               throw std::out_of_range("invalid slice");
+            }
+         }
+
+         const uint8_t *data() const { return buffer_ ? buffer_->data() + offset_ : nullptr; }
+         size_t size() const { return size_; }
+         bool empty() const { return (size_ == 0); }
+
+         std::string toString() const
+         {
+            return size_ ? std::string(reinterpret_cast<const char *>(data()), size_) : std::string{};
+         }
+
+         // Narrower view sharing the same buffer
+         DataSlice slice(size_t offset, size_t size) const
+         {
+            if (offset + size > size_) {
+               throw std::out_of_range("invalid slice");
+            }
+            return DataSlice(buffer_, offset_ + offset, size);
+         }
+
+      private:
+         std::shared_ptr<const Buffer> buffer_;
+         size_t offset_{ 0 };
+         size_t size_{ 0 };
+      };
+
+
+      // Reusable receive buffer. The same buffer is handed out again if no
+      // slices of previous packet are alive, so steady-state receive doesn't
+      // allocate. Not thread-safe - should be used from one reading thread.
+      class SliceBufferPool
+      {
+      public:
+         std::shared_ptr<DataSlice::Buffer> acquire(size_t size)
+         {
+            if (!buffer_ || (buffer_.use_count() > 1)
+               || ((buffer_->capacity() > kMaxPooledSize) && (size <= kMaxPooledSize))) {
+               buffer_ = std::make_shared<DataSlice::Buffer>();
+            }
+            buffer_->resize(size);
+            return buffer_;
+         }
+
+      private:
+         // don't keep occasional big packets' memory around
+         static constexpr size_t kMaxPooledSize = 1024 * 1024;
+
+         std::shared_ptr<DataSlice::Buffer> buffer_;
+      };
+
+   }  // namespace network
+}  // namespace bs
+
+#endif // DATA_SLICE_H
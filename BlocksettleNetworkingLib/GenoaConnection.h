@@ -15,6 +15,7 @@
 
 #include <string>
 #include <memory>
+#include "StreamFramer.h"
 
 namespace spdlog {
    class logger;
@@ -26,9 +27,11 @@ class GenoaConnection : public _S
 public:
    GenoaConnection(const std::shared_ptr<spdlog::logger> &logger)
       : _S(logger)
+      , framer_(std::make_unique<bs::network::DelimitedFrameParser>(marker))
    {}
    GenoaConnection(const std::shared_ptr<spdlog::logger> &logger, bool monitored)
       : _S(logger, monitored)
+      , framer_(std::make_unique<bs::network::DelimitedFrameParser>(marker))
    {}
 
    ~GenoaConnection() noexcept override = default;
@@ -42,30 +45,25 @@ public:
 public:
    bool send(const std::string& data) override
    {
-      std::string message = data + marker;
-      return _S::sendRawData(message);
+      return _S::sendRawData(frame(data));
    }
 
-protected:
-   void onRawDataReceived(const std::string& rawData) override
+   std::string frame(const std::string& data) const
    {
-      pendingData_.append(rawData);
-      ProcessIncomingData();
+      return data + marker;
    }
 
-private:
-   void ProcessIncomingData() {
-      size_t position;
-      while ( (position = pendingData_.find(marker)) != std::string::npos) {
-         std::string message = pendingData_.substr(0, position);
-         pendingData_ = pendingData_.substr(position + marker.size());
-         _S::notifyOnData(message);
-      }
+protected:
+   void onRawDataReceived(const std::string& rawData) override
+   {
+      framer_.process(rawData, [this](std::string_view message) {
+         _S::notifyOnData(std::string(message));
+      });
    }
 
 private:
-   std::string pendingData_;
    const std::string marker = "\r\n\r\n";
+   bs::network::StreamFramer framer_;
 };
 
 #endif // __GENOA_CONNECTION_H__
@@ -182,25 +182,25 @@ protected:
    std::unordered_set<std::string>     woWallets_;
    std::set<bs::signer::RequestId>     signRequests_;
 
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(std::vector<bs::sync::WalletInfo>)>>         cbWalletInfoMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(bs::sync::HDWalletData)>>  cbHDWalletMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(bs::sync::WalletData)>>    cbWalletMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(bs::sync::SyncState)>>     cbSyncAddrsMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(const std::vector<std::pair<bs::Address, std::string>> &)>> cbExtAddrsMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(const std::vector<std::pair<bs::Address, std::string>> &)>> cbNewAddrsMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, SignTxCb> cbSettlementSignTxMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, SignerStateCb>  cbSignerStateMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(const SecureBinaryData &)>>   cbSettlWalletMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(bool)>>                       cbSettlIdMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(bool, bs::Address)>>          cbPayinAddrMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(bool, const SecureBinaryData &)>>   cbSettlPubkeyMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(const BIP32_Node &)>>   cbChatNodeMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(const bs::Address &)>>  cbSettlAuthMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(const BinaryData &, const BinaryData &)>>  cbSettlCPMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, std::function<void(BinaryData signedTX, bs::error::ErrorCode result, const std::string& errorReason)>> signTxMap_;
-
-   bs::ThreadSafeMap<bs::signer::RequestId, CreateHDLeafCb>          cbCCreateLeafMap_;
-   bs::ThreadSafeMap<bs::signer::RequestId, UpdateWalletStructureCB> cbUpdateWalletMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(std::vector<bs::sync::WalletInfo>)>>         cbWalletInfoMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(bs::sync::HDWalletData)>>  cbHDWalletMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(bs::sync::WalletData)>>    cbWalletMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(bs::sync::SyncState)>>     cbSyncAddrsMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(const std::vector<std::pair<bs::Address, std::string>> &)>> cbExtAddrsMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(const std::vector<std::pair<bs::Address, std::string>> &)>> cbNewAddrsMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, SignTxCb> cbSettlementSignTxMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, SignerStateCb>  cbSignerStateMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(const SecureBinaryData &)>>   cbSettlWalletMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(bool)>>                       cbSettlIdMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(bool, bs::Address)>>          cbPayinAddrMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(bool, const SecureBinaryData &)>>   cbSettlPubkeyMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(const BIP32_Node &)>>   cbChatNodeMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(const bs::Address &)>>  cbSettlAuthMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(const BinaryData &, const BinaryData &)>>  cbSettlCPMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, std::function<void(BinaryData signedTX, bs::error::ErrorCode result, const std::string& errorReason)>> signTxMap_;
+
+   bs::ConcurrentHashMap<bs::signer::RequestId, CreateHDLeafCb>          cbCCreateLeafMap_;
+   bs::ConcurrentHashMap<bs::signer::RequestId, UpdateWalletStructureCB> cbUpdateWalletMap_;
 };
 
 
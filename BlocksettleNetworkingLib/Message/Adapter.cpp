@@ -21,38 +21,38 @@ bool Adapter::pushFill(Envelope &env)
    return queue_->pushFill(env);
 }
 
+SeqId Adapter::push(Envelope &&env)
+{
+   if (!queue_) {
+      return 0;
+   }
+   return queue_->push(std::move(env));
+}
+
 SeqId Adapter::pushRequest(const std::shared_ptr<User>& sender
    , const std::shared_ptr<User>& receiver
-   , const std::string& msg, const TimeStamp& execAt)
+   , std::string msg, const TimeStamp& execAt)
 {
-   auto env = Envelope::makeRequest(sender, receiver, msg, execAt);
-   pushFill(env);
-   return env.id();
+   return push(Envelope::makeRequest(sender, receiver, std::move(msg), execAt));
 }
 
 SeqId Adapter::pushResponse(const std::shared_ptr<User>& sender
    , const std::shared_ptr<User>& receiver
-   , const std::string& msg, SeqId respId)
+   , std::string msg, SeqId respId)
 {
-   auto env = Envelope::makeResponse(sender, receiver, msg, respId);
-   pushFill(env);
-   return env.id();
+   return push(Envelope::makeResponse(sender, receiver, std::move(msg), respId));
 }
 
 SeqId Adapter::pushResponse(const std::shared_ptr<User>& sender
    , const bs::message::Envelope& envReq, const std::string& msg)
 {
-   auto env = Envelope::makeResponse(sender, envReq.sender, msg, envReq.foreignId());
-   pushFill(env);
-   return env.id();
+   return push(Envelope::makeResponse(sender, envReq.sender, msg, envReq.foreignId()));
 }
 
 SeqId Adapter::pushBroadcast(const std::shared_ptr<User>& sender
-   , const std::string& msg, bool global)
+   , std::string msg, bool global)
 {
-   auto env = Envelope::makeBroadcast(sender, msg, global);
-   pushFill(env);
-   return env.id();
+   return push(Envelope::makeBroadcast(sender, std::move(msg), global));
 }
 
 
@@ -61,8 +61,7 @@ bool PipeAdapter::process(const Envelope &env)
    if (!endpoint_) {
       return false;
    }
-   auto envCopy = env;
-   return endpoint_->pushFill(envCopy);
+   return (endpoint_->push(Envelope{ env }) != 0);
 }
 
 bool PipeAdapter::processBroadcast(const Envelope& env)
@@ -116,7 +115,7 @@ bool RelayAdapter::processBroadcast(const Envelope& env)
          auto envCopy = env;
          envCopy.setId(0);
          envCopy.resetFlags();
-         queue->pushFill(envCopy);
+         queue->push(std::move(envCopy));
       }
    }
    return false;  // don't account processing time
@@ -133,5 +132,5 @@ bool RelayAdapter::relay(const Envelope& env)
    }
    auto envCopy = env;
    envCopy.setId(0);
-   return itQueue->second->pushFill(envCopy);
+   return (itQueue->second->push(std::move(envCopy)) != 0);
 }
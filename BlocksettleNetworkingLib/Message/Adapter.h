@@ -43,18 +43,19 @@ namespace bs {
 
       protected:
          virtual bool pushFill(Envelope &);
+         virtual SeqId push(Envelope &&);
 
          SeqId pushRequest(const std::shared_ptr<User>& sender
             , const std::shared_ptr<User>& receiver
-            , const std::string& msg, const TimeStamp& execAt = {});
+            , std::string msg, const TimeStamp& execAt = {});
          SeqId pushResponse(const std::shared_ptr<User>& sender
             , const std::shared_ptr<User>& receiver
-            , const std::string& msg, SeqId respId =
+            , std::string msg, SeqId respId =
             (bs::message::SeqId)bs::message::EnvelopeFlags::Response);
          virtual SeqId pushResponse(const std::shared_ptr<User>& sender
             , const bs::message::Envelope& envReq, const std::string& msg);
          SeqId pushBroadcast(const std::shared_ptr<User>& sender
-            , const std::string& msg, bool global = false);
+            , std::string msg, bool global = false);
 
       protected:
          std::shared_ptr<QueueInterface>  queue_;
@@ -19,6 +19,7 @@ using namespace bs::message;
 
 static const std::string kQuitMessage("QUIT");
 static const std::string kAccResetMessage("ACC_RESET");
+static const std::string kAccSnapshotMessage("ACC_SNAPSHOT");
 
 Router::Router(const std::shared_ptr<spdlog::logger> &logger)
    : logger_(logger)
@@ -59,6 +60,35 @@ void Router::bindAdapter(const std::shared_ptr<Adapter> &adapter)
       std::lock_guard<std::mutex> lock(mutex_);
       adapters_[receiver->value()] = adapter;
    }
+   std::lock_guard<std::mutex> lock(mutex_);
+   updateFanOut();
+}
+
+Router::FanOut Router::makeFanOut(const UserValue *excluded) const
+{
+   std::set<std::shared_ptr<Adapter>> adapters;
+   for (const auto &adapter : adapters_) {
+      if (excluded && (adapter.first == *excluded)) {
+         continue;
+      }
+      adapters.insert(adapter.second);
+   }
+   FanOut result;
+   result.adapters.assign(adapters.cbegin(), adapters.cend());
+   result.withDefault = result.adapters;
+   if (defaultRoute_ && (adapters.find(defaultRoute_) == adapters.end())) {
+      result.withDefault.push_back(defaultRoute_);
+   }
+   return result;
+}
+
+void Router::updateFanOut()
+{
+   fanOutAll_ = makeFanOut(nullptr);
+   fanOutFrom_.clear();
+   for (const auto &adapter : adapters_) {
+      fanOutFrom_[adapter.first] = makeFanOut(&adapter.first);
+   }
 }
 
 std::set<UserValue> Router::supportedReceivers() const
@@ -90,50 +120,49 @@ bool Router::isDefaultRouted(const bs::message::Envelope &env) const
 
 std::vector<std::shared_ptr<bs::message::Adapter>> Router::process(const bs::message::Envelope &env) const
 {
-   std::set<std::shared_ptr<bs::message::Adapter>> result;
    if (supervisor_ && !supervisor_->process(env)) {
       logger_->info("[Router::process] msg #{} seized by supervisor", env.id());
       return {};
    }
    if (!env.receiver || env.receiver->isBroadcast()) {
       std::lock_guard<std::mutex> lock(mutex_);
-      for (const auto &adapter : adapters_) {
-         if (!env.sender->isSystem() && (adapter.first == env.sender->value())) {
-            continue;
+      const FanOut *fanOut = &fanOutAll_;
+      if (!env.sender->isSystem()) {
+         const auto itFanOut = fanOutFrom_.find(env.sender->value());
+         if (itFanOut != fanOutFrom_.end()) {
+            fanOut = &itFanOut->second;
          }
-         result.insert(adapter.second);
       }
-      if (defaultRoute_ && !env.sender->isFallback()) {
-         result.insert(defaultRoute_);
+      const auto &result = env.sender->isFallback() ? fanOut->adapters : fanOut->withDefault;
+      if (result.empty()) {
+         throw std::runtime_error("no destination found");
       }
-   } else {
-      if (isDefaultRouted(env)) {
-         if (defaultRoute_) {
-            return { defaultRoute_ };
-         }
-         else {
-            throw std::runtime_error("no route");
-         }
+      return result;
+   }
+   if (isDefaultRouted(env)) {
+      if (defaultRoute_) {
+         return { defaultRoute_ };
       }
       else {
-         try {
-            return { adapters_.at(env.receiver->value()) };
-         }
-         catch (const std::exception &) {
-            throw std::runtime_error("receiver not found");
-         }
+         throw std::runtime_error("no route");
       }
    }
-   if (result.empty()) {
-      throw std::runtime_error("no destination found");
+   else {
+      try {
+         return { adapters_.at(env.receiver->value()) };
+      }
+      catch (const std::exception &) {
+         throw std::runtime_error("receiver not found");
+      }
    }
-   return { result.cbegin(), result.cend() };
 }
 
 void Router::reset()
 {
+   std::lock_guard<std::mutex> lock(mutex_);
    supervisor_.reset();
    adapters_.clear();
+   updateFanOut();
 }
 
 
@@ -158,48 +187,378 @@ bool bs::message::QueueInterface::accept(const Envelope& env)
    return (env.id() > lastProcessedSeqNo_);
 }
 
-Queue_Locking::Queue_Locking(const std::shared_ptr<RouterInterface> &router
+// queue and envelope currently being processed on this thread
+static thread_local const QueueInterface *tlCurrentQueue = nullptr;
+static thread_local SeqId tlCurrentEnvId = 0;
+
+Queue_Base::Queue_Base(const std::shared_ptr<RouterInterface> &router
    , const std::shared_ptr<spdlog::logger> &logger, const std::string &name
-   , const std::map<int, std::string> &accMap, bool accounting)
+   , const std::map<int, std::string> &accMap, bool accounting
+   , unsigned int nbShards)
    : QueueInterface(router, name)
    , logger_(logger), accMap_(accMap), accounting_(accounting)
 {
-   thread_ = std::thread(&Queue::process, this);
-}
-
-Queue_Locking::~Queue_Locking()
-{
-   terminate();
+   for (unsigned int i = 0; i < nbShards; ++i) {
+      shards_.push_back(std::make_unique<Shard>());
+   }
+   for (size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i]->thread = std::thread(&Queue_Base::processShard, this, i);
+   }
 }
 
-void Queue_Locking::terminate()
+void Queue_Base::terminate()
 {
    stop();
    if (thread_.joinable()) {
       thread_.join();
    }
+   stopShards();
    router_->reset();
 }
 
-
-void Queue_Locking::stop()
+void Queue_Base::stop()
 {
    auto envQuit = Envelope::makeRequest(std::make_shared<UserSystem>(), std::make_shared<UserSystem>()
       , kQuitMessage);
    pushFill(envQuit);
 }
 
-bool Queue_Locking::pushFill(Envelope &env)
+void Queue_Base::bindAdapter(const std::shared_ptr<Adapter> &adapter)
 {
-   if (env.posted.time_since_epoch().count() == 0) {
-      env.posted = bus_clock::now();
+   router_->bindAdapter(adapter);
+   if (!shards_.empty()) {
+      std::lock_guard<std::mutex> lock(shardsMutex_);
+      const auto shardIdx = shardByAdapter_.size() % shards_.size();
+      shardByAdapter_.emplace(adapter.get(), shardIdx);
    }
-   std::unique_lock<std::mutex> lock(cvMutex_);
-   if (env.id() == 0) {
-      env.setId(nextId());
+}
+
+bool Queue_Base::isCurrentlyProcessing(const Envelope &env) const
+{
+   return ((tlCurrentQueue == this) && (tlCurrentEnvId == env.id()));
+}
+
+std::set<UserValue> Queue_Base::supportedReceivers() const
+{
+   return router_->supportedReceivers();
+}
+
+void Queue_Base::processStarted()
+{
+   srand(std::time(nullptr));    // requred for per-thread randomness
+   logger_->debug("[Queue::process] {} started", name_);
+   dqTime_ = bus_clock::now();
+   accTime_ = bus_clock::now();
+}
+
+void Queue_Base::processFinished()
+{
+   if (accounting_) {
+      acc_.report(logger_, name_, accMap_);
    }
+   logger_->debug("[Queue::process] {} finished", name_);
+}
+
+bool Queue_Base::processEnvelope(const Envelope &env, const TimeStamp &timeNow
+   , unsigned int attempts)
+{
+   if (env.executeAt.time_since_epoch().count() != 0) {
+      if (env.executeAt > timeNow) {
+         deferredIds_.insert(env.id());
+         scheduled_.emplace(env.executeAt, env);
+         return true;
+      }
+   } else if (accounting_) {
+      acc_.addQueueTime(std::chrono::duration_cast<std::chrono::microseconds>(timeNow - env.posted));
+   }
+
+   if (!accept(env)) {
+      logger_->info("[Queue::process] {}: envelope #{} failed to pass "
+         "validity checks (<= {}) - skipping", name_, env.id(), lastProcessedSeqNo_);
+      return true;
+   }
+
+   if (env.receiver && env.sender->isSystem() && env.receiver->isSystem()) {
+      if (env.message == kQuitMessage) {
+         logger_->info("[Queue::process] {} detected quit system message", name_);
+         running_ = false;
+         return false;
+      } else if (env.message == kAccResetMessage) {
+         acc_.reset();
+         notifyShards(true, false);
+         return true;
+      } else if (env.message == kAccSnapshotMessage) {
+         publishSnapshot(acc_, name_);
+         notifyShards(false, true);
+         return true;
+      } else {
+         logger_->warn("[Queue::process] {} unknown system message {} - skipping"
+            , name_, env.message.str());
+      }
+   } else {
+      try {
+         const auto& adapters = router_->process(env);
+         if (adapters.empty()) {
+            return true;   // empty result is intended for skipping a message silently (e.g. by supervisor)
+         }
+         for (const auto& adapter : adapters) {
+#ifdef MSG_DEBUGGING
+            logger_->debug("[Queue::process] {}: #{} by {}", name_, env.id()
+               , adapter->name());
+#endif
+            if (!shards_.empty()) {
+               size_t shardIdx = 0;
+               bool shardFound = false;
+               {
+                  std::lock_guard<std::mutex> lock(shardsMutex_);
+                  const auto itShard = shardByAdapter_.find(adapter.get());
+                  if (itShard != shardByAdapter_.end()) {
+                     shardIdx = itShard->second;
+                     shardFound = true;
+                  }
+               }
+               if (shardFound) {
+                  auto &shard = *shards_[shardIdx];
+                  {
+                     std::lock_guard<std::mutex> lock(shard.mutex);
+                     shard.tasks.push_back({ adapter, env, attempts });
+                  }
+                  shard.cv.notify_one();
+                  continue;
+               }
+            }
+            if (!dispatch(adapter, env, acc_)) {
+               retry(env, attempts);
+            }
+         }
+      }
+      catch (const std::exception& e) {
+         logger_->error("[Queue::process] {}: {} for #{} "
+            "from {} ({}) to {} ({}) - skipping", name_, e.what(), env.id()
+            , env.sender->value(), env.sender->name()
+            , env.receiver ? env.receiver->value() : 0
+            , env.receiver ? env.receiver->name() : "null");
+         return true;
+      }
+   }
+   if (env.id() > lastProcessedSeqNo_) {
+      lastProcessedSeqNo_ = env.id();
+   }
+   return true;
+}
+
+bool Queue_Base::dispatch(const std::shared_ptr<Adapter> &adapter
+   , const Envelope &env, PerfAccounting &acc)
+{
+   const bool isBroadcast = (!env.receiver || env.receiver->isBroadcast());
+   TimeStamp procStart;
+   if (accounting_) {
+      procStart = bus_clock::now();
+   }
+   tlCurrentQueue = this;
+   tlCurrentEnvId = env.id();
+   if (shards_.empty()) {
+      currentEnvId_ = env.id();
+   }
+   bool result = true;
+   if (isBroadcast) {
+      const bool processed = adapter->processBroadcast(env);
+      if (accounting_ && processed) {
+         acc.add(static_cast<int>((*adapter->supportedReceivers().cbegin())->value() + 0x1000)
+            , std::chrono::duration_cast<std::chrono::microseconds>(bus_clock::now() - procStart));
+      }
+   }
+   else {
+      result = adapter->process(env);
+      if (accounting_) {
+         acc.add(static_cast<int>(env.receiver ? env.receiver->value() : 0)
+            , std::chrono::duration_cast<std::chrono::microseconds>(bus_clock::now() - procStart));
+      }
+   }
+   tlCurrentQueue = nullptr;
+   tlCurrentEnvId = 0;
+   if (shards_.empty()) {  // shard threads use tlCurrentEnvId only
+      currentEnvId_ = 0;
+   }
+   return result;
+}
+
+void Queue_Base::retry(const Envelope &env, unsigned int attempts)
+{
+   const auto& result = deferredIds_.insert(env.id());
+   if (result.second) { // avoid duplicates
+      const auto retryInterval = std::min(retryMaxInterval_
+         , retryMinInterval_ * (1u << std::min(attempts, 16u)));
+      retries_.emplace(bus_clock::now() + retryInterval, Rejected{ env, attempts + 1 });
+   }
+}
+
+void Queue_Base::processShard(size_t index)
+{
+   auto &shard = *shards_[index];
+   const auto &accName = fmt::format("{}#{}", name_, index);
+   auto accTime = bus_clock::now();
+   PerfAccounting acc;
+   std::deque<Task> tasks;
+
+   while (true) {
+      bool accReset = false;
+      bool accSnapshot = false;
+      {
+         std::unique_lock<std::mutex> lock(shard.mutex);
+         shard.cv.wait(lock, [&shard] {
+            return (!shard.tasks.empty() || !shard.running || shard.accReset
+               || shard.accSnapshot);
+         });
+         if (!shard.running) {
+            break;
+         }
+         tasks.swap(shard.tasks);
+         std::swap(accReset, shard.accReset);
+         std::swap(accSnapshot, shard.accSnapshot);
+      }
+      for (const auto &task : tasks) {
+         try {
+            if (!dispatch(task.adapter, task.env, acc)) {
+               {
+                  std::lock_guard<std::mutex> lock(rejectedMutex_);
+                  rejected_.push_back({ task.env, task.attempts });
+               }
+               hasRejected_ = true;
+               wakeUp();
+            }
+         }
+         catch (const std::exception &e) {
+            logger_->error("[Queue::processShard] {}: {} for #{} by {} - skipping"
+               , accName, e.what(), task.env.id(), task.adapter->name());
+         }
+      }
+      tasks.clear();
+
+      if (accReset) {
+         acc.reset();
+      }
+      if (accSnapshot) {
+         publishSnapshot(acc, accName);
+      }
+      if (accounting_ && ((bus_clock::now() - accTime) >= accountingInterval_)) {
+         accTime = bus_clock::now();
+         acc.report(logger_, accName, accMap_);
+         publishSnapshot(acc, accName);
+      }
+   }
+   if (accounting_) {
+      acc.report(logger_, accName, accMap_);
+   }
+}
+
+void Queue_Base::notifyShards(bool reset, bool snapshot)
+{
+   for (const auto &shard : shards_) {
+      {
+         std::lock_guard<std::mutex> lock(shard->mutex);
+         shard->accReset |= reset;
+         shard->accSnapshot |= snapshot;
+      }
+      shard->cv.notify_one();
+   }
+}
+
+void Queue_Base::setAccountingCallback(const AccountingCb &cb)
+{
+   std::lock_guard<std::mutex> lock(accCbMutex_);
+   accCb_ = cb;
+}
+
+void Queue_Base::publishSnapshot(const PerfAccounting &acc, const std::string &name)
+{
+   AccountingCb cb;
+   {
+      std::lock_guard<std::mutex> lock(accCbMutex_);
+      cb = accCb_;
+   }
+   if (cb) {
+      cb(acc.snapshot(name, accMap_));
+   }
+}
+
+void Queue_Base::stopShards()
+{
+   for (const auto &shard : shards_) {
+      {
+         std::lock_guard<std::mutex> lock(shard->mutex);
+         shard->running = false;
+      }
+      shard->cv.notify_one();
+   }
+   for (const auto &shard : shards_) {
+      if (shard->thread.joinable()) {
+         shard->thread.join();
+      }
+   }
+}
+
+void Queue_Base::processDeferred(const TimeStamp &timeNow)
+{
+   if (hasRejected_.exchange(false)) {
+      decltype(rejected_) rejected;
+      {
+         std::lock_guard<std::mutex> lock(rejectedMutex_);
+         rejected.swap(rejected_);
+      }
+      for (const auto &entry : rejected) {
+         retry(entry.env, entry.attempts);
+      }
+   }
+   // only due entries are touched - the rest costs nothing until their time comes
+   while (!scheduled_.empty() && (scheduled_.cbegin()->first <= timeNow)) {
+      auto node = scheduled_.extract(scheduled_.begin());
+      if (!processEnvelope(node.mapped(), timeNow)) {
+         return;
+      }
+   }
+   while (!retries_.empty() && (retries_.cbegin()->first <= timeNow)) {
+      auto node = retries_.extract(retries_.begin());
+      if (!processEnvelope(node.mapped().env, timeNow, node.mapped().attempts)) {
+         return;
+      }
+   }
+}
+
+void Queue_Base::housekeeping(const TimeStamp &timeNow)
+{
+   const auto nbDeferred = scheduled_.size() + retries_.size();
+   if ((nbDeferred > 100) && ((timeNow - dqTime_) > deferredQueueInterval_)) {
+      dqTime_ = bus_clock::now();
+      logger_->warn("[Queue::process] {} deferred queue has grown to {}+{}/{} elements"
+         , name_, scheduled_.size(), retries_.size(), deferredIds_.size());
+   }
+   if (accounting_ && ((timeNow - accTime_) >= accountingInterval_)) {
+      accTime_ = bus_clock::now();
+      acc_.report(logger_, name_, accMap_);
+      publishSnapshot(acc_, name_);
+   }
+}
+
+TimeStamp Queue_Base::nextWakeup(const TimeStamp &timeNow) const
+{
+   auto result = timeNow + std::chrono::hours(1);
+   if (accounting_) {
+      result = std::min(result, accTime_ + accountingInterval_);
+   }
+   if (!scheduled_.empty()) {
+      result = std::min(result, scheduled_.cbegin()->first);
+   }
+   if (!retries_.empty()) {
+      result = std::min(result, retries_.cbegin()->first);
+   }
+   return result;
+}
 
 #ifdef MSG_DEBUGGING
+static void logPush(const std::shared_ptr<spdlog::logger> &logger
+   , const std::string &name, const Envelope &env)
+{
    std::string msgBody;
    for (const char c : env.message) {
       if ((c < 32) || (c > 126)) {
@@ -216,169 +575,338 @@ bool Queue_Locking::pushFill(Envelope &env)
          msgBody += "...";
       }
    }
-   logger_->debug("[Queue::push] {}: #{}/{} {}({}) -> {}({}) #{} [{}] {}"
-      , name_, env.id(), env.foreignId()
+   logger->debug("[Queue::push] {}: #{}/{} {}({}) -> {}({}) #{} [{}] {}"
+      , name, env.id(), env.foreignId()
       , env.sender->name(), env.sender->value()
       , env.receiver ? env.receiver->name() : "null"
       , env.receiver ? env.receiver->value() : 0, env.responseId(), env.message.size()
       , msgBody.empty() ? msgBody : "'" + msgBody + "'");
+}
 #endif   //MSG_DEBUGGING
 
-   queue_.push_back(env);
-   cvQueue_.notify_one();
-   return true;
-}
 
-void Queue_Locking::process()
+Queue_Locking::Queue_Locking(const std::shared_ptr<RouterInterface> &router
+   , const std::shared_ptr<spdlog::logger> &logger, const std::string &name
+   , const std::map<int, std::string> &accMap, bool accounting
+   , unsigned int nbShards)
+   : Queue_Base(router, logger, name, accMap, accounting, nbShards)
 {
-   srand(std::time(nullptr));    // requred for per-thread randomness
-   logger_->debug("[Queue::process] {} started", name_);
-   decltype(queue_) deferredQueue;
-   auto dqTime = bus_clock::now();
-   auto accTime = bus_clock::now();
-   PerfAccounting acc;
+   thread_ = std::thread(&Queue_Locking::process, this);
+}
 
-   const auto &processPortion = [this, &deferredQueue, &dqTime, &accTime, &acc]
-      (const decltype(queue_) &tempQueue, const bus_clock::time_point &timeNow)
-   {
-      for (const auto &env : tempQueue) {
-         if (env.executeAt.time_since_epoch().count() != 0) {
-            if (env.executeAt > timeNow) {
-               deferredIds_.insert(env.id());
-               deferredQueue.emplace_back(env);
-               continue;
-            }
-         } else if (accounting_) {
-            acc.addQueueTime(std::chrono::duration_cast<std::chrono::microseconds>(timeNow - env.posted));
-         }
+Queue_Locking::~Queue_Locking()
+{
+   terminate();
+}
 
-         if (!accept(env)) {
-            logger_->info("[Queue::process] {}: envelope #{} failed to pass "
-               "validity checks (<= {}) - skipping", name_, env.id(), lastProcessedSeqNo_);
-            continue;
-         }
+bool Queue_Locking::pushFill(Envelope &env)
+{
+   return enqueue(env, false);
+}
 
-         if (env.receiver && env.sender->isSystem() && env.receiver->isSystem()) {
-            if (env.message == kQuitMessage) {
-               logger_->info("[Queue::process] {} detected quit system message", name_);
-               running_ = false;
-               break;
-            } else if (env.message == kAccResetMessage) {
-               acc.reset();
-               continue;
-            } else {
-               logger_->warn("[Queue::process] {} unknown system message {} - skipping"
-                  , name_, env.message);
-            }
-         } else {
-            TimeStamp procStart;
-            const bool isBroadcast = (!env.receiver || env.receiver->isBroadcast());
-            const auto& process = [this, env, isBroadcast, timeNow, &procStart, &acc, &deferredQueue]
-               (const std::shared_ptr<bs::message::Adapter>&adapter)
-            {
-               currentEnvId_ = env.id();
-               if (isBroadcast) {
-                  const bool processed = adapter->processBroadcast(env);
-                  if (accounting_ && processed) {
-                     const auto& timeNow = bus_clock::now();
-                     acc.add(static_cast<int>((*adapter->supportedReceivers().cbegin())->value() + 0x1000)
-                        , std::chrono::duration_cast<std::chrono::microseconds>(timeNow - procStart));
-                     procStart = timeNow;
-                  }
-               }
-               else {
-                  if (!adapter->process(env)) {
-                     const auto& result = deferredIds_.insert(env.id());
-                     if (result.second) { // avoid duplicates
-                        deferredQueue.emplace_back(env);
-                     }
-                  }
-                  if (accounting_) {
-                     acc.add(static_cast<int>(env.receiver ? env.receiver->value() : 0)
-                        , std::chrono::duration_cast<std::chrono::microseconds>(bus_clock::now() - procStart));
-                  }
-               }
-               currentEnvId_ = 0;
-            };
+SeqId Queue_Locking::push(Envelope &&env)
+{
+   return enqueue(env, true) ? env.id() : 0;
+}
 
-            if (accounting_) {
-               procStart = bus_clock::now();
-            }
-            try {
-               const auto& adapters = router_->process(env);
-               if (adapters.empty()) {
-                  continue;   // empty result is intended for skipping a message silently (e.g. by supervisor)
-               }
-               for (const auto& adapter : adapters) {
+bool Queue_Locking::enqueue(Envelope &env, bool move)
+{
+   if (env.posted.time_since_epoch().count() == 0) {
+      env.posted = bus_clock::now();
+   }
+   std::unique_lock<std::mutex> lock(cvMutex_);
+   if (env.id() == 0) {
+      env.setId(nextId());
+   }
 #ifdef MSG_DEBUGGING
-                  logger_->debug("[Queue::process] {}: #{} by {}", name_, env.id()
-                     , adapter->name());
-#endif
-                  process(adapter);
-               }
-            }
-            catch (const std::exception& e) {
-               logger_->error("[Queue::process] {}: {} for #{} "
-                  "from {} ({}) to {} ({}) - skipping", name_, e.what(), env.id()
-                  , env.sender->value(), env.sender->name()
-                  , env.receiver ? env.receiver->value() : 0
-                  , env.receiver ? env.receiver->name() : "null");
-               continue;
-            }
-         }
-         if (env.id() > lastProcessedSeqNo_) {
-            lastProcessedSeqNo_ = env.id();
-         }
-      }
-   };
+   logPush(logger_, name_, env);
+#endif   //MSG_DEBUGGING
+
+   if (move) {
+      queue_.push_back(std::move(env));
+   }
+   else {
+      queue_.push_back(env);
+   }
+   cvQueue_.notify_one();
+   return true;
+}
+
+void Queue_Locking::wakeUp()
+{
+   std::lock_guard<std::mutex> lock(cvMutex_);
+   cvQueue_.notify_one();
+}
+
+void Queue_Locking::process()
+{
+   processStarted();
 
    while (running_) {
       {
+         const auto &wakeup = nextWakeup(bus_clock::now());
          std::unique_lock<std::mutex> lock(cvMutex_);
-         if (queue_.empty()) {
-            cvQueue_.wait_for(lock, std::chrono::milliseconds{ 10 });
+         if (queue_.empty() && !hasRejected_) {
+            cvQueue_.wait_until(lock, wakeup);
          }
       }
       if (!running_) {
          break;
       }
       const auto &timeNow = bus_clock::now();
-      if (!deferredQueue.empty()) {
-         decltype(queue_) tempQueue;
-         deferredQueue.swap(tempQueue);
-         processPortion(tempQueue, timeNow);
-      }
+      processDeferred(timeNow);
+
       decltype(queue_) tempQueue;
       {
          std::unique_lock<std::mutex> lock(cvMutex_);
          tempQueue.swap(queue_);
       }
-      if (!tempQueue.empty()) {
-         processPortion(tempQueue, timeNow);
+      for (const auto &env : tempQueue) {
+         if (!processEnvelope(env, timeNow)) {
+            break;
+         }
       }
+      housekeeping(timeNow);
+   }
+   processFinished();
+}
+
 
-      if ((deferredQueue.size() > 100) && ((timeNow - dqTime) > deferredQueueInterval_)) {
-         dqTime = bus_clock::now();
-         logger_->warn("[Queue::process] {} deferred queue has grown to {}/{} elements"
-            , name_, deferredQueue.size(), deferredIds_.size());
+static size_t roundUpPow2(size_t value)
+{
+   size_t result = 2;
+   while (result < value) {
+      result <<= 1;
+   }
+   return result;
+}
+
+Queue_LockFree::Queue_LockFree(const std::shared_ptr<RouterInterface> &router
+   , const std::shared_ptr<spdlog::logger> &logger, const std::string &name
+   , const std::map<int, std::string> &accMap, bool accounting, size_t capacity
+   , unsigned int nbShards)
+   : Queue_Base(router, logger, name, accMap, accounting, nbShards)
+   , capacity_(roundUpPow2(capacity)), mask_(capacity_ - 1)
+   , slots_(new Slot[capacity_])
+{
+   for (size_t i = 0; i < capacity_; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+   }
+   thread_ = std::thread(&Queue_LockFree::process, this);
+}
+
+Queue_LockFree::~Queue_LockFree()
+{
+   terminate();
+}
+
+void Queue_LockFree::terminate()
+{
+   Queue_Base::terminate();
+   {
+      std::lock_guard<std::mutex> lock(fullMutex_);
+      terminated_ = true;
+   }
+   fullCv_.notify_all();   // processing thread is gone, nobody frees slots
+}
+
+bool Queue_LockFree::pushFill(Envelope &env)
+{
+   return enqueue(env, false);
+}
+
+SeqId Queue_LockFree::push(Envelope &&env)
+{
+   return enqueue(env, true) ? env.id() : 0;
+}
+
+bool Queue_LockFree::enqueue(Envelope &env, bool move)
+{
+   if (env.posted.time_since_epoch().count() == 0) {
+      env.posted = bus_clock::now();
+   }
+   if (std::this_thread::get_id() == threadId_) {
+      // processing thread can't wait for a free slot in the ring - it's
+      // the only one who frees them
+      if (env.id() == 0) {
+         env.setId(nextId());
       }
-      if (accounting_ && ((timeNow - accTime) >= accountingInterval_)) {
-         accTime = bus_clock::now();
-         acc.report(logger_, name_, accMap_);
+#ifdef MSG_DEBUGGING
+      logPush(logger_, name_, env);
+#endif   //MSG_DEBUGGING
+      if (move) {
+         local_.push_back({ std::move(env), tail_.load() });
       }
+      else {
+         local_.push_back({ env, tail_.load() });
+      }
+      return true;
    }
-   if (accounting_) {
-      acc.report(logger_, name_, accMap_);
+
+   if (terminated_) {
+      return false;
    }
-   logger_->debug("[Queue::process] {} finished", name_);
+   const auto ticket = tail_.fetch_add(1);
+   auto &slot = slots_[ticket & mask_];
+   if ((slot.seq.load(std::memory_order_acquire) != ticket)
+      && !waitForSlot(ticket)) {  // ring is full
+      return false;
+   }
+   if (env.id() == 0) {
+      env.setId(nextId());
+      // tickets claimed after this point will receive greater ids
+      slot.horizon = tail_.load();
+   }
+   else {
+      slot.horizon = ticket + 1;
+   }
+#ifdef MSG_DEBUGGING
+   logPush(logger_, name_, env);
+#endif   //MSG_DEBUGGING
+   if (move) {
+      slot.env.emplace(std::move(env));
+   }
+   else {
+      slot.env.emplace(env);
+   }
+   slot.seq.store(ticket + 1, std::memory_order_release);
+   wakeUp();
+   return true;
 }
 
-void Queue_Locking::bindAdapter(const std::shared_ptr<Adapter> &adapter)
+bool Queue_LockFree::isPublished(SeqId ticket) const
 {
-   router_->bindAdapter(adapter);
+   return (slots_[ticket & mask_].seq.load(std::memory_order_acquire) == ticket + 1);
 }
 
-std::set<UserValue> Queue_Locking::supportedReceivers() const
+bool Queue_LockFree::waitForSlot(SeqId ticket)
 {
-   return router_->supportedReceivers();
+   auto &slot = slots_[ticket & mask_];
+   for (int i = 0; i < 64; ++i) {
+      std::this_thread::yield();
+      if (slot.seq.load(std::memory_order_acquire) == ticket) {
+         return true;
+      }
+   }
+   std::unique_lock<std::mutex> lock(fullMutex_);
+   fullWaiters_++;
+   fullCv_.wait(lock, [this, &slot, ticket] {
+      return (slot.seq.load(std::memory_order_acquire) == ticket) || terminated_;
+   });
+   fullWaiters_--;
+   return (slot.seq.load(std::memory_order_acquire) == ticket);
+}
+
+void Queue_LockFree::wakeUp()
+{
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   if (parked_.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(parkMutex_);
+      parked_ = false;
+      parkCv_.notify_one();
+   }
+}
+
+void Queue_LockFree::park(const TimeStamp &until)
+{
+   if (waitTicket_ < tail_.load()) {   // ticket is already claimed and should be published shortly
+      for (int i = 0; i < 16; ++i) {
+         std::this_thread::yield();
+         if (isPublished(waitTicket_)) {
+            return;
+         }
+      }
+   }
+   std::unique_lock<std::mutex> lock(parkMutex_);
+   parked_.store(true, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   if (!isPublished(waitTicket_) && !hasRejected_) {
+      parkCv_.wait_until(lock, until, [this] { return !parked_; });
+   }
+   parked_ = false;
+}
+
+// Envelopes are processed in id order. Each slot's horizon guarantees that
+// all tickets starting from it have greater ids, so only tickets below the
+// horizon of the head slot need to be published and compared.
+// Envelopes pushed from processing thread itself are kept in local_ - their
+// ids are increasing, so only the first of them is a candidate.
+// Returns false if there's nothing to process at the moment.
+bool Queue_LockFree::processReady(const TimeStamp &timeNow)
+{
+   for (size_t i = 0; (i < capacity_) && running_; ++i) {
+      bool released = false;
+      while (isPublished(head_) && slots_[head_ & mask_].done) {
+         auto &slot = slots_[head_ & mask_];
+         slot.env.reset();
+         slot.done = false;
+         slot.seq.store(head_ + capacity_, std::memory_order_release);
+         head_++;
+         released = true;
+      }
+      if (released) {
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+         if (fullWaiters_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(fullMutex_);
+            fullCv_.notify_all();
+         }
+      }
+
+      Slot *nextSlot = nullptr;
+      if (isPublished(head_)) {
+         // producers still waiting for a free slot will get greater ids
+         const auto horizon = std::min(slots_[head_ & mask_].horizon, head_ + capacity_);
+         for (auto ticket = head_; ticket < horizon; ++ticket) {
+            if (!isPublished(ticket)) {
+               waitTicket_ = ticket;
+               return false;
+            }
+            auto &slot = slots_[ticket & mask_];
+            if (slot.done) {
+               continue;
+            }
+            if (!nextSlot || (slot.env->id() < nextSlot->env->id())) {
+               nextSlot = &slot;
+            }
+         }
+         if (!local_.empty() && (local_.front().env.id() < nextSlot->env->id())) {
+            nextSlot = nullptr;
+         }
+      }
+      else if (local_.empty() || (local_.front().horizon > head_)) {
+         waitTicket_ = head_;   // head ticket may hold a smaller id than local one
+         return false;
+      }
+
+      if (nextSlot) {
+         processEnvelope(*nextSlot->env, timeNow);
+         nextSlot->done = true;
+      }
+      else {
+         processEnvelope(local_.front().env, timeNow);
+         local_.pop_front();
+      }
+   }
+   return true;
+}
+
+void Queue_LockFree::process()
+{
+   threadId_ = std::this_thread::get_id();
+   processStarted();
+
+   while (running_) {
+      const auto &timeNow = bus_clock::now();
+      processDeferred(timeNow);
+      const bool busy = processReady(timeNow);
+      housekeeping(timeNow);
+
+      if (!running_) {
+         break;
+      }
+      if (!busy) {
+         park(nextWakeup(timeNow));
+      }
+   }
+   processFinished();
 }
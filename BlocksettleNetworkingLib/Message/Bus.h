@@ -14,12 +14,16 @@
 #include <atomic>
 #include <condition_variable>
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <thread>
 #include <vector>
 #include "Message/Envelope.h"
+#include "PerfAccounting.h"
 
 namespace spdlog {
    class logger;
@@ -55,12 +59,25 @@ namespace bs {
       protected:
          bool isDefaultRouted(const bs::message::Envelope &) const override;
 
+      private:
+         struct FanOut
+         {
+            std::vector<std::shared_ptr<Adapter>>  adapters;
+            std::vector<std::shared_ptr<Adapter>>  withDefault;   // including default route
+         };
+         FanOut makeFanOut(const UserValue *excluded) const;
+         void updateFanOut();    // should be called under mutex_
+
       private:
          std::shared_ptr<spdlog::logger>           logger_;
          mutable std::mutex mutex_;
          std::map<UserValue, std::shared_ptr<Adapter>>   adapters_;
          std::shared_ptr<Adapter>   supervisor_;
          std::shared_ptr<Adapter>   defaultRoute_;
+
+         // broadcast destinations are precomputed at bindAdapter
+         FanOut                     fanOutAll_;
+         std::map<UserValue, FanOut>   fanOutFrom_;   // without sender's own route
       };
 
       class QueueInterface
@@ -77,10 +94,14 @@ namespace bs {
          virtual std::set<UserValue> supportedReceivers() const = 0;
 
          virtual bool pushFill(Envelope &) = 0;
+
+         // envelope contents are moved into the queue - returns assigned id or 0
+         virtual SeqId push(Envelope &&env) { return pushFill(env) ? env.id() : 0; }
+
          SeqId nextId() { return seqNo_++; }
          SeqId resetId(SeqId);
 
-         bool isCurrentlyProcessing(const Envelope& env) const
+         virtual bool isCurrentlyProcessing(const Envelope& env) const
          {
             return (env.id() == currentEnvId_);
          }
@@ -97,36 +118,191 @@ namespace bs {
          SeqId currentEnvId_{ 0 };
       };
 
-      class Queue_Locking : public QueueInterface
+      // common part of queues that dispatch envelopes on their own thread
+      // If nbShards is non-zero, envelopes are routed and validated on queue
+      // thread, but processed by adapters on shard threads. Each adapter is
+      // bound to one shard, so it receives envelopes in the same order.
+      class Queue_Base : public QueueInterface
       {
       public:
-         Queue_Locking(const std::shared_ptr<RouterInterface> &
-            , const std::shared_ptr<spdlog::logger> &, const std::string& name = {}
-            , const std::map<int, std::string> & = {}, bool accounting = true);
-         ~Queue_Locking() override;
-
          void terminate() override;
          void bindAdapter(const std::shared_ptr<Adapter> &) override;
          std::set<UserValue> supportedReceivers() const override;
+         bool isCurrentlyProcessing(const Envelope&) const override;
 
-         bool pushFill(Envelope &) override;
+         // Invoked from processing thread(s) with JSON accounting snapshot
+         // (see PerfAccounting::snapshot) at each periodic report and when
+         // ACC_SNAPSHOT system message is received. Shards report separately.
+         using AccountingCb = std::function<void(const std::string &)>;
+         void setAccountingCallback(const AccountingCb &);
 
-      private:
+      protected:
+         Queue_Base(const std::shared_ptr<RouterInterface> &
+            , const std::shared_ptr<spdlog::logger> &, const std::string& name
+            , const std::map<int, std::string> &, bool accounting
+            , unsigned int nbShards);
+
+         virtual void process() = 0;
+         virtual void wakeUp() = 0;
          void stop();
-         void process();
+
+         // should be called only from processing thread
+         void processStarted();
+         void processFinished();
+         bool processEnvelope(const Envelope &, const TimeStamp &timeNow
+            , unsigned int attempts = 0);   // false on quit
+         void processDeferred(const TimeStamp &timeNow);
+         void housekeeping(const TimeStamp &timeNow);
+         TimeStamp nextWakeup(const TimeStamp &timeNow) const;
 
       private:
+         struct Task
+         {
+            std::shared_ptr<Adapter>   adapter;
+            Envelope       env;
+            unsigned int   attempts;
+         };
+         struct Shard
+         {
+            std::thread             thread;
+            std::mutex              mutex;
+            std::condition_variable cv;
+            std::deque<Task>        tasks;
+            bool                    running{ true };
+            bool                    accReset{ false };
+            bool                    accSnapshot{ false };
+         };
+
+         // returns false if adapter rejected unicast envelope
+         bool dispatch(const std::shared_ptr<Adapter> &, const Envelope &
+            , PerfAccounting &);
+         void retry(const Envelope &, unsigned int attempts);
+         void processShard(size_t index);
+         void stopShards();
+         void notifyShards(bool reset, bool snapshot);
+         void publishSnapshot(const PerfAccounting &, const std::string &name);
+
+      protected:
          std::shared_ptr<spdlog::logger>  logger_;
          const std::map<int, std::string> accMap_;
          const bool accounting_;
          const std::chrono::seconds deferredQueueInterval_{ 30 };
          const std::chrono::seconds accountingInterval_{ 600 };
+         std::atomic_bool        running_{ true };
+         std::thread             thread_;
+
+         const std::chrono::milliseconds retryMinInterval_{ 1 };
+         const std::chrono::milliseconds retryMaxInterval_{ 250 };
+
+         struct Rejected
+         {
+            Envelope       env;
+            unsigned int   attempts;
+         };
+
+         // accessed only from processing thread
+         std::multimap<TimeStamp, Envelope>  scheduled_;    // by executeAt
+         std::multimap<TimeStamp, Rejected>  retries_;      // rejected by adapter, with backoff
+         TimeStamp               dqTime_;
+         TimeStamp               accTime_;
+         PerfAccounting          acc_;
+
+         // envelopes rejected on shard threads are passed back to queue thread
+         std::atomic_bool        hasRejected_{ false };
+         std::mutex              rejectedMutex_;
+         std::vector<Rejected>   rejected_;
+
+      private:
+         std::vector<std::unique_ptr<Shard>> shards_;
+         mutable std::mutex      shardsMutex_;
+         std::map<const Adapter *, size_t>   shardByAdapter_;
+         std::mutex              accCbMutex_;
+         AccountingCb            accCb_;
+      };
+
+      class Queue_Locking : public Queue_Base
+      {
+      public:
+         Queue_Locking(const std::shared_ptr<RouterInterface> &
+            , const std::shared_ptr<spdlog::logger> &, const std::string& name = {}
+            , const std::map<int, std::string> & = {}, bool accounting = true
+            , unsigned int nbShards = 0);
+         ~Queue_Locking() override;
+
+         bool pushFill(Envelope &) override;
+         SeqId push(Envelope &&) override;
+
+      private:
+         void process() override;
+         void wakeUp() override;
+         bool enqueue(Envelope &, bool move);
+
+      private:
          std::deque<Envelope>    queue_;
          std::condition_variable cvQueue_;
          std::mutex              cvMutex_;
-         std::atomic_bool        running_{ true };
-         std::thread             thread_;
       };
+
+      // Producers don't take any lock - envelopes are put into a bounded ring
+      // and the processing thread is only signalled if it's parked.
+      // Ids are assigned in ring order with a small reordering window, so
+      // validity checks in accept() work the same way as in Queue_Locking.
+      class Queue_LockFree : public Queue_Base
+      {
+      public:
+         Queue_LockFree(const std::shared_ptr<RouterInterface> &
+            , const std::shared_ptr<spdlog::logger> &, const std::string& name = {}
+            , const std::map<int, std::string> & = {}, bool accounting = true
+            , size_t capacity = 4096, unsigned int nbShards = 0);
+         ~Queue_LockFree() override;
+
+         bool pushFill(Envelope &) override;
+         SeqId push(Envelope &&) override;
+         void terminate() override;
+
+      private:
+         struct Slot
+         {
+            std::atomic<SeqId>   seq{ 0 };
+            SeqId    horizon{ 0 };  // all tickets starting from this have greater ids
+            bool     done{ false };
+            std::optional<Envelope> env;
+         };
+         struct LocalEnvelope
+         {
+            Envelope env;
+            SeqId    horizon;
+         };
+
+         void process() override;
+         bool enqueue(Envelope &, bool move);
+         bool isPublished(SeqId ticket) const;
+         bool processReady(const TimeStamp &timeNow);
+         bool waitForSlot(SeqId ticket);  // false if terminated
+         void wakeUp() override;
+         void park(const TimeStamp &until);
+
+      private:
+         const size_t   capacity_;
+         const SeqId    mask_;
+         std::unique_ptr<Slot[]> slots_;
+         alignas(64) std::atomic<SeqId>   tail_{ 0 };
+         alignas(64) std::atomic_bool     parked_{ false };
+         std::mutex              parkMutex_;
+         std::condition_variable parkCv_;
+         std::atomic_int         fullWaiters_{ 0 };
+         std::mutex              fullMutex_;
+         std::condition_variable fullCv_;
+         std::atomic_bool        terminated_{ false };  // no more slots are freed
+
+         std::atomic<std::thread::id>  threadId_;
+
+         // accessed only from processing thread
+         SeqId             head_{ 0 };
+         SeqId             waitTicket_{ 0 };
+         std::deque<LocalEnvelope>  local_;  // pushed from processing thread
+      };
+
       using Queue = Queue_Locking;    // temporary hack to avoid name clashing with ThreadSafeClasses.h
 
 
@@ -11,6 +11,7 @@
 #ifndef MESSAGE_ENVELOPE_H
 #define MESSAGE_ENVELOPE_H
 
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <memory>
@@ -73,6 +74,92 @@ namespace bs {
       };
 
 
+      // Copy/allocation counters for verifying that message bodies are shared
+      // between hops instead of being copied. Disabled by default - counters
+      // are shared by all bus threads, enable them only for diagnostics.
+      struct EnvelopeCounters
+      {
+         std::atomic<uint64_t>   payloads{ 0 };       // payload buffers allocated
+         std::atomic<uint64_t>   payloadBytes{ 0 };   // bytes stored in allocated payloads
+         std::atomic<uint64_t>   copies{ 0 };         // envelope copies (payload is shared)
+         std::atomic<uint64_t>   moves{ 0 };          // envelope moves
+
+         static EnvelopeCounters &instance()
+         {
+            static EnvelopeCounters counters;
+            return counters;
+         }
+
+         static void setEnabled(bool enabled)
+         {
+            enabledFlag().store(enabled, std::memory_order_relaxed);
+         }
+         static bool enabled()
+         {
+            return enabledFlag().load(std::memory_order_relaxed);
+         }
+
+         static void add(std::atomic<uint64_t> EnvelopeCounters::*counter, uint64_t value = 1)
+         {
+            if (enabled()) {
+               (instance().*counter).fetch_add(value, std::memory_order_relaxed);
+            }
+         }
+
+      private:
+         // written only on configuration, so reading it doesn't bounce the cache line
+         static std::atomic<bool> &enabledFlag()
+         {
+            static std::atomic<bool> flag{ false };
+            return flag;
+         }
+      };
+
+      // Immutable ref-counted message body - copying it only increments
+      // the reference counter, so one body can be shared by all hops
+      class Payload
+      {
+      public:
+         Payload() = default;
+         Payload(std::string data)
+            : data_(std::make_shared<const std::string>(std::move(data)))
+         {
+            EnvelopeCounters::add(&EnvelopeCounters::payloads);
+            EnvelopeCounters::add(&EnvelopeCounters::payloadBytes, data_->size());
+         }
+         Payload(const char *data) : Payload(std::string(data)) {}
+
+         const std::string &str() const { return data_ ? *data_ : emptyString(); }
+         operator const std::string &() const { return str(); }
+
+         size_t size() const { return str().size(); }
+         bool empty() const { return str().empty(); }
+         const char *data() const { return str().data(); }
+         std::string::const_iterator begin() const { return str().cbegin(); }
+         std::string::const_iterator end() const { return str().cend(); }
+         std::string substr(size_t pos, size_t count = std::string::npos) const
+         {
+            return str().substr(pos, count);
+         }
+
+         long useCount() const { return data_.use_count(); }
+         bool sharedWith(const Payload &other) const { return (data_ == other.data_); }
+
+         bool operator==(const std::string &other) const { return (str() == other); }
+         bool operator!=(const std::string &other) const { return (str() != other); }
+
+      private:
+         static const std::string &emptyString()
+         {
+            static const std::string empty;
+            return empty;
+         }
+
+      private:
+         std::shared_ptr<const std::string>  data_;
+      };
+
+
       using SeqId = uint64_t;
 
       enum class EnvelopeFlags : SeqId
@@ -87,30 +174,49 @@ namespace bs {
       {
          Envelope() {}
 
+         Envelope(const Envelope &other)
+            : sender(other.sender), receiver(other.receiver), posted(other.posted)
+            , executeAt(other.executeAt), message(other.message), id_(other.id_)
+            , foreignId_(other.foreignId_), responseId_(other.responseId_)
+         {
+            EnvelopeCounters::add(&EnvelopeCounters::copies);
+         }
+
+         // ids are kept in moved-from envelope, so they can be read after push
+         Envelope(Envelope &&other) noexcept
+            : sender(std::move(other.sender)), receiver(std::move(other.receiver))
+            , posted(other.posted), executeAt(other.executeAt)
+            , message(std::move(other.message)), id_(other.id_)
+            , foreignId_(other.foreignId_), responseId_(other.responseId_)
+         {
+            EnvelopeCounters::add(&EnvelopeCounters::moves);
+         }
+
          static Envelope makeRequest(const std::shared_ptr<User>& s, const std::shared_ptr<User>& r
-            , const std::string& msg, const TimeStamp& execAt = {})
+            , std::string msg, const TimeStamp& execAt = {})
          {
-            return Envelope{ s, r, execAt, msg };
+            return Envelope{ s, r, execAt, std::move(msg) };
          }
 
          static Envelope makeResponse(const std::shared_ptr<User>& s, const std::shared_ptr<User>& r
-            , const std::string& msg, SeqId respId)
+            , std::string msg, SeqId respId)
          {
-            return Envelope{ s, r, msg, respId };
+            return Envelope{ s, r, std::move(msg), respId };
          }
 
-         static Envelope makeBroadcast(const std::shared_ptr<User>& s, const std::string& msg, bool global = false)
+         static Envelope makeBroadcast(const std::shared_ptr<User>& s, std::string msg, bool global = false)
          {
-            return Envelope{ s, nullptr, msg, global ? (SeqId)EnvelopeFlags::GlobalBroadcast : 0 };
+            return Envelope{ s, nullptr, std::move(msg), global ? (SeqId)EnvelopeFlags::GlobalBroadcast : 0 };
          }
 
+         // assigned envelope always gets a new id
          Envelope& operator=(Envelope other)
          {
-            sender = other.sender;
-            receiver = other.receiver;
+            sender = std::move(other.sender);
+            receiver = std::move(other.receiver);
             posted = other.posted;
             executeAt = other.executeAt;
-            message = other.message;
+            message = std::move(other.message);
             id_ = 0;
             foreignId_ = other.foreignId_;
             responseId_ = other.responseId_;
@@ -153,16 +259,16 @@ namespace bs {
          std::shared_ptr<User>   receiver;
          TimeStamp   posted;
          TimeStamp   executeAt;
-         std::string message;
+         Payload     message;
 
       private:
          Envelope(const std::shared_ptr<User>& s, const std::shared_ptr<User>& r
-            , const std::string& msg, SeqId respId = 0)
-            : sender(s), receiver(r), message(msg), responseId_(respId)
+            , std::string msg, SeqId respId = 0)
+            : sender(s), receiver(r), message(std::move(msg)), responseId_(respId)
          {}
          Envelope(const std::shared_ptr<User>& s, const std::shared_ptr<User>& r
-            , const TimeStamp& execAt, const std::string& msg, SeqId respId = 0)
-            : sender(s), receiver(r), executeAt(execAt), message(msg)
+            , const TimeStamp& execAt, std::string msg, SeqId respId = 0)
+            : sender(s), receiver(r), executeAt(execAt), message(std::move(msg))
             , responseId_(respId)
          {}
 
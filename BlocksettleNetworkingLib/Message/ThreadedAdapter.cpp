@@ -19,6 +19,10 @@ ThreadedAdapter::ThreadedAdapter()
    processingThread_ = std::thread(&ThreadedAdapter::processingRoutine, this);
 }
 
+ThreadedAdapter::ThreadedAdapter(const std::shared_ptr<bs::Executor> &executor)
+   : strand_(bs::Strand::create(executor))
+{}
+
 ThreadedAdapter::~ThreadedAdapter() noexcept
 {
    stop();
@@ -39,8 +43,13 @@ bool bs::message::ThreadedAdapter::processBroadcast(const Envelope& env)
 void ThreadedAdapter::stop()
 {
    continueExecution_ = false;
-   decltype(pendingEnvelopes_) cleanQueue;
-   pendingEnvelopes_.swap(cleanQueue);
+   if (strand_) {
+      strand_->shutdown();
+   }
+   {
+      FastLock locker{ pendingEnvelopesLock_ };
+      pendingEnvelopes_.clear();
+   }
    pendingEnvelopesEvent_.SetEvent();
    if (processingThread_.joinable()) {
       processingThread_.join();
@@ -49,41 +58,74 @@ void ThreadedAdapter::stop()
 
 void ThreadedAdapter::processingRoutine()
 {
+   // reused between iterations to avoid reallocations
+   std::vector<Envelope> batch;
+   std::vector<Envelope> rejected;
+
    while (continueExecution_) {
       pendingEnvelopesEvent_.WaitForEvent();
 
       if (!continueExecution_) {
          break;
       }
+      processPending(batch, rejected);
+   }
+}
 
-      std::shared_ptr<Envelope> envelope;
-
-      {
-         FastLock locker{pendingEnvelopesLock_};
-
-         if (!pendingEnvelopes_.empty()) {
-            envelope = pendingEnvelopes_.front();
-            pendingEnvelopes_.pop();
-         }
+void ThreadedAdapter::processPending(std::vector<Envelope> &batch
+   , std::vector<Envelope> &rejected)
+{
+   ProcessingBatchMetrics::Clock::time_point firstQueued;
+   {
+      FastLock locker{pendingEnvelopesLock_};
+      pendingEnvelopes_.swap(batch);
+      firstQueued = batchMetrics_.takeFirstQueued();
+      batchPosted_ = false;
+      pendingEnvelopesEvent_.ResetEvent();
+   }
 
-         if (pendingEnvelopes_.empty()) {
-            pendingEnvelopesEvent_.ResetEvent();
-         }
+   const auto started = batchMetrics_.enabled()
+      ? ProcessingBatchMetrics::Clock::now() : ProcessingBatchMetrics::Clock::time_point{};
+   for (const auto &envelope : batch) {
+      if (!continueExecution_) {
+         break;
       }
-
-      if (envelope == nullptr) {
-         continue;
+      if (!processEnvelope(envelope)) {
+         rejected.emplace_back(envelope);
       }
-      if (!processEnvelope(*envelope)) {
-         FastLock locker{ pendingEnvelopesLock_ };
-         pendingEnvelopes_.emplace(envelope);
+   }
+   batchMetrics_.add(batch.size(), firstQueued, started);
+   batch.clear();
+
+   if (!rejected.empty()) {
+      // rejected envelopes are retried on next wakeup before newer ones
+      FastLock locker{ pendingEnvelopesLock_ };
+      for (auto &envelope : pendingEnvelopes_) {
+         rejected.emplace_back(std::move(envelope));
       }
+      pendingEnvelopes_.clear();
+      pendingEnvelopes_.swap(rejected);
    }
 }
 
 void ThreadedAdapter::SendEnvelopeToThread(const Envelope &envelope)
 {
-   FastLock locker{pendingEnvelopesLock_};
-   pendingEnvelopes_.emplace(std::make_shared<Envelope>(envelope));
-   pendingEnvelopesEvent_.SetEvent();
+   bool postToStrand = false;
+   {
+      FastLock locker{pendingEnvelopesLock_};
+      if (pendingEnvelopes_.empty()) {
+         batchMetrics_.markFirstQueued();
+      }
+      pendingEnvelopes_.emplace_back(envelope);
+      if (!strand_) {
+         pendingEnvelopesEvent_.SetEvent();
+      }
+      else if (!batchPosted_) {
+         batchPosted_ = true;
+         postToStrand = true;
+      }
+   }
+   if (postToStrand) {
+      strand_->post([this] { processPending(strandBatch_, strandRejected_); });
+   }
 }
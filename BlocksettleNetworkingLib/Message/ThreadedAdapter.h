@@ -12,18 +12,23 @@
 #define __MESSAGE_THREADED_ADAPTER_H__
 
 #include "Message/Adapter.h"
+#include "FastLock.h"
 #include "ManualResetEvent.h"
+#include "ProcessingThread.h"
 
 #include <atomic>
-#include <queue>
 #include <thread>
+#include <vector>
 
 namespace bs {
    namespace message {
+      // Envelopes are processed in batches on a dedicated thread, or on a strand
+      // of shared executor if constructed with one
       class ThreadedAdapter : public Adapter
       {
       public:
          ThreadedAdapter();
+         explicit ThreadedAdapter(const std::shared_ptr<bs::Executor> &);
          ~ThreadedAdapter() noexcept override;
 
          ThreadedAdapter(const ThreadedAdapter&) = delete;
@@ -35,20 +40,31 @@ namespace bs {
          bool process(const Envelope &) final;
          bool processBroadcast(const Envelope&) final;
 
+         void enableBatchStats(bool on = true) { batchMetrics_.enable(on); }
+         ProcessingBatchStats batchStats() const { return batchMetrics_.stats(); }
+         void resetBatchStats() { batchMetrics_.reset(); }
+
       protected:
          virtual bool processEnvelope(const Envelope &) = 0;
          void stop();
 
       private:
          void processingRoutine();
+         void processPending(std::vector<Envelope> &batch, std::vector<Envelope> &rejected);
          void SendEnvelopeToThread(const Envelope &envelope);
 
       private:
          std::thread processingThread_;
          std::atomic_bool                       continueExecution_{ true };
-         mutable std::atomic_flag               pendingEnvelopesLock_ = ATOMIC_FLAG_INIT;
+         mutable AdaptiveLock                   pendingEnvelopesLock_;
          ManualResetEvent                       pendingEnvelopesEvent_;
-         std::queue<std::shared_ptr<Envelope>>  pendingEnvelopes_;
+         std::vector<Envelope>                  pendingEnvelopes_;
+         ProcessingBatchMetrics                 batchMetrics_;
+
+         std::shared_ptr<bs::Strand>            strand_;
+         bool                                   batchPosted_{ false };  // guarded by pendingEnvelopesLock_
+         std::vector<Envelope>                  strandBatch_;
+         std::vector<Envelope>                  strandRejected_;
       };
    }
 }
@@ -0,0 +1,768 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#include "MuxConnection.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include "StringUtils.h"
+
+using namespace bs::network::mux;
+
+namespace {
+   // Frame layout: type (1 byte), channel id (4 bytes LE), flags (1 byte), payload
+   enum FrameType : uint8_t
+   {
+      Data = 1,
+      WindowUpdate = 2
+   };
+   constexpr uint8_t kFlagFin = 0x01;
+   constexpr size_t kHeaderSize = 6;
+
+   std::string makeFrame(FrameType type, ChannelId id, uint8_t flags
+      , const char *payload, size_t size)
+   {
+      std::string frame;
+      frame.reserve(kHeaderSize + size);
+      frame.push_back(static_cast<char>(type));
+      for (int i = 0; i < 4; ++i) {
+         frame.push_back(static_cast<char>((id >> (8 * i)) & 0xff));
+      }
+      frame.push_back(static_cast<char>(flags));
+      frame.append(payload, size);
+      return frame;
+   }
+
+   std::string makeWindowUpdate(ChannelId id, uint32_t increment)
+   {
+      char payload[4];
+      for (int i = 0; i < 4; ++i) {
+         payload[i] = static_cast<char>((increment >> (8 * i)) & 0xff);
+      }
+      return makeFrame(WindowUpdate, id, 0, payload, sizeof(payload));
+   }
+
+   uint32_t readUInt32(const char *ptr)
+   {
+      uint32_t result = 0;
+      for (int i = 0; i < 4; ++i) {
+         result |= static_cast<uint32_t>(static_cast<uint8_t>(ptr[i])) << (8 * i);
+      }
+      return result;
+   }
+}  // namespace
+
+
+Session::Session(const std::shared_ptr<spdlog::logger> &logger, const SessionConfig &config
+   , const SendCb &sendCb, const DataCb &dataCb)
+   : logger_(logger), config_(config), sendCb_(sendCb), dataCb_(dataCb)
+   , connSendWindow_(config.connectionWindow)
+{
+   if (config_.maxFrameSize == 0) {
+      throw std::invalid_argument("invalid max frame size");
+   }
+   if (config_.channels.count(0) > 0) {
+      throw std::invalid_argument("channel id 0 is reserved");
+   }
+   initChannels();
+}
+
+bool Session::send(ChannelId id, const std::string &data)
+{
+   if (id == 0) {
+      SPDLOG_LOGGER_ERROR(logger_, "channel id 0 is reserved");
+      return false;
+   }
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (failed_) {
+         return false;
+      }
+      auto ch = channel(id);
+      if (!ch) {
+         SPDLOG_LOGGER_ERROR(logger_, "unknown channel {}", id);
+         return false;
+      }
+      if (data.size() > ch->config.window) {
+         SPDLOG_LOGGER_ERROR(logger_, "message of {} bytes doesn't fit in window of channel {}"
+            , data.size(), id);
+         return false;
+      }
+      ch->outQueue.push_back(data);
+      ch->queuedBytes += data.size();
+      pump();
+   }
+   return flush();
+}
+
+bool Session::onFrame(const std::string &frame)
+{
+   if (isFailed()) {
+      return false;
+   }
+   if (!processFrame(frame)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      failed_ = true;
+      return false;
+   }
+   flush();
+   return true;
+}
+
+bool Session::processFrame(const std::string &frame)
+{
+   if (frame.size() < kHeaderSize) {
+      SPDLOG_LOGGER_ERROR(logger_, "frame is too short ({} bytes)", frame.size());
+      return false;
+   }
+   const auto type = static_cast<uint8_t>(frame[0]);
+   const auto id = readUInt32(frame.data() + 1);
+   const auto flags = static_cast<uint8_t>(frame[5]);
+   const size_t size = frame.size() - kHeaderSize;
+
+   switch (type) {
+   case WindowUpdate: {
+      if (size != sizeof(uint32_t)) {
+         SPDLOG_LOGGER_ERROR(logger_, "invalid window update size {}", size);
+         return false;
+      }
+      const auto increment = readUInt32(frame.data() + kHeaderSize);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (id == 0) {
+         connSendWindow_ += increment;
+      }
+      else {
+         auto ch = channel(id);
+         if (!ch) {
+            SPDLOG_LOGGER_ERROR(logger_, "window update for unknown channel {}", id);
+            return false;
+         }
+         ch->sendWindow += increment;
+      }
+      pump();
+      return true;
+   }
+
+   case Data: {
+      if (id == 0) {
+         SPDLOG_LOGGER_ERROR(logger_, "data on reserved channel");
+         return false;
+      }
+      std::string message;
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         auto ch = channel(id);
+         if (!ch) {
+            SPDLOG_LOGGER_ERROR(logger_, "data for unknown channel {}", id);
+            return false;
+         }
+         // channel window also caps the size of a message being reassembled
+         if ((ch->received + ch->consumed + size > ch->config.window)
+            || (connReceived_ + connConsumed_ + size > config_.connectionWindow)) {
+            SPDLOG_LOGGER_ERROR(logger_, "peer exceeded receive window on channel {}", id);
+            return false;
+         }
+         ch->received += size;
+         connReceived_ += size;
+         ch->partial.append(frame.data() + kHeaderSize, size);
+
+         // data has left underlying connection, channel credits wait for delivery
+         grantConnCredits(size);
+         if (!(flags & kFlagFin)) {
+            return true;
+         }
+         message = std::move(ch->partial);
+         ch->partial.clear();
+      }
+
+      if (dataCb_) {
+         dataCb_(id, message);
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      grantCredits(id, message.size());
+      return true;
+   }
+
+   default:
+      SPDLOG_LOGGER_ERROR(logger_, "unknown frame type {}", type);
+      return false;
+   }
+}
+
+void Session::reset()
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   initChannels();
+   connSendWindow_ = config_.connectionWindow;
+   connReceived_ = 0;
+   connConsumed_ = 0;
+   std::fill(std::begin(lastSent_), std::end(lastSent_), 0);
+   failed_ = false;
+   outFrames_.clear();
+}
+
+bool Session::hasChannel(ChannelId id) const
+{
+   return (config_.channels.count(id) > 0);
+}
+
+bool Session::isFailed() const
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   return failed_;
+}
+
+size_t Session::queuedBytes(ChannelId id) const
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   const auto it = channels_.find(id);
+   return (it == channels_.end()) ? 0 : it->second.queuedBytes;
+}
+
+// should be called under mutex_
+void Session::initChannels()
+{
+   channels_.clear();
+   for (const auto &item : config_.channels) {
+      Channel ch;
+      ch.config = item.second;
+      ch.sendWindow = ch.config.window;
+      channels_.emplace(item.first, std::move(ch));
+   }
+}
+
+Session::Channel *Session::channel(ChannelId id)
+{
+   const auto it = channels_.find(id);
+   return (it == channels_.end()) ? nullptr : &it->second;
+}
+
+Session::Channel *Session::nextChannel(ChannelId &id)
+{
+   const auto isReady = [this](const Channel &ch) {
+      if (ch.outQueue.empty()) {
+         return false;
+      }
+      if (ch.outQueue.front().size() == ch.outOffset) {
+         return true;   // empty message doesn't need credits
+      }
+      return (ch.sendWindow > 0) && (connSendWindow_ > 0);
+   };
+
+   for (uint8_t prio = 0; prio < 3; ++prio) {
+      // start after last served channel of the same priority
+      const auto start = channels_.upper_bound(lastSent_[prio]);
+      for (size_t i = 0; i < 2; ++i) {
+         const auto from = (i == 0) ? start : channels_.begin();
+         const auto to = (i == 0) ? channels_.end() : start;
+         for (auto it = from; it != to; ++it) {
+            if ((static_cast<uint8_t>(it->second.config.priority) == prio) && isReady(it->second)) {
+               id = it->first;
+               return &it->second;
+            }
+         }
+      }
+   }
+   return nullptr;
+}
+
+// should be called under mutex_
+void Session::pump()
+{
+   ChannelId id = 0;
+   while (auto ch = nextChannel(id)) {
+      const auto &message = ch->outQueue.front();
+      const size_t remaining = message.size() - ch->outOffset;
+      const size_t chunk = std::min<size_t>({ remaining, config_.maxFrameSize
+         , static_cast<size_t>(std::max<int64_t>(ch->sendWindow, 0))
+         , static_cast<size_t>(std::max<int64_t>(connSendWindow_, 0)) });
+      const bool fin = (chunk == remaining);
+
+      outFrames_.push_back(makeFrame(Data, id, fin ? kFlagFin : 0
+         , message.data() + ch->outOffset, chunk));
+      ch->sendWindow -= chunk;
+      connSendWindow_ -= chunk;
+      ch->queuedBytes -= chunk;
+      ch->outOffset += chunk;
+      lastSent_[static_cast<uint8_t>(ch->config.priority)] = id;
+      if (fin) {
+         ch->outQueue.pop_front();
+         ch->outOffset = 0;
+      }
+   }
+}
+
+// should be called under mutex_
+void Session::grantCredits(ChannelId id, size_t bytes)
+{
+   auto ch = channel(id);
+   if (!ch) {
+      return;
+   }
+   bytes = std::min<size_t>(bytes, ch->received);   // could be reset meanwhile
+   ch->received -= bytes;
+   ch->consumed += bytes;
+
+   // credits are returned in batches to keep the number of updates low
+   if (ch->consumed >= ch->config.window / 2) {
+      outFrames_.push_back(makeWindowUpdate(id, static_cast<uint32_t>(ch->consumed)));
+      ch->consumed = 0;
+   }
+}
+
+// should be called under mutex_
+void Session::grantConnCredits(size_t bytes)
+{
+   bytes = std::min<size_t>(bytes, connReceived_);
+   connReceived_ -= bytes;
+   connConsumed_ += bytes;
+   if (connConsumed_ >= config_.connectionWindow / 2) {
+      outFrames_.push_back(makeWindowUpdate(0, static_cast<uint32_t>(connConsumed_)));
+      connConsumed_ = 0;
+   }
+}
+
+bool Session::flush()
+{
+   std::vector<std::string> frames;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (flushing_) {
+         return true;   // current flushing thread will send our frames in order
+      }
+      flushing_ = true;
+   }
+   bool result = true;
+   while (true) {
+      frames.clear();
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         if (outFrames_.empty()) {
+            flushing_ = false;
+            break;
+         }
+         frames.swap(outFrames_);
+      }
+      for (const auto &frame : frames) {
+         if (!sendCb_(frame)) {
+            SPDLOG_LOGGER_ERROR(logger_, "failed to send mux frame");
+            result = false;
+         }
+      }
+   }
+   return result;
+}
+
+
+namespace bs {
+   namespace network {
+      namespace mux {
+
+         class ChannelDataConnection : public DataConnection
+         {
+         public:
+            ChannelDataConnection(MuxDataConnection *owner, ChannelId id)
+               : owner_(owner), id_(id)
+            {}
+            ~ChannelDataConnection() noexcept override
+            {
+               closeConnection();
+            }
+
+            bool send(const std::string &data) override
+            {
+               return owner_->send(id_, data);
+            }
+
+            // host and port are ignored - underlying connection is opened by owner
+            bool openConnection(const std::string &, const std::string &
+               , DataConnectionListener *listener) override
+            {
+               setListener(listener);
+               owner_->attach(id_, this);
+               if (owner_->isActive()) {
+                  notifyOnConnected();
+               }
+               return true;
+            }
+
+            bool closeConnection() override
+            {
+               owner_->detach(id_);
+               detachFromListener();
+               return true;
+            }
+
+            bool isActive() const override { return owner_->isActive(); }
+
+         private:
+            friend class MuxDataConnection;
+
+            MuxDataConnection *owner_;
+            const ChannelId   id_;
+         };
+
+
+         class ChannelServerConnection : public ServerConnection
+         {
+         public:
+            ChannelServerConnection(MuxServerConnection *owner, ChannelId id)
+               : owner_(owner), id_(id)
+            {}
+            ~ChannelServerConnection() noexcept override
+            {
+               owner_->detach(id_);
+            }
+
+            // host and port are ignored - underlying connection is bound by owner
+            bool BindConnection(const std::string &, const std::string &
+               , ServerConnectionListener *listener) override
+            {
+               owner_->attach(id_, listener);
+               return true;
+            }
+
+            bool SendDataToClient(const std::string &clientId, const std::string &data) override
+            {
+               return owner_->send(id_, clientId, data);
+            }
+
+            bool SendDataToAllClients(const std::string &data) override
+            {
+               return owner_->sendToAll(id_, data);
+            }
+
+            bool timer(std::chrono::milliseconds timeout, TimerCallback callback) override
+            {
+               return owner_->server_->timer(timeout, std::move(callback));
+            }
+
+            // closes client's underlying connection, so all its channels
+            bool closeClient(const std::string &clientId) override
+            {
+               return owner_->closeClient(clientId);
+            }
+
+         private:
+            MuxServerConnection *owner_;
+            const ChannelId   id_;
+         };
+
+      }  // namespace mux
+   }  // namespace network
+}  // namespace bs
+
+
+MuxDataConnection::MuxDataConnection(const std::shared_ptr<spdlog::logger> &logger
+   , std::unique_ptr<DataConnection> conn, const SessionConfig &config)
+   : logger_(logger)
+   , conn_(std::move(conn))
+   , session_(logger, config
+      , [this](const std::string &frame) { return conn_->send(frame); }
+      , [this](ChannelId id, const std::string &data)
+   {
+      ChannelDataConnection *channel = nullptr;
+      {
+         std::lock_guard<std::mutex> lock(channelsMutex_);
+         const auto it = channels_.find(id);
+         if (it != channels_.end()) {
+            channel = it->second;
+         }
+      }
+      if (!channel) {
+         SPDLOG_LOGGER_WARN(logger_, "dropping {} bytes for unattached channel {}", data.size(), id);
+         return;
+      }
+      channel->notifyOnData(data);
+   })
+{
+   assert(conn_);
+}
+
+MuxDataConnection::~MuxDataConnection() noexcept
+{
+   closeConnection();
+}
+
+bool MuxDataConnection::openConnection(const std::string &host, const std::string &port)
+{
+   session_.reset();
+   return conn_->openConnection(host, port, this);
+}
+
+bool MuxDataConnection::closeConnection()
+{
+   connected_ = false;
+   return conn_->closeConnection();
+}
+
+bool MuxDataConnection::isActive() const
+{
+   return connected_ && conn_->isActive();
+}
+
+std::unique_ptr<DataConnection> MuxDataConnection::channel(ChannelId id)
+{
+   if (!session_.hasChannel(id)) {
+      throw std::invalid_argument("channel is not configured");
+   }
+   return std::make_unique<ChannelDataConnection>(this, id);
+}
+
+void MuxDataConnection::attach(ChannelId id, ChannelDataConnection *channel)
+{
+   std::lock_guard<std::mutex> lock(channelsMutex_);
+   channels_[id] = channel;
+}
+
+void MuxDataConnection::detach(ChannelId id)
+{
+   std::lock_guard<std::mutex> lock(channelsMutex_);
+   channels_.erase(id);
+}
+
+bool MuxDataConnection::send(ChannelId id, const std::string &data)
+{
+   return session_.send(id, data);
+}
+
+template<class F> void MuxDataConnection::forEachChannel(const F &f)
+{
+   std::vector<ChannelDataConnection *> channels;
+   {
+      std::lock_guard<std::mutex> lock(channelsMutex_);
+      channels.reserve(channels_.size());
+      for (const auto &item : channels_) {
+         channels.push_back(item.second);
+      }
+   }
+   for (const auto &channel : channels) {
+      f(channel);
+   }
+}
+
+void MuxDataConnection::OnDataReceived(const std::string &data)
+{
+   if (session_.isFailed()) {
+      return;  // dropped until reconnect, error is already reported
+   }
+   if (!session_.onFrame(data)) {
+      SPDLOG_LOGGER_ERROR(logger_, "invalid mux frame received");
+      forEachChannel([](ChannelDataConnection *channel) {
+         channel->notifyOnError(ProtocolViolation);
+      });
+   }
+}
+
+void MuxDataConnection::OnConnected()
+{
+   connected_ = true;
+   forEachChannel([](ChannelDataConnection *channel) {
+      channel->notifyOnConnected();
+   });
+}
+
+void MuxDataConnection::OnDisconnected()
+{
+   connected_ = false;
+   session_.reset();
+   forEachChannel([](ChannelDataConnection *channel) {
+      channel->notifyOnDisconnected();
+   });
+}
+
+void MuxDataConnection::OnError(DataConnectionError errorCode)
+{
+   forEachChannel([errorCode](ChannelDataConnection *channel) {
+      channel->notifyOnError(errorCode);
+   });
+}
+
+
+MuxServerConnection::MuxServerConnection(const std::shared_ptr<spdlog::logger> &logger
+   , std::unique_ptr<ServerConnection> server, const SessionConfig &config)
+   : logger_(logger)
+   , server_(std::move(server))
+   , config_(config)
+{
+   assert(server_);
+}
+
+MuxServerConnection::~MuxServerConnection() noexcept
+{
+   server_.reset();
+}
+
+bool MuxServerConnection::BindConnection(const std::string &host, const std::string &port)
+{
+   return server_->BindConnection(host, port, this);
+}
+
+std::unique_ptr<ServerConnection> MuxServerConnection::channel(ChannelId id)
+{
+   if (config_.channels.count(id) == 0) {
+      throw std::invalid_argument("channel is not configured");
+   }
+   return std::make_unique<ChannelServerConnection>(this, id);
+}
+
+void MuxServerConnection::attach(ChannelId id, ServerConnectionListener *listener)
+{
+   // channel bound late gets already connected clients
+   std::map<std::string, Details> clients;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      listeners_[id] = listener;
+      clients = clientDetails_;
+   }
+   for (const auto &client : clients) {
+      listener->OnClientConnected(client.first, client.second);
+   }
+}
+
+void MuxServerConnection::detach(ChannelId id)
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   listeners_.erase(id);
+}
+
+std::shared_ptr<Session> MuxServerConnection::session(const std::string &clientId) const
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   const auto it = sessions_.find(clientId);
+   return (it == sessions_.end()) ? nullptr : it->second;
+}
+
+bool MuxServerConnection::send(ChannelId id, const std::string &clientId, const std::string &data)
+{
+   const auto clientSession = session(clientId);
+   if (!clientSession) {
+      SPDLOG_LOGGER_ERROR(logger_, "unknown client {}", bs::toHex(clientId));
+      return false;
+   }
+   return clientSession->send(id, data);
+}
+
+bool MuxServerConnection::sendToAll(ChannelId id, const std::string &data)
+{
+   std::vector<std::shared_ptr<Session>> sessions;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sessions.reserve(sessions_.size());
+      for (const auto &item : sessions_) {
+         sessions.push_back(item.second);
+      }
+   }
+   bool result = true;
+   for (const auto &clientSession : sessions) {
+      if (!clientSession->send(id, data)) {
+         result = false;
+      }
+   }
+   return result;
+}
+
+bool MuxServerConnection::closeClient(const std::string &clientId)
+{
+   return server_->closeClient(clientId);
+}
+
+std::vector<ServerConnectionListener *> MuxServerConnection::listeners() const
+{
+   std::vector<ServerConnectionListener *> result;
+   result.reserve(listeners_.size());
+   for (const auto &item : listeners_) {
+      result.push_back(item.second);
+   }
+   return result;
+}
+
+void MuxServerConnection::OnDataFromClient(const std::string &clientId, const std::string &data)
+{
+   const auto clientSession = session(clientId);
+   if (!clientSession) {
+      SPDLOG_LOGGER_ERROR(logger_, "data from unknown client {}", bs::toHex(clientId));
+      return;
+   }
+   if (clientSession->isFailed()) {
+      return;  // being closed
+   }
+   if (!clientSession->onFrame(data)) {
+      SPDLOG_LOGGER_ERROR(logger_, "invalid mux frame from client {}", bs::toHex(clientId));
+      server_->closeClient(clientId);
+   }
+}
+
+void MuxServerConnection::OnClientConnected(const std::string &clientId, const Details &details)
+{
+   auto clientSession = std::make_shared<Session>(logger_, config_
+      , [this, clientId](const std::string &frame) {
+         return server_->SendDataToClient(clientId, frame);
+      }
+      , [this, clientId](ChannelId id, const std::string &data) {
+         ServerConnectionListener *listener = nullptr;
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto it = listeners_.find(id);
+            if (it != listeners_.end()) {
+               listener = it->second;
+            }
+         }
+         if (!listener) {
+            SPDLOG_LOGGER_WARN(logger_, "dropping {} bytes for unbound channel {}", data.size(), id);
+            return;
+         }
+         listener->OnDataFromClient(clientId, data);
+      });
+   // listeners are taken together with the change, so a channel bound
+   // meanwhile gets each event exactly once (see attach())
+   std::vector<ServerConnectionListener *> listeners;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sessions_[clientId] = std::move(clientSession);
+      clientDetails_[clientId] = details;
+      listeners = this->listeners();
+   }
+   for (const auto &listener : listeners) {
+      listener->OnClientConnected(clientId, details);
+   }
+}
+
+void MuxServerConnection::OnClientDisconnected(const std::string &clientId)
+{
+   std::vector<ServerConnectionListener *> listeners;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sessions_.erase(clientId);
+      clientDetails_.erase(clientId);
+      listeners = this->listeners();
+   }
+   for (const auto &listener : listeners) {
+      listener->OnClientDisconnected(clientId);
+   }
+}
+
+void MuxServerConnection::onClientError(const std::string &clientId, ClientError error
+   , const Details &details)
+{
+   std::vector<ServerConnectionListener *> listeners;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sessions_.erase(clientId);
+      clientDetails_.erase(clientId);
+      listeners = this->listeners();
+   }
+   for (const auto &listener : listeners) {
+      listener->onClientError(clientId, error, details);
+   }
+}
@@ -0,0 +1,235 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#ifndef MUX_CONNECTION_H
+#define MUX_CONNECTION_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DataConnection.h"
+#include "ServerConnection.h"
+
+// Multiplexes several logical channels over one connection (e.g. one
+// Bip15xDataConnection/Bip15xServerConnection pair, so BIP150/151 handshake
+// is done only once).
+//
+// Messages are split into frames of limited size, so big transfers on one
+// channel don't block others. Next frame is taken from the highest priority
+// channel that has data and send credits, channels of the same priority are
+// served round-robin. Each channel has its own receive window, peer returns
+// credits once a whole message is delivered to channel listener, so a message
+// must fit in the window and buffered data is bounded by it. Connection-level
+// window limits amount of data queued in underlying connection, so high
+// priority frames don't wait behind a lot of bulk data there.
+//
+// Channel ids and windows must be configured the same way on both sides,
+// frames for other channels are a protocol violation and drop the session.
+
+namespace spdlog {
+   class logger;
+}
+
+namespace bs {
+   namespace network {
+      namespace mux {
+
+         using ChannelId = uint32_t;
+
+         enum class Priority : uint8_t
+         {
+            High = 0,
+            Normal = 1,
+            Bulk = 2
+         };
+
+         struct ChannelConfig
+         {
+            Priority priority{ Priority::Normal };
+            uint32_t window{ 256 * 1024 };
+         };
+
+         struct SessionConfig
+         {
+            uint32_t connectionWindow{ 1024 * 1024 };
+            uint32_t maxFrameSize{ 16 * 1024 };
+            std::map<ChannelId, ChannelConfig> channels;   // id 0 is reserved
+         };
+
+         // Protocol state for one peer. Thread-safe: send() could be called from
+         // any thread, onFrame() should be called from connection's reading thread.
+         class Session
+         {
+         public:
+            using SendCb = std::function<bool(const std::string &frame)>;
+            using DataCb = std::function<void(ChannelId, const std::string &data)>;
+
+            Session(const std::shared_ptr<spdlog::logger> &, const SessionConfig &
+               , const SendCb &, const DataCb &);
+
+            Session(const Session&) = delete;
+            Session& operator = (const Session&) = delete;
+
+            // Queues message - it's sent as soon as channel has credits.
+            // Fails for unknown channels and messages bigger than channel window.
+            bool send(ChannelId, const std::string &data);
+
+            // Returns false on protocol violation, the session is failed then
+            // and all next frames are rejected until reset()
+            bool onFrame(const std::string &frame);
+
+            // Drops all queued and partially received data, restores windows
+            void reset();
+
+            bool hasChannel(ChannelId) const;
+            bool isFailed() const;
+            size_t queuedBytes(ChannelId) const;
+
+         private:
+            struct Channel
+            {
+               ChannelConfig  config;
+
+               std::deque<std::string> outQueue;
+               size_t   outOffset{ 0 };   // sent part of outQueue.front()
+               size_t   queuedBytes{ 0 };
+               int64_t  sendWindow{ 0 };
+
+               std::string partial;       // incoming message being reassembled
+               uint64_t received{ 0 };    // not yet credited back
+               uint64_t consumed{ 0 };    // ready to be credited back
+            };
+
+            void initChannels();
+            Channel *channel(ChannelId);
+            Channel *nextChannel(ChannelId &);
+            bool processFrame(const std::string &frame);
+            void pump();
+            void grantCredits(ChannelId, size_t bytes);
+            void grantConnCredits(size_t bytes);
+            bool flush();
+
+         private:
+            std::shared_ptr<spdlog::logger>  logger_;
+            const SessionConfig  config_;
+            const SendCb   sendCb_;
+            const DataCb   dataCb_;
+
+            mutable std::mutex   mutex_;
+            std::map<ChannelId, Channel>  channels_;
+            int64_t  connSendWindow_;
+            uint64_t connReceived_{ 0 };
+            uint64_t connConsumed_{ 0 };
+            ChannelId   lastSent_[3]{};   // round-robin position per priority
+            bool     failed_{ false };
+
+            // frames are sent outside of mutex_ by one flushing thread at a time
+            std::vector<std::string>   outFrames_;
+            bool     flushing_{ false };
+         };
+
+
+         class ChannelDataConnection;
+
+         // Client side. Owns underlying connection and gives out channels
+         // that could be used as ordinary DataConnection. Must outlive them.
+         class MuxDataConnection : public DataConnectionListener
+         {
+         public:
+            MuxDataConnection(const std::shared_ptr<spdlog::logger> &
+               , std::unique_ptr<DataConnection>, const SessionConfig & = {});
+            ~MuxDataConnection() noexcept override;
+
+            bool openConnection(const std::string &host, const std::string &port);
+            bool closeConnection();
+            bool isActive() const;
+
+            std::unique_ptr<DataConnection> channel(ChannelId);
+
+         private:
+            friend class ChannelDataConnection;
+
+            void attach(ChannelId, ChannelDataConnection *);
+            void detach(ChannelId);
+            bool send(ChannelId, const std::string &);
+
+            void OnDataReceived(const std::string &) override;
+            void OnConnected() override;
+            void OnDisconnected() override;
+            void OnError(DataConnectionError) override;
+
+            template<class F> void forEachChannel(const F &);
+
+         private:
+            std::shared_ptr<spdlog::logger>  logger_;
+            std::unique_ptr<DataConnection>  conn_;
+            Session  session_;
+            std::atomic_bool  connected_{ false };
+
+            std::mutex  channelsMutex_;
+            std::map<ChannelId, ChannelDataConnection *> channels_;
+         };
+
+
+         class ChannelServerConnection;
+
+         // Server side. Keeps one Session per client of underlying connection.
+         // Channel listeners get connect/disconnect events for all clients.
+         class MuxServerConnection : public ServerConnectionListener
+         {
+         public:
+            MuxServerConnection(const std::shared_ptr<spdlog::logger> &
+               , std::unique_ptr<ServerConnection>, const SessionConfig & = {});
+            ~MuxServerConnection() noexcept override;
+
+            bool BindConnection(const std::string &host, const std::string &port);
+
+            std::unique_ptr<ServerConnection> channel(ChannelId);
+
+         private:
+            friend class ChannelServerConnection;
+
+            void attach(ChannelId, ServerConnectionListener *);
+            void detach(ChannelId);
+            bool send(ChannelId, const std::string &clientId, const std::string &);
+            bool sendToAll(ChannelId, const std::string &);
+            bool closeClient(const std::string &clientId);
+            std::shared_ptr<Session> session(const std::string &clientId) const;
+
+            void OnDataFromClient(const std::string &clientId, const std::string &) override;
+            void OnClientConnected(const std::string &clientId, const Details &) override;
+            void OnClientDisconnected(const std::string &clientId) override;
+            void onClientError(const std::string &clientId, ClientError, const Details &) override;
+
+            // should be called under mutex_
+            std::vector<ServerConnectionListener *> listeners() const;
+
+         private:
+            std::shared_ptr<spdlog::logger>     logger_;
+            std::unique_ptr<ServerConnection>   server_;
+            const SessionConfig  config_;
+
+            mutable std::mutex   mutex_;
+            std::map<std::string, std::shared_ptr<Session>> sessions_;
+            std::map<std::string, Details>   clientDetails_;
+            std::map<ChannelId, ServerConnectionListener *> listeners_;
+         };
+
+      }  // namespace mux
+   }  // namespace network
+}  // namespace bs
+
+#endif // MUX_CONNECTION_H
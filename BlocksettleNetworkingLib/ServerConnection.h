@@ -36,6 +36,12 @@ public:
    virtual bool SendDataToClient(const std::string& clientId, const std::string& data) = 0;
    virtual bool SendDataToAllClients(const std::string&) { return false; }
 
+   // Override if data can be queued without converting it to string first
+   virtual bool SendDataSliceToClient(const std::string& clientId, const bs::network::DataSlice& data)
+   {
+      return SendDataToClient(clientId, data.toString());
+   }
+
    // Execute callback after timeout on listening thread
    using TimerCallback = std::function<void()>;
    virtual bool timer(std::chrono::milliseconds /*timeout*/, TimerCallback /*callback*/) { return false; }
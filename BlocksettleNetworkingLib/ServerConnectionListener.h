@@ -13,6 +13,7 @@
 
 #include <map>
 #include <string>
+#include "DataSlice.h"
 
 class ServerConnectionListener
 {
@@ -22,6 +23,8 @@ public:
       // Reported when client do not have valid credentials (unknown public key)
       HandshakeFailed = 1,
       Timeout = 2,
+      // Reported when client doesn't ack sent data fast enough and its send buffer limit is reached
+      BufferOverflow = 3,
    };
 
    enum class Detail
@@ -42,6 +45,11 @@ public:
 
 public:
    virtual void OnDataFromClient(const std::string& clientId, const std::string& data) = 0;
+   // Zero-copy variant used by transports that support it. Default copies data.
+   virtual void OnDataSliceFromClient(const std::string &clientId, const bs::network::DataSlice &data)
+   {
+      OnDataFromClient(clientId, data.toString());
+   }
 
    virtual void OnClientConnected(const std::string &clientId, const Details &details) = 0;
    virtual void OnClientDisconnected(const std::string& clientId) = 0;
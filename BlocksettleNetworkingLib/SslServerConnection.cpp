@@ -292,7 +292,7 @@ std::string SslServerConnection::nextClientId()
 
 bool SslServerConnection::SendDataToClient(const std::string &clientId, const std::string &data)
 {
-   WsServerDataToSend toSend{clientId, WsRawPacket(data)};
+   WsServerDataToSend toSend{clientId, WsSharedPacket(WsRawPacket(data))};
    {
       std::lock_guard<std::recursive_mutex> lock(mutex_);
       packets_.push(std::move(toSend));
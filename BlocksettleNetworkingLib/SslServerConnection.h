@@ -78,14 +78,14 @@ private:
    struct WsServerDataToSend
    {
       std::string clientId;
-      bs::network::WsRawPacket packet;
+      bs::network::WsSharedPacket packet;
    };
 
    struct WsServerClientData
    {
       std::string clientId;
       lws *wsi{};
-      std::queue<bs::network::WsRawPacket> packets;
+      std::queue<bs::network::WsSharedPacket> packets;   // broadcasts share one buffer
       std::string currFragment;
    };
 
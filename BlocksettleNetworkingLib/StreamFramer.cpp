@@ -0,0 +1,162 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#include "StreamFramer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace bs::network;
+
+DelimitedFrameParser::DelimitedFrameParser(const std::string &marker)
+   : marker_(marker)
+{
+   if (marker_.empty()) {
+      throw std::invalid_argument("empty frame marker");
+   }
+}
+
+StreamFrameParser::Status DelimitedFrameParser::parse(std::string_view data, Frame &frame)
+{
+   const auto pos = data.find(marker_, scanned_);
+   if (pos == std::string_view::npos) {
+      // marker could be split between chunks
+      if (data.size() >= marker_.size()) {
+         scanned_ = data.size() - marker_.size() + 1;
+      }
+      return Status::Incomplete;
+   }
+   frame = { 0, pos, pos + marker_.size() };
+   return Status::Complete;
+}
+
+
+VarintFrameParser::VarintFrameParser(size_t maxPrefixBytes)
+   : maxPrefixBytes_(maxPrefixBytes)
+{}
+
+StreamFrameParser::Status VarintFrameParser::parse(std::string_view data, Frame &frame)
+{
+   size_t size = 0;
+   for (size_t i = 0; i < maxPrefixBytes_; ++i) {
+      if (i >= data.size()) {
+         return Status::Incomplete;
+      }
+      const auto byte = static_cast<uint8_t>(data[i]);
+      size |= static_cast<size_t>(byte & 0x7f) << (7 * i);
+      if (!(byte & 0x80)) {
+         const size_t prefixSize = i + 1;
+         if (data.size() - prefixSize < size) {
+            return Status::Incomplete;
+         }
+         frame = { prefixSize, size, prefixSize + size };
+         return Status::Complete;
+      }
+   }
+   return Status::Invalid;
+}
+
+std::string VarintFrameParser::encodePrefix(size_t size, size_t maxPrefixBytes)
+{
+   std::string result;
+   do {
+      if (result.size() == maxPrefixBytes) {
+         return {};
+      }
+      auto byte = static_cast<uint8_t>(size & 0x7f);
+      size = size >> 7;
+      if (size != 0) {
+         byte |= 0x80;
+      }
+      result.push_back(static_cast<char>(byte));
+   } while (size != 0);
+   return result;
+}
+
+
+StreamFramer::StreamFramer(std::unique_ptr<StreamFrameParser> parser)
+   : parser_(std::move(parser))
+{
+   if (!parser_) {
+      throw std::invalid_argument("frame parser is not set");
+   }
+}
+
+bool StreamFramer::process(std::string_view chunk, const FrameCb &cb)
+{
+   if (pendingSize() == 0) {
+      const auto consumed = processFrames(chunk, cb);
+      if (consumed == std::string_view::npos) {
+         reset();
+         return false;
+      }
+      append(chunk.substr(consumed));
+      return true;
+   }
+
+   append(chunk);
+   const auto consumed = processFrames(std::string_view(buffer_.data() + begin_, pendingSize()), cb);
+   if (consumed == std::string_view::npos) {
+      reset();
+      return false;
+   }
+   begin_ += consumed;
+   if (begin_ == end_) {
+      begin_ = end_ = 0;
+   }
+   return true;
+}
+
+void StreamFramer::reset()
+{
+   std::vector<char>().swap(buffer_);
+   begin_ = end_ = 0;
+   parser_->reset();
+}
+
+size_t StreamFramer::processFrames(std::string_view data, const FrameCb &cb)
+{
+   size_t offset = 0;
+   while (offset < data.size()) {
+      StreamFrameParser::Frame frame;
+      switch (parser_->parse(data.substr(offset), frame)) {
+      case StreamFrameParser::Status::Incomplete:
+         return offset;
+      case StreamFrameParser::Status::Invalid:
+         return std::string_view::npos;
+      case StreamFrameParser::Status::Complete:
+         parser_->reset();
+         cb(data.substr(offset + frame.payloadOffset, frame.payloadSize));
+         offset += frame.frameSize;
+         break;
+      }
+   }
+   return offset;
+}
+
+void StreamFramer::append(std::string_view data)
+{
+   if (data.empty()) {
+      return;
+   }
+   if (buffer_.size() - end_ < data.size()) {
+      if (begin_ > 0) {
+         std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+         end_ -= begin_;
+         begin_ = 0;
+      }
+      if (buffer_.size() - end_ < data.size()) {
+         buffer_.resize(std::max(buffer_.size() * 2, end_ + data.size()));
+      }
+   }
+   std::memcpy(buffer_.data() + end_, data.data(), data.size());
+   end_ += data.size();
+}
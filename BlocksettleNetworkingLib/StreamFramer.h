@@ -0,0 +1,108 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#ifndef STREAM_FRAMER_H
+#define STREAM_FRAMER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bs {
+   namespace network {
+
+      // Finds frame boundaries in a byte stream. parse() is always called with
+      // data starting at frame start - after Incomplete it's called again
+      // with the same start and more data appended.
+      class StreamFrameParser
+      {
+      public:
+         enum class Status
+         {
+            Incomplete,
+            Complete,
+            Invalid
+         };
+         struct Frame
+         {
+            size_t payloadOffset;
+            size_t payloadSize;
+            size_t frameSize;    // bytes consumed from the stream
+         };
+
+         virtual ~StreamFrameParser() = default;
+         virtual Status parse(std::string_view data, Frame &) = 0;
+         virtual void reset() {}
+      };
+
+      // Frames are terminated with marker (e.g. Genoa's "\r\n\r\n")
+      class DelimitedFrameParser : public StreamFrameParser
+      {
+      public:
+         explicit DelimitedFrameParser(const std::string &marker);
+         Status parse(std::string_view data, Frame &) override;
+         void reset() override { scanned_ = 0; }
+
+      private:
+         const std::string marker_;
+         size_t   scanned_{ 0 };  // no marker starts before this offset
+      };
+
+      // Frames are prefixed with little-endian base-128 payload size
+      // (7 bits per byte, high bit set if more bytes follow) as used by Celer
+      class VarintFrameParser : public StreamFrameParser
+      {
+      public:
+         explicit VarintFrameParser(size_t maxPrefixBytes = 4);
+         Status parse(std::string_view data, Frame &) override;
+
+         // Returns prefix for given payload size, empty if it doesn't fit
+         static std::string encodePrefix(size_t size, size_t maxPrefixBytes = 4);
+
+      private:
+         const size_t maxPrefixBytes_;
+      };
+
+      // Reassembles frames from arbitrarily fragmented stream chunks.
+      // Frames that are complete within an incoming chunk are parsed straight
+      // from it, only incomplete tail is kept in reassembly buffer. The buffer
+      // is compacted in place instead of being reallocated on each chunk.
+      class StreamFramer
+      {
+      public:
+         // frame view is valid only during the callback
+         using FrameCb = std::function<void(std::string_view)>;
+
+         explicit StreamFramer(std::unique_ptr<StreamFrameParser>);
+
+         // Returns false if stream is malformed - pending data is dropped then
+         bool process(std::string_view chunk, const FrameCb &);
+
+         size_t pendingSize() const { return end_ - begin_; }
+         void reset();
+
+      private:
+         // returns number of bytes consumed from data, or npos if it's invalid
+         size_t processFrames(std::string_view data, const FrameCb &);
+         void append(std::string_view);
+
+      private:
+         std::unique_ptr<StreamFrameParser>  parser_;
+         std::vector<char> buffer_;
+         size_t   begin_{ 0 };
+         size_t   end_{ 0 };
+      };
+
+   }  // namespace network
+}  // namespace bs
+
+#endif // STREAM_FRAMER_H
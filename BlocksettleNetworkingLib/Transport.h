@@ -13,7 +13,9 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 #include "BinaryData.h"
+#include "DataSlice.h"
 #include "DataConnectionListener.h"
 #include "ServerConnectionListener.h"
 
@@ -40,12 +42,17 @@ namespace bs {
          using NotifyDataCb = std::function<void(const std::string &)>;
          void setNotifyDataCb(const NotifyDataCb &cb) { notifyDataCb_ = cb; }
 
+         // Used instead of NotifyDataCb if set
+         using NotifyDataSliceCb = std::function<void(const DataSlice &)>;
+         void setNotifyDataSliceCb(const NotifyDataSliceCb &cb) { notifyDataSliceCb_ = cb; }
+
          using SocketErrorCb = std::function<void(DataConnectionListener::DataConnectionError)>;
          void setSocketErrorCb(const SocketErrorCb &cb) { socketErrorCb_ = cb; }
 
       protected:
          SendCb         sendCb_{ nullptr };
          NotifyDataCb   notifyDataCb_{ nullptr };
+         NotifyDataSliceCb notifyDataSliceCb_{ nullptr };
          SocketErrorCb  socketErrorCb_{ nullptr };
       };
 
@@ -58,6 +65,20 @@ namespace bs {
          virtual void processIncomingData(const std::string &encData
             , const std::string &clientID) = 0;
          virtual bool sendData(const std::string &clientId, const std::string &data) = 0;
+
+         // Sends the same message to every client in the list.
+         // Returns false if sending to any of them failed.
+         virtual bool sendDataBatch(const std::vector<std::string> &clientIds
+            , const std::string &data)
+         {
+            bool result = true;
+            for (const auto &clientId : clientIds) {
+               if (!sendData(clientId, data)) {
+                  result = false;
+               }
+            }
+            return result;
+         }
          virtual void addClient(const std::string &clientId, const ServerConnectionListener::Details &details) = 0;
          virtual void closeClient(const std::string &clientId) = 0;
 
@@ -68,9 +89,17 @@ namespace bs {
          using DataReceivedCb = std::function<void(const std::string &clientId, const std::string &data)>;
          void setDataReceivedCb(const DataReceivedCb &cb) { dataReceivedCb_ = cb; }
 
+         // Used instead of DataReceivedCb if set
+         using DataSliceReceivedCb = std::function<void(const std::string &clientId, const DataSlice &data)>;
+         void setDataSliceReceivedCb(const DataSliceReceivedCb &cb) { dataSliceReceivedCb_ = cb; }
+
          using SendDataCb = std::function<bool(const std::string &clientId, const std::string &data)>;
          void setSendDataCb(const SendDataCb &cb) { sendDataCb_ = cb; }
 
+         // Used instead of SendDataCb if set, data is a slice of transport's buffer
+         using SendDataSliceCb = std::function<bool(const std::string &clientId, const DataSlice &data)>;
+         void setSendDataSliceCb(const SendDataSliceCb &cb) { sendDataSliceCb_ = cb; }
+
          using ConnectedCb = std::function<void(const std::string &clientId, const ServerConnectionListener::Details &details)>;
          void setConnectedCb(const ConnectedCb &connCb) { connCb_ = connCb; }
 
@@ -82,7 +111,9 @@ namespace bs {
       protected:
          ClientErrorCb        clientErrorCb_{ nullptr };
          DataReceivedCb       dataReceivedCb_{ nullptr };
+         DataSliceReceivedCb  dataSliceReceivedCb_{ nullptr };
          SendDataCb           sendDataCb_{ nullptr };
+         SendDataSliceCb      sendDataSliceCb_{ nullptr };
          ConnectedCb          connCb_{ nullptr };
          DisconnectedCb       disconnCb_{ nullptr };
       };
@@ -262,30 +262,30 @@ void TransportBIP15xClient::onRawDataReceived(const std::string &rawData)
       return;
    }
 
-   auto payload = BinaryData::fromString(rawData);
-   if (!bip151Connection_) {
-      logger_->error("[TransportBIP15xClient::onRawDataReceived] received {}-sized"
-         " packet in disconnected state", payload.getSize());
-      return;
+   // Decrypted in place in reusable buffer, payload is passed up as a slice of it
+   size_t packetSize = rawData.size();
+   auto buffer = recvPool_.acquire(packetSize);
+   if (packetSize) {
+      std::memcpy(buffer->data(), rawData.data(), packetSize);
    }
+
    // Perform decryption if we're ready.
    if (bip151Connection_->connectionComplete()) {
       auto result = bip151Connection_->decryptPacket(
-         payload.getPtr(), payload.getSize(),
-         payload.getPtr(), payload.getSize());
+         buffer->data(), packetSize, buffer->data(), packetSize);
 
       if (result != 0) {
          logger_->error("[TransportBIP15xClient::onRawDataReceived] Packet [{} bytes]"
-            " decryption failed - error {}", payload.getSize(), result);
+            " decryption failed - error {}", packetSize, result);
          if (socketErrorCb_) {
             socketErrorCb_(DataConnectionListener::ProtocolViolation);
          }
          fail();
          return;
       }
-      payload.resize(payload.getSize() - POLY1305MACLEN);
+      packetSize -= POLY1305MACLEN;
    }
-   processIncomingData(payload);
+   processIncomingData(buffer, packetSize);
 }
 
 void TransportBIP15xClient::openConnection(const std::string &host
@@ -320,12 +320,14 @@ void TransportBIP15xClient::closeConnection()
 // The function that processes raw ZMQ connection data. It processes the BIP
 // 150/151 handshake (if necessary) and decrypts the raw data.
 //
-// INPUT:  Reformed message. (const BinaryData&) // TODO: FIX UP MSG
+// INPUT:  Buffer with decrypted message. (const shared_ptr<DataSlice::Buffer>&)
+//         Message size in buffer. (size_t)
 // OUTPUT: None
 // RETURN: None
-void TransportBIP15xClient::processIncomingData(const BinaryData &payload)
+void TransportBIP15xClient::processIncomingData(const std::shared_ptr<DataSlice::Buffer> &buffer
+   , size_t size)
 {
-   const auto &msg = bip15x::Message::parse(payload);
+   const auto &msg = bip15x::Message::parse(BinaryDataRef(buffer->data(), size));
    if (!msg.isValid()) {
       logger_->error("[TransportBIP15xClient::processIncomingData] deserialization failed");
       if (socketErrorCb_) {
@@ -358,7 +360,11 @@ void TransportBIP15xClient::processIncomingData(const BinaryData &payload)
    }
 
    // Pass the final data up the chain.
-   if (notifyDataCb_) {
+   if (notifyDataSliceCb_) {
+      const size_t offset = inMsg.getSize() ? size_t(inMsg.getPtr() - buffer->data()) : 0;
+      notifyDataSliceCb_(DataSlice(buffer, offset, inMsg.getSize()));
+   }
+   else if (notifyDataCb_) {
       notifyDataCb_(inMsg.toBinStr());
    }
 }
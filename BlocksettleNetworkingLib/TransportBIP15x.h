@@ -169,7 +169,7 @@ namespace bs {
          void rekey();
 
       private:
-         void processIncomingData(const BinaryData &payload);
+         void processIncomingData(const std::shared_ptr<DataSlice::Buffer> &, size_t size);
          bool processAEADHandshake(const bip15x::Message &);
          bool verifyNewIDKey(const BinaryDataRef &newKey, const std::string &srvId);
          void rekeyIfNeeded(size_t dataSize);
@@ -183,6 +183,8 @@ namespace bs {
          std::unique_ptr<BIP151Connection> bip151Connection_;
          std::chrono::time_point<std::chrono::steady_clock> outKeyTimePoint_;
 
+         SliceBufferPool   recvPool_;
+
          BIP15xNewKeyCb cbNewKey_;
          bool gotKeyAnnounce_ = false;
       };
@@ -16,7 +16,9 @@
 #include "SystemFileUtils.h"
 #include "BIP15x_Handshake.h"
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 
 using namespace bs::network;
 
@@ -148,7 +150,12 @@ void TransportBIP15xServer::rekey(const std::string &clientId)
       logger_->error("[TransportBIP15xServer::rekey] can't find connection for {}", BinaryData::fromString(clientId).toHexStr());
       return;
    }
+   rekey(connection);
+}
 
+void TransportBIP15xServer::rekey(const std::shared_ptr<BIP15xPerConnData> &connection)
+{
+   const auto &clientId = connection->clientId;
    if (!handshakeCompleted(connection->encData_.get())) {
       logger_->error("[TransportBIP15xServer::rekey] can't rekey {} without BIP151"
          " handshaked completed", BinaryData::fromString(clientId).toHexStr());
@@ -218,27 +225,31 @@ void TransportBIP15xServer::processIncomingData(const std::string &encData
       return;
    }
 
-   auto payload = BinaryData::fromString(encData);
+   // Decrypted in place in reusable buffer, payload is passed up as a slice of it
+   size_t packetSize = encData.size();
+   auto buffer = recvPool_.acquire(packetSize);
+   if (packetSize) {
+      std::memcpy(buffer->data(), encData.data(), packetSize);
+   }
 
    // Decrypt only if the BIP 151 handshake is complete.
    if (connData->encData_->connectionComplete()) {
       //decrypt packet
       auto result = connData->encData_->decryptPacket(
-         payload.getPtr(), payload.getSize(),
-         payload.getPtr(), payload.getSize());
+         buffer->data(), packetSize, buffer->data(), packetSize);
 
       if (result != 0) {
          logger_->error("[TransportBIP15xServer::processIncomingData] packet"
-            " {} [{} bytes] decryption failed: {}", payload.toHexStr(), payload.getSize(), result);
+            " {} [{} bytes] decryption failed: {}", bs::toHex(encData), packetSize, result);
          connData->isValid = false;
          clientErrorCb_(clientID, ServerConnectionListener::ClientError::HandshakeFailed, connData->details);
          return;
       }
-      payload.resize(payload.getSize() - POLY1305MACLEN);
+      packetSize -= POLY1305MACLEN;
    }
 
    // Deserialize packet.
-   const auto &msg = bip15x::Message::parse(payload);
+   const auto &msg = bip15x::Message::parse(BinaryDataRef(buffer->data(), packetSize));
    if (!msg.isValid()) {
       if (logger_) {
          logger_->error("[TransportBIP15xServer::processIncomingData] deserialization failed");
@@ -267,7 +278,11 @@ void TransportBIP15xServer::processIncomingData(const std::string &encData
    }
 
    // Pass the final data up the chain.
-   if (dataReceivedCb_) {
+   if (dataSliceReceivedCb_) {
+      const size_t offset = outMsg.getSize() ? size_t(outMsg.getPtr() - buffer->data()) : 0;
+      dataSliceReceivedCb_(clientID, DataSlice(buffer, offset, outMsg.getSize()));
+   }
+   else if (dataReceivedCb_) {
       dataReceivedCb_(clientID, outMsg.toBinStr());
    }
 }
@@ -369,8 +384,6 @@ std::shared_ptr<BIP15xPerConnData> TransportBIP15xServer::GetConnection(const st
 
 bool TransportBIP15xServer::sendData(const std::string &clientId, const std::string &data)
 {
-   BIP151Connection* connPtr = nullptr;
-
    auto connection = GetConnection(clientId);
    if (!connection || !connection->isValid) {
       logger_->error("[TransportBIP15xServer::sendData] can't send {} bytes to "
@@ -378,6 +391,13 @@ bool TransportBIP15xServer::sendData(const std::string &clientId, const std::str
       return false;
    }
 
+   return sendPackets(connection, &data, 1);
+}
+
+BIP151Connection *TransportBIP15xServer::outgoingConnection(
+   const std::shared_ptr<BIP15xPerConnData> &connection, size_t dataSize)
+{
+   BIP151Connection* connPtr = nullptr;
    if (connection->encData_->connectionComplete()) {
       connPtr = connection->encData_.get();
    }
@@ -388,7 +408,7 @@ bool TransportBIP15xServer::sendData(const std::string &clientId, const std::str
       auto rightNow = std::chrono::steady_clock::now();
 
       // Rekey off # of bytes sent or length of time since last rekey.
-      if (connPtr->rekeyNeeded(data.size())) {
+      if (connPtr->rekeyNeeded(dataSize)) {
          needsRekey = true;
       }
       else {
@@ -401,21 +421,125 @@ bool TransportBIP15xServer::sendData(const std::string &clientId, const std::str
 
       if (needsRekey) {
          connection->outKeyTimePoint_ = rightNow;
-         rekey(clientId);
+         rekey(connection);
       }
    }
 
-   // Encrypt data here if the BIP 150 handshake is complete.
+   // Encrypt data only if the BIP 150 handshake is complete.
    if (connection->encData_ && connection->encData_->getBIP150State() == BIP150State::SUCCESS) {
-      const auto &packet = bip15x::MessageBuilder(BinaryData::fromString(data)
-         , bip15x::MsgType::SinglePacket).encryptIfNeeded(connPtr).build();
-      return sendDataCb_(clientId, packet.toBinStr());
+      return connPtr;
    }
 
    logger_->error("[TransportBIP15xServer::sendData] tried to send unencrypted data");
    throw std::runtime_error("trying to send unencrypted data");
 }
 
+void TransportBIP15xServer::setExecutor(const std::shared_ptr<bs::Executor> &executor)
+{
+   executor_ = executor;
+}
+
+bool TransportBIP15xServer::sendPackets(const std::shared_ptr<BIP15xPerConnData> &connection
+   , const std::string *messages, size_t nbMessages)
+{
+   size_t totalSize = 0;
+   for (size_t i = 0; i < nbMessages; ++i) {
+      totalSize += messages[i].size();
+   }
+
+   std::lock_guard<std::mutex> lock(connection->sendMutex_);
+   auto connPtr = outgoingConnection(connection, totalSize);
+
+   auto &batch = connection->batch_;
+   batch.clear();
+   batch.reserve(nbMessages, totalSize, connPtr != nullptr);
+   for (size_t i = 0; i < nbMessages; ++i) {
+      batch.add(messages[i], bip15x::MsgType::SinglePacket, connPtr);
+   }
+
+   for (size_t i = 0; i < batch.size(); ++i) {
+      const bool result = sendDataSliceCb_ ? sendDataSliceCb_(connection->clientId, batch.slice(i))
+         : sendDataCb_(connection->clientId, batch.slice(i).toString());
+      if (!result) {
+         return false;
+      }
+   }
+   return true;
+}
+
+bool TransportBIP15xServer::sendDataBatch(const std::vector<std::string> &clientIds
+   , const std::string &data)
+{
+   bool result = true;
+   std::vector<std::shared_ptr<BIP15xPerConnData>> connections;
+   connections.reserve(clientIds.size());
+   for (const auto &clientId : clientIds) {
+      auto connection = GetConnection(clientId);
+      if (!connection || !connection->isValid) {
+         logger_->error("[TransportBIP15xServer::sendDataBatch] can't send {} bytes to "
+            "disconnected/invalid connection {}", data.size(), bs::toHex(clientId));
+         result = false;
+         continue;
+      }
+      connections.push_back(std::move(connection));
+   }
+
+   const auto sendTo = [this, &data](const std::shared_ptr<BIP15xPerConnData> &connection) {
+      try {
+         return sendPackets(connection, &data, 1);
+      }
+      catch (const std::exception &e) {
+         logger_->error("[TransportBIP15xServer::sendDataBatch] failed to send {} bytes to {}: {}"
+            , data.size(), bs::toHex(connection->clientId), e.what());
+         return false;
+      }
+   };
+
+   if (!executor_ || (connections.size() < 2)) {
+      for (const auto &connection : connections) {
+         if (!sendTo(connection)) {
+            result = false;
+         }
+      }
+      return result;
+   }
+
+   // Connections are claimed one by one by calling thread and helpers.
+   // Helpers that start after everything is claimed only touch the state,
+   // so it's safe to return once all claimed connections are done.
+   struct BatchState
+   {
+      std::atomic<size_t>  next{ 0 };
+      std::atomic<size_t>  done{ 0 };
+      std::atomic_bool     result{ true };
+      std::mutex           mutex;
+      std::condition_variable cv;
+   };
+   auto state = std::make_shared<BatchState>();
+   const size_t count = connections.size();
+   auto work = [state, count, &connections, &sendTo] {
+      for (size_t i = state->next++; i < count; i = state->next++) {
+         if (!sendTo(connections[i])) {
+            state->result = false;
+         }
+         if (++state->done == count) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->cv.notify_one();
+         }
+      }
+   };
+
+   const auto nbHelpers = std::min(executor_->nbThreads(), count - 1);
+   for (size_t i = 0; i < nbHelpers; ++i) {
+      executor_->post(work);
+   }
+   work();
+
+   std::unique_lock<std::mutex> lock(state->mutex);
+   state->cv.wait(lock, [state, count] { return state->done == count; });
+   return result && state->result;
+}
+
 void TransportBIP15xServer::closeClient(const std::string &clientId)
 {
    auto it = socketConnMap_.find(clientId);
@@ -21,6 +21,7 @@
 #include "BIP15xMessage.h"
 #include "TransportBIP15x.h"
 #include "EncryptionUtils.h"
+#include "Executor.h"
 #include "Transport.h"
 
 // DESIGN NOTES: Cookies are used for local connections. When the client is
@@ -49,6 +50,10 @@ namespace bs {
          ServerConnectionListener::Details details;
          bool     isValid{ true };
          std::string clientId;
+
+         // Guards batch_ and keeps packets passed on in encryption order
+         std::mutex  sendMutex_;
+         bip15x::BatchBuilder batch_;
       };
 
       struct BIP15xServerParams
@@ -115,6 +120,15 @@ namespace bs {
          bool handshakeComplete(const std::string &clientId) override;
          BIP15xServerParams getParams(unsigned) const;
 
+         // If set, sendDataBatch encrypts for different clients in parallel
+         // on executor threads (calling thread takes part too).
+         // sendDataCb must be thread-safe then. Must be set before sending.
+         void setExecutor(const std::shared_ptr<bs::Executor> &);
+
+         // Packet is encrypted into each client's reusable send buffer
+         bool sendDataBatch(const std::vector<std::string> &clientIds
+            , const std::string &data) override;
+
       private:
          bool createCookie(void);
          bool rmCookieFile(void);
@@ -132,6 +146,16 @@ namespace bs {
 
          bool sendData(const std::string &clientId, const std::string &) override;
 
+         // Rekeys if needed and returns connection to encrypt outgoing data with.
+         // Throws if BIP150 handshake is not completed.
+         BIP151Connection *outgoingConnection(const std::shared_ptr<BIP15xPerConnData> &
+            , size_t dataSize);
+         void rekey(const std::shared_ptr<BIP15xPerConnData> &);
+         // Encrypts packets with connection's batch builder and passes them
+         // on as slices of its buffer. Throws as outgoingConnection does.
+         bool sendPackets(const std::shared_ptr<BIP15xPerConnData> &
+            , const std::string *messages, size_t nbMessages);
+
          void closeClient(const std::string &clientId) override;
          void addClient(const std::string &clientId, const ServerConnectionListener::Details &details) override;
 
@@ -147,6 +171,8 @@ namespace bs {
          const bool makeServerIDCookie_;
 
          BIP15xPeers forcedTrustedClients_;
+         SliceBufferPool   recvPool_;   // used from IO thread only
+         std::shared_ptr<bs::Executor> executor_;
 
          //Need to be kept opened for the whole object lifetime         
          std::unique_ptr<std::ofstream>   cookieFile_;   
@@ -0,0 +1,97 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#include "SyncAddressIndex.h"
+#include "SyncWallet.h"
+
+using namespace bs::sync;
+
+void AddressIndex::addWallet(const std::shared_ptr<Wallet> &wallet
+   , const std::vector<bs::Address> &addrs)
+{
+   const auto walletId = wallet->walletId();
+   std::lock_guard<std::mutex> lock(mutex_);
+   wallets_.emplace(walletId, wallet);
+   indexAddresses(walletId, addrs);
+}
+
+void AddressIndex::eraseWallet(const std::string &walletId)
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   if (wallets_.erase(walletId) == 0) {
+      return;
+   }
+   for (auto it = walletIdByAddr_.begin(); it != walletIdByAddr_.end(); ) {
+      if (it->second == walletId) {
+         it = walletIdByAddr_.erase(it);
+      }
+      else {
+         ++it;
+      }
+   }
+}
+
+void AddressIndex::add(const std::string &walletId, const std::vector<bs::Address> &addrs)
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   indexAddresses(walletId, addrs);
+}
+
+void AddressIndex::erase(const std::string &walletId, const std::vector<bs::Address> &addrs)
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   for (const auto &addr : addrs) {
+      if (addr.empty()) {
+         continue;
+      }
+      const auto it = walletIdByAddr_.find(addr.prefixed().toBinStr());
+      if ((it != walletIdByAddr_.end()) && (it->second == walletId)) {
+         walletIdByAddr_.erase(it);
+      }
+   }
+}
+
+std::shared_ptr<Wallet> AddressIndex::find(const bs::Address &addr) const
+{
+   if (addr.empty()) {
+      return nullptr;
+   }
+   std::lock_guard<std::mutex> lock(mutex_);
+   const auto itAddr = walletIdByAddr_.find(addr.prefixed().toBinStr());
+   if (itAddr == walletIdByAddr_.end()) {
+      return nullptr;
+   }
+   // addresses could be reported by wallet that is not added (yet)
+   const auto itWallet = wallets_.find(itAddr->second);
+   return (itWallet == wallets_.end()) ? nullptr : itWallet->second;
+}
+
+void AddressIndex::clear()
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   wallets_.clear();
+   walletIdByAddr_.clear();
+}
+
+void AddressIndex::indexAddresses(const std::string &walletId
+   , const std::vector<bs::Address> &addrs)
+{
+   for (const auto &addr : addrs) {
+      if (addr.empty()) {
+         continue;
+      }
+      const auto result = walletIdByAddr_.emplace(addr.prefixed().toBinStr(), walletId);
+      // first added wallet keeps the address, unless its owner is not added
+      if (!result.second && (result.first->second != walletId)
+         && (wallets_.find(result.first->second) == wallets_.end())) {
+         result.first->second = walletId;
+      }
+   }
+}
@@ -0,0 +1,56 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#ifndef BS_SYNC_ADDRESS_INDEX_H__
+#define BS_SYNC_ADDRESS_INDEX_H__
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bs {
+   class Address;
+
+   namespace sync {
+      class Wallet;
+
+      // Address -> wallet index of a wallets manager, keyed by prefixed scrAddr.
+      // Covers used and hidden (pool) addresses of each added wallet and is
+      // kept up to date by WalletCallbackTarget::addressesAdded/addressesRemoved.
+      class AddressIndex
+      {
+      public:
+         // Indexes wallet's current addresses. An address already indexed for
+         // another added wallet keeps that entry (first match wins).
+         void addWallet(const std::shared_ptr<Wallet> &, const std::vector<bs::Address> &);
+         void eraseWallet(const std::string &walletId);
+
+         void add(const std::string &walletId, const std::vector<bs::Address> &);
+         // Erases only addresses that are indexed for this wallet
+         void erase(const std::string &walletId, const std::vector<bs::Address> &);
+
+         std::shared_ptr<Wallet> find(const bs::Address &) const;
+         void clear();
+
+      private:
+         // must be called under mutex_
+         void indexAddresses(const std::string &walletId, const std::vector<bs::Address> &);
+
+         mutable std::mutex   mutex_;
+         std::unordered_map<std::string, std::shared_ptr<Wallet>> wallets_;  // by walletId
+         std::unordered_map<std::string, std::string> walletIdByAddr_;
+      };
+
+   }  //namespace sync
+}  //namespace bs
+
+#endif // BS_SYNC_ADDRESS_INDEX_H__
@@ -17,6 +17,7 @@
 #include "WalletSignerContainer.h"
 #include "WalletUtils.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <spdlog/spdlog.h>
 #include <QLocale>
@@ -75,6 +76,8 @@ void hd::Leaf::synchronize(const std::function<void()> &cbDone)
          setAddressComment(addr.address, addr.comment, false);
       }
 
+      std::vector<bs::Address> poolAddrs;
+      poolAddrs.reserve(data.addrPool.size());
       {
          FastLock locker{addressPoolLock_};
          for (const auto &addr : data.addrPool) {
@@ -84,6 +87,7 @@ void hd::Leaf::synchronize(const std::function<void()> &cbDone)
             auto index = path.get(-1);
             addressPool_[{ path }] = addr.address;
             poolByAddr_[addr.address] = { path };
+            poolAddrs.push_back(addr.address);
             if (type == addrTypeExternal) {
                lastPoolExtIdx_ = std::max(lastPoolExtIdx_, index);
             } else {
@@ -91,6 +95,7 @@ void hd::Leaf::synchronize(const std::function<void()> &cbDone)
             }
          }
       }
+      onAddressesAdded(poolAddrs);
 
       for (const auto &txComment : data.txComments) {
          setTransactionComment(txComment.txHash, txComment.comment, false);
@@ -321,6 +326,11 @@ void hd::Leaf::reset()
    std::lock_guard<std::mutex> lock(regMutex_);
    FastLock locker{addressPoolLock_};
 
+   auto removedAddrs = usedAddresses_;
+   for (const auto &addr : addressPool_) {
+      removedAddrs.push_back(addr.second);
+   }
+
    lastIntIdx_ = lastExtIdx_ = 0;
    usedAddresses_.clear();
    intAddresses_.clear();
@@ -329,6 +339,7 @@ void hd::Leaf::reset()
    addrPrefixedHashes_.clear();
    addressPool_.clear();
    poolByAddr_.clear();
+   onAddressesRemoved(removedAddrs);
    if (wct_) {
       wct_->walletReset(walletId());
    }
@@ -411,6 +422,17 @@ bool hd::Leaf::containsHiddenAddress(const bs::Address &addr) const
    return (poolByAddr_.find(addr) != poolByAddr_.end());
 }
 
+std::vector<bs::Address> hd::Leaf::getAllAddresses() const
+{
+   auto result = getUsedAddressList();
+   FastLock locker{addressPoolLock_};
+   result.reserve(result.size() + addressPool_.size());
+   for (const auto &addr : addressPool_) {
+      result.push_back(addr.second);
+   }
+   return result;
+}
+
 std::vector<std::pair<bs::Address, std::string>> bs::sync::hd::Leaf::getAddressPool() const
 {
    std::vector<std::pair<bs::Address, std::string>> result;
@@ -647,13 +669,17 @@ void hd::Leaf::topUpAddressPool(bool extInt, const std::function<void()> &cb)
       with the DB, which is why they are only saved in the pool.
       ***/
 
+      std::vector<bs::Address> poolAddrs;
+      poolAddrs.reserve(addrVec.size());
       for (const auto &addrPair : addrVec) {
          const auto path = bs::hd::Path::fromString(addrPair.second);
 
          FastLock locker{addressPoolLock_};
          addressPool_[{ path }] = addrPair.first;
          poolByAddr_[addrPair.first] = { path };
+         poolAddrs.push_back(addrPair.first);
       }
+      onAddressesAdded(poolAddrs);
 
       //register new addresses with db
       if (armory_) {
@@ -888,11 +914,25 @@ void hd::Leaf::merge(const std::shared_ptr<Wallet> &walletPtr)
    txComments_.insert(
       leafPtr->txComments_.begin(), leafPtr->txComments_.end());
 
+   std::vector<bs::Address> oldPoolAddrs, newPoolAddrs;
    {
       FastLock locker{addressPoolLock_};
+      for (const auto &addr : addressPool_) {
+         if (leafPtr->poolByAddr_.find(addr.second) == leafPtr->poolByAddr_.end()) {
+            oldPoolAddrs.push_back(addr.second);
+         }
+      }
       addressPool_ = leafPtr->addressPool_;
       poolByAddr_ = leafPtr->poolByAddr_;
+      for (const auto &addr : addressPool_) {
+         newPoolAddrs.push_back(addr.second);
+      }
    }
+   // pool addresses that were used meanwhile stay in the wallet
+   oldPoolAddrs.erase(std::remove_if(oldPoolAddrs.begin(), oldPoolAddrs.end()
+      , [this](const bs::Address &addr) { return containsAddress(addr); }), oldPoolAddrs.end());
+   onAddressesRemoved(oldPoolAddrs);
+   onAddressesAdded(newPoolAddrs);
 
    intAddresses_ = leafPtr->intAddresses_;
    extAddresses_ = leafPtr->extAddresses_;
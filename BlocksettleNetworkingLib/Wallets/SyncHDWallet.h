@@ -118,6 +118,18 @@ namespace bs {
 
          protected:
             void addressAdded(const std::string &walletId) override { wct_->addressAdded(walletId); }
+            void addressesAdded(const std::string &walletId, const std::vector<bs::Address> &addrs) override
+            {
+               if (wct_) {
+                  wct_->addressesAdded(walletId, addrs);
+               }
+            }
+            void addressesRemoved(const std::string &walletId, const std::vector<bs::Address> &addrs) override
+            {
+               if (wct_) {
+                  wct_->addressesRemoved(walletId, addrs);
+               }
+            }
             void walletReady(const std::string &walletId) override { wct_->walletReady(walletId); }
             void balanceUpdated(const std::string &walletId) override { wct_->balanceUpdated(walletId); }
             void metadataChanged(const std::string &) override { wct_->metadataChanged(walletId()); }
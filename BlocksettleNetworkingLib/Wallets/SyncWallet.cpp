@@ -65,6 +65,7 @@ void Wallet::synchronize(const std::function<void()> &cbDone)
          return;
       }
 
+      onAddressesRemoved(usedAddresses_);
       usedAddresses_.clear();
       for (const auto &addr : data.addresses) {
          addAddress(addr.address, addr.index, false);
@@ -950,6 +951,7 @@ int Wallet::addAddress(const bs::Address &addr, const std::string &index
 {
    if (!addr.empty()) {
       usedAddresses_.push_back(addr);
+      onAddressesAdded({ addr });
    }
 
    if (sync && signContainer_) {
@@ -966,6 +968,20 @@ int Wallet::addAddress(const bs::Address &addr, const std::string &index
    return (usedAddresses_.size() - 1);
 }
 
+void Wallet::onAddressesAdded(const std::vector<bs::Address> &addrs)
+{
+   if (wct_ && !addrs.empty()) {
+      wct_->addressesAdded(walletId(), addrs);
+   }
+}
+
+void Wallet::onAddressesRemoved(const std::vector<bs::Address> &addrs)
+{
+   if (wct_ && !addrs.empty()) {
+      wct_->addressesRemoved(walletId(), addrs);
+   }
+}
+
 void Wallet::syncAddresses()
 {
    if (armory_) {
@@ -141,6 +141,9 @@ namespace bs {
          virtual bool containsAddress(const bs::Address &addr) = 0;
          virtual bool containsHiddenAddress(const bs::Address &) const { return false; }
 
+         // Used and hidden (pool) addresses
+         virtual std::vector<bs::Address> getAllAddresses() const { return getUsedAddressList(); }
+
          [[deprecated]] virtual std::vector<std::string> registerWallet(
             const std::shared_ptr<ArmoryConnection> &armory = nullptr, bool asNew = false);
          [[deprecated]] virtual void unregisterWallet();
@@ -288,6 +291,11 @@ namespace bs {
 
          Registered isRegistered(void) const { return isRegistered_; }
 
+      protected:
+         // Reports address changes to WalletCallbackTarget (managers' address index)
+         void onAddressesAdded(const std::vector<bs::Address> &);
+         void onAddressesRemoved(const std::vector<bs::Address> &);
+
       protected:
          std::string                walletName_;
          WalletSignerContainer*     signContainer_;
@@ -374,6 +382,9 @@ namespace bs {
          virtual ~WalletCallbackTarget() = default;
 
          virtual void addressAdded(const std::string &) {}
+         // Used or hidden (pool) addresses added to/removed from the wallet
+         virtual void addressesAdded(const std::string &, const std::vector<bs::Address> &) {}
+         virtual void addressesRemoved(const std::string &, const std::vector<bs::Address> &) {}
          virtual void walletReady(const std::string &) {}
          virtual void balanceUpdated(const std::string &) {}
          virtual void metadataChanged(const std::string &) {}
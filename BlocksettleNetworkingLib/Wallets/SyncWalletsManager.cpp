@@ -89,6 +89,7 @@ void bs::sync::WalletsManager::reset()
 {
    QMutexLocker lock(&mtxWallets_);
    wallets_.clear();
+   addressIndex_.clear();
    hdWallets_.clear();
    walletNames_.clear();
    readyWallets_.clear();
@@ -235,9 +236,11 @@ void bs::sync::WalletsManager::addWallet(const WalletPtr &wallet, bool isHDLeaf)
       const auto &itWallet = wallets_.find(wallet->walletId());
       if (itWallet != wallets_.end()) {
          itWallet->second->merge(wallet);
+         addressIndex_.addWallet(itWallet->second, wallet->getAllAddresses());
       }
       else {
          wallets_[wallet->walletId()] = wallet;
+         addressIndex_.addWallet(wallet, wallet->getAllAddresses());
       }
    }
 
@@ -267,6 +270,18 @@ void bs::sync::WalletsManager::addressAdded(const std::string &walletId)
    });
 }
 
+void bs::sync::WalletsManager::addressesAdded(const std::string &walletId
+   , const std::vector<bs::Address> &addrs)
+{
+   addressIndex_.add(walletId, addrs);
+}
+
+void bs::sync::WalletsManager::addressesRemoved(const std::string &walletId
+   , const std::vector<bs::Address> &addrs)
+{
+   addressIndex_.erase(walletId, addrs);
+}
+
 void bs::sync::WalletsManager::metadataChanged(const std::string &walletId)
 {
    addToQueue([this, walletId] {
@@ -455,13 +470,7 @@ bs::sync::WalletsManager::WalletPtr bs::sync::WalletsManager::getWalletById(cons
 
 bs::sync::WalletsManager::WalletPtr bs::sync::WalletsManager::getWalletByAddress(const bs::Address &address) const
 {
-   for (const auto &wallet : wallets_) {
-      if (wallet.second && (wallet.second->containsAddress(address)
-         || wallet.second->containsHiddenAddress(address))) {
-         return wallet.second;
-      }
-   }
-   return nullptr;
+   return addressIndex_.find(address);
 }
 
 bs::sync::WalletsManager::GroupPtr bs::sync::WalletsManager::getGroupByWalletId(const std::string& walletId) const
@@ -615,6 +624,7 @@ void bs::sync::WalletsManager::eraseWallet(const WalletPtr &wallet)
    }
    QMutexLocker lock(&mtxWallets_);
    wallets_.erase(wallet->walletId());
+   addressIndex_.eraseWallet(wallet->walletId());
 }
 
 bool bs::sync::WalletsManager::deleteWallet(WalletPtr wallet, bool deleteRemotely)
@@ -26,6 +26,7 @@
 #include "BSErrorCode.h"
 #include "BTCNumericTypes.h"
 #include "CoreWallet.h"
+#include "SyncAddressIndex.h"
 #include "SyncWallet.h"
 #include "ValidityFlag.h"
 #include "WalletSignerContainer.h"
@@ -221,6 +222,8 @@ namespace bs {
 
       private:
          void addressAdded(const std::string &) override;
+         void addressesAdded(const std::string &, const std::vector<bs::Address> &) override;
+         void addressesRemoved(const std::string &, const std::vector<bs::Address> &) override;
          void balanceUpdated(const std::string &) override;
          void walletReady(const std::string &) override;
          void walletCreated(const std::string &) override;
@@ -285,6 +288,7 @@ namespace bs {
          BinaryData                          userId_;
          std::set<std::string>               newWallets_;
          mutable std::unordered_map<std::string, GroupPtr>  groupsByWalletId_;
+         AddressIndex                        addressIndex_;
 
          class CCResolver : public CCDataResolver
          {
@@ -11,7 +11,9 @@
 #ifndef WS_COMMON_PRIVATE_H
 #define WS_COMMON_PRIVATE_H
 
+#include <cassert>
 #include <chrono>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
@@ -44,6 +46,57 @@ namespace bs {
             uint64_t nextTimerId_{};
          };
 
+         // Packets queued for sending and kept until acked, indexed by counter.
+         // Counters are contiguous, so push, lookup and trimming on ack are O(1).
+         template <class Packet>
+         class RetransmitWindow
+         {
+         public:
+            // packet gets counter end()
+            void push(Packet packet)
+            {
+               bytes_ += packet.getSize();
+               packets_.emplace_back(std::move(packet));
+            }
+
+            Packet &at(uint64_t counter)
+            {
+               assert(counter >= base_ && counter < end());
+               return packets_[counter - base_];
+            }
+
+            // removes packets with counter less than given, returns number of freed bytes
+            size_t trimTo(uint64_t counter)
+            {
+               size_t freed = 0;
+               while (base_ < counter && !packets_.empty()) {
+                  freed += packets_.front().getSize();
+                  packets_.pop_front();
+                  base_++;
+               }
+               bytes_ -= freed;
+               return freed;
+            }
+
+            void clear(uint64_t base = 0)
+            {
+               packets_.clear();
+               base_ = base;
+               bytes_ = 0;
+            }
+
+            uint64_t begin() const { return base_; }
+            uint64_t end() const { return base_ + packets_.size(); }
+            size_t size() const { return packets_.size(); }
+            bool empty() const { return packets_.empty(); }
+            size_t bufferedBytes() const { return bytes_; }
+
+         private:
+            std::deque<Packet>   packets_;
+            uint64_t             base_{};
+            size_t               bytes_{};
+         };
+
       };
    }
 }
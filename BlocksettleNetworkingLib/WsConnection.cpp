@@ -64,6 +64,11 @@ namespace {
       {
          return WsRawPacket(w.toString());
       }
+
+      std::string toString()
+      {
+         return w.toString();
+      }
    };
 
    constexpr auto kPingPongInterval = std::chrono::seconds(60);
@@ -85,6 +90,14 @@ WsRawPacket::WsRawPacket(const std::string &data)
    data_.insert(data_.end(), data.begin(), data.end());
 }
 
+WsRawPacket::WsRawPacket(const std::string &header, const uint8_t *payload, size_t size)
+{
+   data_.reserve(kLwsPrePaddingSize + header.size() + size);
+   data_.resize(kLwsPrePaddingSize);
+   data_.insert(data_.end(), header.begin(), header.end());
+   data_.insert(data_.end(), payload, payload + size);
+}
+
 uint8_t *WsRawPacket::getPtr()
 {
    return data_.data() + kLwsPrePaddingSize;
@@ -95,6 +108,21 @@ size_t WsRawPacket::getSize() const
    return data_.size() - kLwsPrePaddingSize;
 }
 
+WsSharedPacket::WsSharedPacket(WsRawPacket &&packet)
+   : packet_(std::make_shared<WsRawPacket>(std::move(packet)))
+{
+}
+
+uint8_t *WsSharedPacket::getPtr() const
+{
+   return packet_->getPtr();
+}
+
+size_t WsSharedPacket::getSize() const
+{
+   return packet_->getSize();
+}
+
 using namespace bs::network;
 
 WsRawPacket WsPacket::requestNew()
@@ -133,9 +161,16 @@ WsRawPacket WsPacket::responseUnknown()
 
 WsRawPacket WsPacket::data(const std::string &payload)
 {
-   return WsRawPacketBuilder(Type::Data)
-         .putString(payload)
-         .build();
+   return data(reinterpret_cast<const uint8_t *>(payload.data()), payload.size());
+}
+
+WsRawPacket WsPacket::data(const uint8_t *payload, size_t size)
+{
+   // Same layout as putString, but payload is not copied through BinaryWriter
+   const auto header = WsRawPacketBuilder(Type::Data)
+         .putNumber(size)
+         .toString();
+   return WsRawPacket(header, payload, size);
 }
 
 WsRawPacket WsPacket::ack(uint64_t recvCounter)
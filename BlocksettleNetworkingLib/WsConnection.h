@@ -67,11 +67,33 @@ namespace bs {
       public:
          explicit WsRawPacket(const std::string &data);
 
+         // header followed by payload, payload is copied only once
+         WsRawPacket(const std::string &header, const uint8_t *payload, size_t size);
+
          uint8_t *getPtr();
 
          size_t getSize() const;
       };
 
+      // Immutable packet referenced by many clients' send queues (one buffer per broadcast).
+      // Server side only: server frames are not masked, so lws_write touches only
+      // LWS_PRE padding in front of payload, rewritten on each write from the same thread.
+      // Client frames are masked in place and must use own WsRawPacket copy.
+      class WsSharedPacket
+      {
+      private:
+         std::shared_ptr<WsRawPacket> packet_;
+
+      public:
+         explicit WsSharedPacket(WsRawPacket &&packet);
+
+         uint8_t *getPtr() const;
+
+         size_t getSize() const;
+
+         long useCount() const { return packet_.use_count(); }
+      };
+
       extern const char *kProtocolNameWs;
 
       constexpr size_t kRxBufferSize = 16 * 1024;
@@ -105,6 +127,7 @@ namespace bs {
          static WsRawPacket responseResumed(uint64_t recvCounter);
          static WsRawPacket responseUnknown();
          static WsRawPacket data(const std::string &payload);
+         static WsRawPacket data(const uint8_t *payload, size_t size);
          static WsRawPacket ack(uint64_t recvCounter);
 
          static WsPacket parsePacket(const std::string &payload
@@ -113,7 +113,10 @@ bool WsDataConnection::closeConnection()
    context_ = nullptr;
    listener_ = nullptr;
    newPackets_ = {};
-   allPackets_ = {};
+   allPackets_.clear();
+   bufferedBytes_ = 0;
+   congested_ = false;
+   overflown_ = false;
    currFragment_ = {};
    state_ = {};
    sentCounter_ = {};
@@ -135,10 +138,30 @@ bool WsDataConnection::send(const std::string &data)
    if (!context_) {
       return false;
    }
+   auto packet = filterRawPacket(WsPacket::data(data));
+   const auto size = packet.getSize();
+   bool overflow = false;
    {
       std::lock_guard<std::mutex> lock(mutex_);
-      newPackets_.push(filterRawPacket(WsPacket::data(data)));
+      if (overflown_) {
+         return false;
+      }
+      // skipping one packet would break the peer's stream, close the connection instead
+      overflow = params_.maximumBufferedBytes && (bufferedBytes_ + size > params_.maximumBufferedBytes);
+      if (overflow) {
+         overflown_ = true;
+      }
+      else {
+         bufferedBytes_ += size;
+         newPackets_.push(std::move(packet));
+      }
+   }
+   if (overflow) {
+      SPDLOG_LOGGER_ERROR(logger_, "send buffer is full ({} bytes), closing connection", bufferedBytes_.load());
+      lws_cancel_service(context_);
+      return false;
    }
+   updateBackpressure();
    lws_cancel_service(context_);
    return true;
 }
@@ -200,11 +223,19 @@ int WsDataConnection::callback(lws *wsi, int reason, void *user, void *in, size_
          {
             std::lock_guard<std::mutex> lock(mutex_);
             while (!newPackets_.empty()) {
-               allPackets_.insert(std::make_pair(queuedCounter_, std::move(newPackets_.front())));
+               allPackets_.push(std::move(newPackets_.front()));
                newPackets_.pop();
                queuedCounter_ += 1;
             }
          }
+         if (overflown_ && (state_ != State::Closed)) {
+            if (wsi_ != nullptr) {
+               lws_close_reason(wsi_, LWS_CLOSE_STATUS_PROTOCOL_ERR, nullptr, 0);
+               lws_set_timeout(wsi_, PENDING_TIMEOUT_USER_OK, LWS_TO_KILL_SYNC);
+            }
+            processFatalError(DataConnectionListener::SendBufferOverflow);
+            break;
+         }
          if (!allPackets_.empty()) {
             if (state_ == State::Connected) {
                assert(wsi_);
@@ -523,12 +554,12 @@ void WsDataConnection::processError()
    }
 }
 
-void WsDataConnection::processFatalError()
+void WsDataConnection::processFatalError(DataConnectionListener::DataConnectionError error)
 {
    switch (state_) {
       case State::Connecting:
       case State::WaitingNewResponse:
-         listener_->OnError(DataConnectionListener::UndefinedSocketError);
+         listener_->OnError(error);
          break;
 
       case State::Closing:
@@ -539,7 +570,7 @@ void WsDataConnection::processFatalError()
       case State::Connected:
       case State::WaitingResumedResponse:
          listener_->OnDisconnected();
-         listener_->OnError(DataConnectionListener::UndefinedSocketError);
+         listener_->OnError(error);
          break;
 
       case State::Closed:
@@ -585,15 +616,32 @@ bool WsDataConnection::processSentAck(uint64_t sentAckCounter)
       return false;
    }
 
-   while (sentAckCounter_ < sentAckCounter) {
-      size_t count = allPackets_.erase(sentAckCounter_);
-      assert(count == 1);
-      sentAckCounter_ += 1;
-   }
+   assert(allPackets_.begin() == sentAckCounter_);
+   bufferedBytes_ -= allPackets_.trimTo(sentAckCounter);
+   sentAckCounter_ = sentAckCounter;
+   updateBackpressure();
 
    return true;
 }
 
+void WsDataConnection::updateBackpressure()
+{
+   if (!params_.highWatermarkBytes || !params_.backpressureCallback) {
+      return;
+   }
+   const size_t buffered = bufferedBytes_;
+   if (buffered >= params_.highWatermarkBytes) {
+      if (!congested_.exchange(true)) {
+         params_.backpressureCallback(true);
+      }
+   }
+   else if (buffered < params_.highWatermarkBytes / 2) {
+      if (congested_.exchange(false)) {
+         params_.backpressureCallback(false);
+      }
+   }
+}
+
 WsRawPacket WsDataConnection::filterRawPacket(WsRawPacket packet)
 {
    return packet;
@@ -38,6 +38,16 @@ struct WsDataConnectionParams
    size_t maximumPacketSize{bs::network::ws::kDefaultMaximumWsPacketSize};
    std::vector<uint32_t> delaysTableMs;
    std::uint32_t timeoutSecs{};
+
+   // Limit for bytes queued or waiting for ack (kept for resumption), 0 - unlimited.
+   // Once it would be exceeded send() returns false and the connection is closed
+   // with SendBufferOverflow error (packets are never dropped from the middle of a stream).
+   size_t maximumBufferedBytes{};
+
+   // If set, backpressureCallback(true) is called when buffered bytes reach highWatermarkBytes
+   // and backpressureCallback(false) when they drop below half of it (from listener thread).
+   size_t highWatermarkBytes{};
+   std::function<void(bool congested)> backpressureCallback;
 };
 
 class WsDataConnection : public DataConnection
@@ -58,6 +68,9 @@ public:
    bool send(const std::string& data) override;
    bool isActive() const override;
 
+   // queued and not yet acked by server
+   size_t bufferedBytes() const { return bufferedBytes_; }
+
    bool timer(std::chrono::milliseconds timeout, TimerCallback callback) override;
 
    static int callbackHelper(struct lws *wsi, int reason, void *user, void *in, size_t len);
@@ -83,10 +96,12 @@ private:
    void scheduleReconnect();
    void reconnect();
    void processError();
-   void processFatalError();
+   void processFatalError(DataConnectionListener::DataConnectionError error
+      = DataConnectionListener::UndefinedSocketError);
    bool writeNeeded() const;
    void requestWriteIfNeeded();
    bool processSentAck(uint64_t sentAckCounter);
+   void updateBackpressure();
 
    // For tests, default is noop
    virtual bs::network::WsRawPacket filterRawPacket(bs::network::WsRawPacket packet);
@@ -104,8 +119,12 @@ private:
    std::mutex mutex_;
    std::queue<bs::network::WsRawPacket> newPackets_;
 
+   std::atomic<size_t> bufferedBytes_{};
+   std::atomic_bool congested_{};
+   std::atomic_bool overflown_{};
+
    // Fields accessible from listener thread only!
-   std::map<uint64_t, bs::network::WsRawPacket> allPackets_;
+   bs::network::ws::RetransmitWindow<bs::network::WsRawPacket> allPackets_;
    std::string currFragment_;
    lws *wsi_{};
    State state_{State::Connecting};
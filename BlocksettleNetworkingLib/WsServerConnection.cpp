@@ -118,6 +118,7 @@ void WsServerConnection::stopServer()
 
    packets_ = {};
    clients_ = {};
+   bufferedBytes_.clear();
    connections_ = {};
    cookieToClientIdMap_ = {};
    shuttingDownReceived_ = {};
@@ -140,11 +141,15 @@ int WsServerConnection::callback(lws *wsi, int reason, void *in, size_t len)
             packets.pop();
 
             if (data.clientId == kAllClientsId) {
+               std::vector<std::string> overflownClients;
                for (auto &item : clients_) {
-                  auto &client = item.second;
-                  client.allPackets.insert(std::make_pair(client.queuedCounter, data.packet));
-                  client.queuedCounter += 1;
-                  requestWriteIfNeeded(client);
+                  if (!queuePacket(item.first, item.second, data.packet)) {
+                     overflownClients.push_back(item.first);
+                  }
+               }
+               for (const auto &clientId : overflownClients) {
+                  forceCloseClient(clientId);
+                  listener_->onClientError(clientId, ServerConnectionListener::BufferOverflow, {});
                }
                continue;
             }
@@ -153,10 +158,17 @@ int WsServerConnection::callback(lws *wsi, int reason, void *in, size_t len)
             if (clientIt == clients_.end()) {
                continue;
             }
-            auto &client = clientIt->second;
-            client.allPackets.insert(std::make_pair(client.queuedCounter, data.packet));
-            client.queuedCounter += 1;
-            requestWriteIfNeeded(client);
+            if (data.overflow) {
+               SPDLOG_LOGGER_ERROR(logger_, "high watermark reached for client {} ({} bytes)"
+                  , bs::toHex(data.clientId), clientIt->second.allPackets.bufferedBytes());
+               forceCloseClient(data.clientId);
+               listener_->onClientError(data.clientId, ServerConnectionListener::BufferOverflow, {});
+               continue;
+            }
+            if (!queuePacket(data.clientId, clientIt->second, data.packet)) {
+               forceCloseClient(data.clientId);
+               listener_->onClientError(data.clientId, ServerConnectionListener::BufferOverflow, {});
+            }
          }
 
          if (shuttingDown_.load() && !shuttingDownReceived_) {
@@ -171,19 +183,7 @@ int WsServerConnection::callback(lws *wsi, int reason, void *in, size_t len)
             auto clientId = std::move(forceClosingClients.front());
             forceClosingClients.pop();
 
-            auto clientIt = clients_.find(clientId);
-            if (clientIt != clients_.end()) {
-               SPDLOG_LOGGER_DEBUG(logger_, "force close client {}", bs::toHex(clientId));
-               auto clientWsi = clientIt->second.wsi;
-               if (clientWsi) {
-                  auto &connection = connections_.at(clientWsi);
-                  connection.state = State::Closed;
-                  lws_close_reason(clientWsi, LWS_CLOSE_STATUS_PROTOCOL_ERR, nullptr, 0);
-                  lws_set_timeout(clientWsi, PENDING_TIMEOUT_USER_OK, LWS_TO_KILL_SYNC);
-               }
-               closeConnectedClient(clientId);
-            }
-            listener_->OnClientDisconnected(clientId);
+            forceCloseClient(clientId);
          }
 
          break;
@@ -289,7 +289,7 @@ int WsServerConnection::callback(lws *wsi, int reason, void *in, size_t len)
                      break;
                   }
                   case WsPacket::Type::Ack: {
-                     if (!processSentAck(client, packet.recvCounter)) {
+                     if (!processSentAck(connection.clientId, client, packet.recvCounter)) {
                         SPDLOG_LOGGER_ERROR(logger_, "invalid ack");
                         processError(wsi);
                         return -1;
@@ -322,7 +322,7 @@ int WsServerConnection::callback(lws *wsi, int reason, void *in, size_t len)
                      }
                      const auto &clientId = cookieIt->second;
                      auto &client = clients_.at(clientId);
-                     if (!processSentAck(client, packet.recvCounter)) {
+                     if (!processSentAck(clientId, client, packet.recvCounter)) {
                         SPDLOG_LOGGER_ERROR(logger_, "resuming connection failed");
                         processError(wsi);
                         return -1;
@@ -509,22 +509,55 @@ void WsServerConnection::requestWriteIfNeeded(const ClientData &client)
    }
 }
 
-bool WsServerConnection::processSentAck(WsServerConnection::ClientData &client, uint64_t sentAckCounter)
+bool WsServerConnection::processSentAck(const std::string &clientId
+   , WsServerConnection::ClientData &client, uint64_t sentAckCounter)
 {
    if (sentAckCounter < client.sentAckCounter || sentAckCounter > client.sentCounter) {
       SPDLOG_LOGGER_ERROR(logger_, "invalid ack value from client");
       return false;
    }
 
-   while (client.sentAckCounter < sentAckCounter) {
-      size_t count = client.allPackets.erase(client.sentAckCounter);
-      assert(count == 1);
-      client.sentAckCounter += 1;
-   }
+   assert(client.allPackets.begin() == client.sentAckCounter);
+   client.allPackets.trimTo(sentAckCounter);
+   client.sentAckCounter = sentAckCounter;
+   bufferedBytes_.insert_or_assign(clientId, client.allPackets.bufferedBytes());
 
    return true;
 }
 
+bool WsServerConnection::queuePacket(const std::string &clientId, ClientData &client
+   , const WsSharedPacket &packet)
+{
+   if (params_.maximumBufferedBytes
+      && (client.allPackets.bufferedBytes() + packet.getSize() > params_.maximumBufferedBytes)) {
+      SPDLOG_LOGGER_ERROR(logger_, "send buffer limit reached for client {} ({} bytes)"
+         , bs::toHex(clientId), client.allPackets.bufferedBytes());
+      return false;
+   }
+   client.allPackets.push(packet);
+   client.queuedCounter += 1;
+   bufferedBytes_.insert_or_assign(clientId, client.allPackets.bufferedBytes());
+   requestWriteIfNeeded(client);
+   return true;
+}
+
+void WsServerConnection::forceCloseClient(const std::string &clientId)
+{
+   auto clientIt = clients_.find(clientId);
+   if (clientIt != clients_.end()) {
+      SPDLOG_LOGGER_DEBUG(logger_, "force close client {}", bs::toHex(clientId));
+      auto clientWsi = clientIt->second.wsi;
+      if (clientWsi) {
+         auto &connection = connections_.at(clientWsi);
+         connection.state = State::Closed;
+         lws_close_reason(clientWsi, LWS_CLOSE_STATUS_PROTOCOL_ERR, nullptr, 0);
+         lws_set_timeout(clientWsi, PENDING_TIMEOUT_USER_OK, LWS_TO_KILL_SYNC);
+      }
+      closeConnectedClient(clientId);
+   }
+   listener_->OnClientDisconnected(clientId);
+}
+
 void WsServerConnection::processError(lws *wsi)
 {
    auto &connection = connections_.at(wsi);
@@ -550,11 +583,34 @@ void WsServerConnection::closeConnectedClient(const std::string &clientId)
    auto count = cookieToClientIdMap_.erase(client.cookie);
    assert(count == 1);
    clients_.erase(clientId);
+   bufferedBytes_.erase(clientId);
 }
 
 bool WsServerConnection::SendDataToClient(const std::string &clientId, const std::string &data)
 {
-   DataToSend toSend{clientId, WsPacket::data(data)};
+   return queueData(clientId, reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+bool WsServerConnection::SendDataSliceToClient(const std::string &clientId, const DataSlice &data)
+{
+   return queueData(clientId, data.data(), data.size());
+}
+
+bool WsServerConnection::queueData(const std::string &clientId, const uint8_t *data, size_t size)
+{
+   if (params_.highWatermarkBytes && (clientId != kAllClientsId)) {
+      const auto buffered = bufferedBytes_.find(clientId);
+      if (buffered && (*buffered > params_.highWatermarkBytes)) {
+         // skipping one packet would break the peer's stream, drop the client instead
+         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            packets_.push({clientId, WsSharedPacket(WsRawPacket(std::string{})), true});
+         }
+         lws_cancel_service(context_);
+         return false;
+      }
+   }
+   DataToSend toSend{clientId, WsSharedPacket(WsPacket::data(data, size))};
    {
       std::lock_guard<std::mutex> lock(mutex_);
       packets_.push(std::move(toSend));
@@ -593,6 +649,20 @@ bool WsServerConnection::closeClient(const std::string &clientId)
    return true;
 }
 
+size_t WsServerConnection::bufferedBytes(const std::string &clientId) const
+{
+   return bufferedBytes_.find(clientId).value_or(0);
+}
+
+std::unordered_map<std::string, size_t> WsServerConnection::bufferedBytesPerClient() const
+{
+   std::unordered_map<std::string, size_t> result;
+   bufferedBytes_.for_each([&result](const std::string &clientId, size_t bytes) {
+      result[clientId] = bytes;
+   });
+   return result;
+}
+
 int WsServerConnection::callbackHelper(lws *wsi, int reason, void *in, size_t len)
 {
    auto context = lws_get_context(wsi);
@@ -12,6 +12,7 @@
 #define WS_SERVER_CONNECTION_H
 
 #include "ServerConnection.h"
+#include "ThreadSafeContainers.h"
 #include "WsCommonPrivate.h"
 #include "WsConnection.h"
 
@@ -21,6 +22,7 @@
 #include <queue>
 #include <set>
 #include <thread>
+#include <unordered_map>
 
 namespace spdlog {
    class logger;
@@ -51,6 +53,15 @@ struct WsServerConnectionParams
    std::chrono::milliseconds handshakeTimeout{std::chrono::seconds(5)};
 
    std::chrono::milliseconds clientTimeout{std::chrono::seconds(30)};
+
+   // Limit for bytes queued or waiting for ack (kept for resumption) per client, 0 - unlimited.
+   // Client exceeding it is disconnected with ClientError::BufferOverflow.
+   size_t maximumBufferedBytes{};
+
+   // SendDataToClient returns false once client's buffered bytes are above it and
+   // the client is disconnected with ClientError::BufferOverflow (packets are never
+   // dropped from the middle of a stream), 0 - disabled
+   size_t highWatermarkBytes{};
 };
 
 class WsServerConnection : public ServerConnection
@@ -68,12 +79,17 @@ public:
       , ServerConnectionListener* listener) override;
 
    bool SendDataToClient(const std::string& clientId, const std::string& data) override;
+   bool SendDataSliceToClient(const std::string& clientId, const bs::network::DataSlice& data) override;
    bool SendDataToAllClients(const std::string&) override;
 
    bool timer(std::chrono::milliseconds timeout, TimerCallback callback) override;
 
    bool closeClient(const std::string& clientId) override;
 
+   // queued and not yet acked by the client
+   size_t bufferedBytes(const std::string &clientId) const;
+   std::unordered_map<std::string, size_t> bufferedBytesPerClient() const;
+
    static int callbackHelper(struct lws *wsi, int reason, void *in, size_t len);
 
 private:
@@ -90,7 +106,8 @@ private:
    struct DataToSend
    {
       std::string clientId;
-      bs::network::WsRawPacket packet;
+      bs::network::WsSharedPacket packet;
+      bool overflow{};  // close the client instead, in order with its packets
    };
 
    struct ConnectionData
@@ -103,7 +120,7 @@ private:
 
    struct ClientData
    {
-      std::map<uint64_t, bs::network::WsRawPacket> allPackets;
+      bs::network::ws::RetransmitWindow<bs::network::WsSharedPacket> allPackets;  // broadcasts share one buffer
       std::string cookie;
       lws *wsi{};
       uint64_t sentCounter{};
@@ -125,9 +142,12 @@ private:
    bool done() const;
    bool writeNeeded(const ClientData &client) const;
    void requestWriteIfNeeded(const ClientData &client);
-   bool processSentAck(ClientData &client, uint64_t sentAckCounter);
+   bool processSentAck(const std::string &clientId, ClientData &client, uint64_t sentAckCounter);
    void processError(lws *wsi);
    void closeConnectedClient(const std::string &clientId);
+   bool queuePacket(const std::string &clientId, ClientData &client, const bs::network::WsSharedPacket &packet);
+   bool queueData(const std::string &clientId, const uint8_t *data, size_t size);
+   void forceCloseClient(const std::string &clientId);
 
    std::shared_ptr<spdlog::logger>  logger_;
    const WsServerConnectionParams params_;
@@ -141,6 +161,9 @@ private:
    std::queue<DataToSend> packets_;
    std::queue<std::string> forceClosingClients_;
 
+   // updated from listener thread
+   bs::ConcurrentHashMap<std::string, size_t> bufferedBytes_;
+
    // Fields accessible from listener thread only
    std::map<lws*, ConnectionData> connections_;
    std::map<std::string, ClientData> clients_;
@@ -23,6 +23,14 @@ namespace
 
    const std::chrono::seconds kHearthbeatCheckPeriod(1);
 
+   // smaller frames are copied by ZMQ into message itself anyway
+   const size_t kZeroCopyThreshold = 256;
+
+   void releaseSharedData(void *, void *hint)
+   {
+      delete static_cast<std::shared_ptr<const std::string> *>(hint);
+   }
+
 } // namespace
 
 ZmqServerConnection::ZmqServerConnection(
@@ -320,42 +328,128 @@ void ZmqServerConnection::notifyListenerOnClientError(const std::string &clientI
 bool ZmqServerConnection::QueueDataToSend(const std::string& clientId, const std::string& data
    , bool sendMore)
 {
+   return QueueSharedDataToSend(clientId, std::make_shared<const std::string>(data), sendMore);
+}
+
+bool ZmqServerConnection::QueueSharedDataToSend(const std::string& clientId
+   , const std::shared_ptr<const std::string>& data, bool sendMore)
+{
+   bool wakeUp = false;
+   size_t depth = 0;
    {
       FastLock locker{dataQueueLock_};
-      dataQueue_.emplace_back( DataToSend{clientId, data, sendMore});
+      dataQueue_.emplace_back(DataToSend{clientId, data, sendMore, std::chrono::steady_clock::now()});
+      depth = dataQueue_.size();
+      // listen thread takes the whole queue, so one command is enough for all
+      // packets queued until then
+      wakeUp = !sendCommandPending_;
+      sendCommandPending_ = true;
+   }
+   queuedCount_.fetch_add(1, std::memory_order_relaxed);
+   auto maxDepth = maxQueueDepth_.load(std::memory_order_relaxed);
+   while ((depth > maxDepth) && !maxQueueDepth_.compare_exchange_weak(maxDepth, depth
+      , std::memory_order_relaxed)) {}
+   if (wakeUp) {
+      wakeupCount_.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   if (!wakeUp) {
+      return true;
+   }
+   if (!SendDataCommand()) {
+      FastLock locker{dataQueueLock_};
+      sendCommandPending_ = false;  // let next packet retry
+      return false;
    }
+   return true;
+}
 
-   return SendDataCommand();
+ZmqServerConnection::SendQueueStats ZmqServerConnection::sendQueueStats() const
+{
+   SendQueueStats result;
+   {
+      std::lock_guard<std::mutex> lock(statsMutex_);
+      result = stats_;
+   }
+   result.queued = queuedCount_.load(std::memory_order_relaxed);
+   result.wakeups = wakeupCount_.load(std::memory_order_relaxed);
+   result.maxDepth = maxQueueDepth_.load(std::memory_order_relaxed);
+   // counters are read separately, so clamp transient inconsistency
+   const auto done = result.sent + result.failed;
+   result.depth = (result.queued > done) ? static_cast<size_t>(result.queued - done) : 0;
+   return result;
 }
 
 void ZmqServerConnection::onPeriodicCheck()
 {
 }
 
-void ZmqServerConnection::SendDataToDataSocket()
+bool ZmqServerConnection::SendDataFrame(const DataToSend &dataPacket)
 {
-   decltype(dataQueue_) pendingData;
+   const auto &data = *dataPacket.data;
+   const int flags = (dataPacket.sendMore ? ZMQ_SNDMORE : 0);
+   if (data.size() < kZeroCopyThreshold) {
+      return (zmq_send(dataSocket_.get(), data.data(), data.size(), flags) == static_cast<int>(data.size()));
+   }
+
+   zmq_msg_t msg;
+   auto hint = new std::shared_ptr<const std::string>(dataPacket.data);
+   if (zmq_msg_init_data(&msg, const_cast<char *>(data.data()), data.size()
+      , releaseSharedData, hint) != 0) {
+      delete hint;
+      return false;
+   }
+   if (zmq_msg_send(&msg, dataSocket_.get(), flags) == -1) {
+      zmq_msg_close(&msg);    // releases hint
+      return false;
+   }
+   return true;
+}
 
+void ZmqServerConnection::SendDataToDataSocket()
+{
    {
       FastLock locker{dataQueueLock_};
-      pendingData.swap(dataQueue_);
+      sendBatch_.swap(dataQueue_);
+      sendCommandPending_ = false;
+   }
+   if (sendBatch_.empty()) {
+      return;
    }
 
-   for (const auto &dataPacket : pendingData) {
+   uint64_t nbSent = 0, nbFailed = 0;
+   std::chrono::microseconds totalLatency{ 0 }, maxLatency{ 0 };
+
+   for (const auto &dataPacket : sendBatch_) {
+      const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+         std::chrono::steady_clock::now() - dataPacket.queuedAt);
+      totalLatency += latency;
+      maxLatency = std::max(maxLatency, latency);
+
       int result = zmq_send(dataSocket_.get(), dataPacket.clientId.c_str(), dataPacket.clientId.size(), ZMQ_SNDMORE);
       if (result != dataPacket.clientId.size()) {
          logger_->error("[{}] {} failed to send client id {}", __func__
             , connectionName_, zmq_strerror(zmq_errno()));
+         nbFailed++;
          continue;
       }
 
-      result = zmq_send(dataSocket_.get(), dataPacket.data.data(), dataPacket.data.size(), (dataPacket.sendMore ? ZMQ_SNDMORE : 0));
-      if (result != dataPacket.data.size()) {
+      if (!SendDataFrame(dataPacket)) {
          logger_->error("[{}] {} failed to send data frame {} to {}", __func__
             , connectionName_, zmq_strerror(zmq_errno()), dataPacket.clientId);
+         nbFailed++;
          continue;
       }
+      nbSent++;
    }
+   sendBatch_.clear();
+
+   std::lock_guard<std::mutex> lock(statsMutex_);
+   stats_.batches++;
+   stats_.sent += nbSent;
+   stats_.failed += nbFailed;
+   stats_.totalLatency += totalLatency;
+   stats_.maxLatency = std::max(stats_.maxLatency, maxLatency);
 }
 
 bool ZmqServerConnection::SetZMQTransport(ZMQTransport transport)
@@ -11,11 +11,13 @@
 #ifndef __ZEROMQ_SERVER_CONNECTION_H__
 #define __ZEROMQ_SERVER_CONNECTION_H__
 
+#include "FastLock.h"
 #include "ServerConnection.h"
 #include "ZmqContext.h"
 
 #include <atomic>
-#include <deque>
+#include <chrono>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -54,6 +56,20 @@ public:
 
    void setThreadName(const std::string &name);
 
+   struct SendQueueStats
+   {
+      size_t   depth{ 0 };       // queued but not yet passed to data socket
+      size_t   maxDepth{ 0 };
+      uint64_t queued{ 0 };
+      uint64_t sent{ 0 };
+      uint64_t failed{ 0 };
+      uint64_t wakeups{ 0 };     // control socket commands actually sent
+      uint64_t batches{ 0 };
+      std::chrono::microseconds  totalLatency{ 0 };   // enqueue -> data socket
+      std::chrono::microseconds  maxLatency{ 0 };
+   };
+   SendQueueStats sendQueueStats() const;
+
 protected:
    bool isActive() const;
 
@@ -73,6 +89,9 @@ protected:
    virtual void onPeriodicCheck();
 
    virtual bool QueueDataToSend(const std::string& clientId, const std::string& data, bool sendMore);
+   // data buffer is passed to ZMQ without copying and released when sent
+   bool QueueSharedDataToSend(const std::string& clientId
+      , const std::shared_ptr<const std::string>& data, bool sendMore);
 
    std::shared_ptr<spdlog::logger>  logger_;
    std::shared_ptr<ZmqContext>      context_;
@@ -104,20 +123,32 @@ private:
    struct DataToSend
    {
       std::string    clientId;
-      std::string    data;
+      std::shared_ptr<const std::string>  data;
       bool           sendMore;
+      std::chrono::steady_clock::time_point  queuedAt;
    };
 
    bool SendDataCommand();
    void SendDataToDataSocket();
+   bool SendDataFrame(const DataToSend &);
 
    std::thread                      listenThread_;
    std::atomic_flag                 controlSocketLockFlag_ = ATOMIC_FLAG_INIT;
    ZmqContext::sock_ptr             threadMasterSocket_;
    ZmqContext::sock_ptr             threadSlaveSocket_;
    ServerConnectionListener*        listener_{nullptr};
-   std::atomic_flag                 dataQueueLock_ = ATOMIC_FLAG_INIT;
-   std::deque<DataToSend>           dataQueue_;
+   AdaptiveLock                     dataQueueLock_;
+   std::vector<DataToSend>          dataQueue_;
+   bool                             sendCommandPending_{ false };   // guarded by dataQueueLock_
+   std::vector<DataToSend>          sendBatch_;    // accessed only from listen thread
+
+   // updated by producers without locking, relaxed ordering is enough for stats
+   std::atomic<uint64_t>            queuedCount_{ 0 };
+   std::atomic<uint64_t>            wakeupCount_{ 0 };
+   std::atomic<size_t>              maxQueueDepth_{ 0 };
+
+   mutable std::mutex               statsMutex_;   // guards listen thread stats only
+   SendQueueStats                   stats_;
    ZMQTransport                     zmqTransport_ = ZMQTransport::TCPTransport;
    bool        immediate_{ false };
    std::string identity_;
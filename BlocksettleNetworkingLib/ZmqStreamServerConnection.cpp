@@ -113,6 +113,19 @@ bool ZmqStreamServerConnection::sendRawData(const std::string& clientId, const s
    return true;
 }
 
+bool ZmqStreamServerConnection::sendSharedRawData(const std::string& clientId
+   , const std::shared_ptr<const std::string>& rawData)
+{
+   if (!isActive()) {
+      logger_->error("[ZmqStreamServerConnection::sendSharedRawData] cound not send. not connected");
+      return false;
+   }
+
+   QueueSharedDataToSend(clientId, rawData, true);
+
+   return true;
+}
+
 bool ZmqStreamServerConnection::SendDataToClient(const std::string& clientId, const std::string& data)
 {
    auto connection = findConnection(clientId);
@@ -131,8 +144,22 @@ bool ZmqStreamServerConnection::SendDataToAllClients(const std::string& data)
    unsigned int successCount = 0;
 
    FastLock locker(connectionsLockFlag_);
+   if (activeConnections_.empty()) {
+      return true;
+   }
+
+   // all clients of a server use the same framing, so one framed buffer
+   // is shared by all of them instead of a copy per client
+   auto rawData = activeConnections_.begin()->second->frame(data);
+   if (rawData.empty()) {
+      logger_->error("[ZmqStreamServerConnection::SendDataToAllClients] {} failed to frame {} bytes"
+         , connectionName_, data.size());
+      return false;
+   }
+   const auto sharedData = std::make_shared<const std::string>(std::move(rawData));
+
    for (auto & it : activeConnections_) {
-      const bool result = it.second->send(data);
+      const bool result = it.second->sendFramed(sharedData);
       if (result) {
          successCount++;
       }
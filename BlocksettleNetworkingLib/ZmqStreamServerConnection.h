@@ -48,6 +48,8 @@ protected:
    bool ReadFromDataSocket() override;
 
    bool sendRawData(const std::string& clientId, const std::string& rawData);
+   bool sendSharedRawData(const std::string& clientId
+      , const std::shared_ptr<const std::string>& rawData);
 
    virtual server_connection_ptr CreateActiveConnection() = 0;
 
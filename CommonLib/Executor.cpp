@@ -0,0 +1,288 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#include "Executor.h"
+#include <algorithm>
+#include <string>
+#include <spdlog/spdlog.h>
+#include "ThreadName.h"
+
+using namespace bs;
+
+namespace {
+   thread_local const Executor *tlExecutor = nullptr;
+   thread_local size_t tlWorkerIndex = 0;
+}
+
+Executor::Executor(unsigned int nbThreads, const std::shared_ptr<spdlog::logger> &logger)
+   : logger_(logger)
+{
+   if (nbThreads == 0) {
+      nbThreads = std::max(1U, std::thread::hardware_concurrency());
+   }
+   workers_.reserve(nbThreads);
+   for (unsigned int i = 0; i < nbThreads; ++i) {
+      workers_.emplace_back(std::make_unique<Worker>());
+   }
+   for (size_t i = 0; i < workers_.size(); ++i) {
+      workers_[i]->thread = std::thread(&Executor::run, this, i);
+   }
+}
+
+Executor::~Executor() noexcept
+{
+   stop();
+}
+
+std::shared_ptr<Executor> Executor::instance()
+{
+   static const auto executor = std::make_shared<Executor>();
+   return executor;
+}
+
+void Executor::post(Task &&task)
+{
+   if (!running_) {
+      return;
+   }
+   pending_++;    // before publishing, so parked workers can't miss it
+   if (tlExecutor == this) {
+      auto &worker = *workers_[tlWorkerIndex];
+      FastLock locker{ worker.lock };
+      worker.tasks.emplace_back(std::move(task));
+   }
+   else {
+      FastLock locker{ injectedLock_ };
+      injected_.emplace_back(std::move(task));
+   }
+   wakeOne();
+}
+
+void Executor::defer(Task &&task)
+{
+   if (!running_) {
+      return;
+   }
+   pending_++;
+   {
+      FastLock locker{ injectedLock_ };
+      injected_.emplace_back(std::move(task));
+   }
+   wakeOne();
+}
+
+void Executor::wakeOne()
+{
+   if (idle_.load() > 0) {
+      std::lock_guard<std::mutex> lock(parkMutex_);
+      parkCv_.notify_one();
+   }
+}
+
+void Executor::stop()
+{
+   if (!running_.exchange(false)) {
+      return;
+   }
+   {
+      std::lock_guard<std::mutex> lock(parkMutex_);
+      parkCv_.notify_all();
+   }
+   for (auto &worker : workers_) {
+      if (!worker->thread.joinable()) {
+         continue;
+      }
+      if (worker->thread.get_id() == std::this_thread::get_id()) {
+         worker->thread.detach();
+      }
+      else {
+         worker->thread.join();
+      }
+   }
+   for (auto &worker : workers_) {
+      FastLock locker{ worker->lock };
+      worker->tasks.clear();
+   }
+   FastLock locker{ injectedLock_ };
+   injected_.clear();
+}
+
+bool Executor::isWorkerThread() const
+{
+   return (tlExecutor == this);
+}
+
+bool Executor::takeTask(size_t index, Task &task)
+{
+   {
+      auto &own = *workers_[index];
+      FastLock locker{ own.lock };
+      if (!own.tasks.empty()) {
+         task = std::move(own.tasks.back());
+         own.tasks.pop_back();
+         pending_--;
+         return true;
+      }
+   }
+   {
+      FastLock locker{ injectedLock_ };
+      if (!injected_.empty()) {
+         task = std::move(injected_.front());
+         injected_.pop_front();
+         pending_--;
+         return true;
+      }
+   }
+   for (size_t i = 1; i < workers_.size(); ++i) {
+      auto &victim = *workers_[(index + i) % workers_.size()];
+      FastLock locker{ victim.lock };
+      if (!victim.tasks.empty()) {
+         task = std::move(victim.tasks.front());
+         victim.tasks.pop_front();
+         pending_--;
+         return true;
+      }
+   }
+   return false;
+}
+
+void Executor::runTask(Task &task)
+{
+   try {
+      task();
+   }
+   catch (const std::exception &e) {
+      if (logger_) {
+         logger_->error("[Executor::runTask] task failed: {}", e.what());
+      }
+   }
+   catch (...) {
+      if (logger_) {
+         logger_->error("[Executor::runTask] task failed with unknown exception");
+      }
+   }
+}
+
+void Executor::run(size_t index)
+{
+   tlExecutor = this;
+   tlWorkerIndex = index;
+   bs::setCurrentThreadName("Executor#" + std::to_string(index));
+
+   while (running_) {
+      Task task;
+      if (takeTask(index, task)) {
+         runTask(task);
+         continue;
+      }
+      std::unique_lock<std::mutex> lock(parkMutex_);
+      idle_++;
+      parkCv_.wait(lock, [this] { return (pending_.load() > 0) || !running_; });
+      idle_--;
+   }
+}
+
+
+std::shared_ptr<Strand> Strand::create(const std::shared_ptr<Executor> &executor)
+{
+   return std::shared_ptr<Strand>(new Strand(executor));
+}
+
+Strand::Strand(const std::shared_ptr<Executor> &executor)
+   : executor_(executor)
+{}
+
+bool Strand::post(Task &&task)
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopped_) {
+         return false;
+      }
+      tasks_.emplace_back(std::move(task));
+      if (scheduled_) {
+         return true;
+      }
+      scheduled_ = true;
+   }
+   executor_->post([self = shared_from_this()] { self->run(); });
+   return true;
+}
+
+void Strand::shutdown()
+{
+   std::unique_lock<std::mutex> lock(mutex_);
+   stopped_ = true;
+   tasks_.clear();
+   if (runningInThisThread()) {
+      return;
+   }
+   idleCv_.wait(lock, [this] { return !running_; });
+}
+
+bool Strand::runningInThisThread() const
+{
+   return (runningThread_.load() == std::this_thread::get_id());
+}
+
+void Strand::run()
+{
+   std::vector<Task> batch;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopped_) {
+         scheduled_ = false;
+         return;
+      }
+      const size_t nbTasks = std::min(tasks_.size(), kMaxTasksPerRun);
+      batch.reserve(nbTasks);
+      for (size_t i = 0; i < nbTasks; ++i) {
+         batch.emplace_back(std::move(tasks_.front()));
+         tasks_.pop_front();
+      }
+      running_ = true;
+      runningThread_ = std::this_thread::get_id();
+   }
+
+   std::exception_ptr error;
+   for (auto &task : batch) {
+      if (stopped_) {
+         break;
+      }
+      try {
+         task();
+      }
+      catch (...) {
+         error = std::current_exception();
+      }
+   }
+
+   bool reschedule = false;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+      runningThread_ = std::thread::id{};
+      if (stopped_ || tasks_.empty()) {
+         scheduled_ = false;
+      }
+      else {
+         reschedule = true;   // let other strands run in between
+      }
+   }
+   idleCv_.notify_all();
+
+   if (reschedule) {
+      //own deque is LIFO, posting there would pick this strand up again
+      executor_->defer([self = shared_from_this()] { self->run(); });
+   }
+   if (error) {
+      std::rethrow_exception(error);   // logged by executor
+   }
+}
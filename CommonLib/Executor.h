@@ -0,0 +1,137 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#ifndef BS_EXECUTOR_H
+#define BS_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FastLock.h"
+
+namespace spdlog {
+   class logger;
+}
+
+namespace bs {
+
+   // Shared thread pool with per-worker task deques. Tasks posted from
+   // a worker go to its own deque (taken LIFO for cache locality), others go
+   // to the common injection queue. Idle workers steal from the other end of
+   // their peers' deques before parking.
+   // No ordering is guaranteed between tasks - use Strand for that.
+   class Executor
+   {
+   public:
+      using Task = std::function<void()>;
+
+      // nbThreads = 0 means std::thread::hardware_concurrency()
+      explicit Executor(unsigned int nbThreads = 0
+         , const std::shared_ptr<spdlog::logger> &logger = nullptr);
+      ~Executor() noexcept;
+
+      Executor(const Executor&) = delete;
+      Executor& operator = (const Executor&) = delete;
+      Executor(Executor&&) = delete;
+      Executor& operator = (Executor&&) = delete;
+
+      // process-wide instance for components that opt into shared execution
+      static std::shared_ptr<Executor> instance();
+
+      void post(Task &&);
+      void post(const Task &task) { post(Task(task)); }
+
+      // always queued behind already injected tasks, even from a worker
+      // thread - for yielding without being taken back by the same worker
+      void defer(Task &&);
+
+      // pending tasks are dropped, running ones are waited for
+      void stop();
+
+      size_t nbThreads() const { return workers_.size(); }
+      bool isWorkerThread() const;
+
+   private:
+      struct Worker
+      {
+         std::thread       thread;
+         AdaptiveLock      lock;
+         std::deque<Task>  tasks;
+      };
+
+      void run(size_t index);
+      bool takeTask(size_t index, Task &);
+      void runTask(Task &);
+      void wakeOne();
+
+   private:
+      std::shared_ptr<spdlog::logger>  logger_;
+      std::vector<std::unique_ptr<Worker>>   workers_;
+      AdaptiveLock         injectedLock_;
+      std::deque<Task>     injected_;
+
+      std::atomic_bool     running_{ true };
+      std::atomic<size_t>  pending_{ 0 };
+      std::atomic<size_t>  idle_{ 0 };
+      std::mutex           parkMutex_;
+      std::condition_variable parkCv_;
+   };
+
+
+   // Runs posted tasks one at a time in FIFO order on executor's threads -
+   // a lightweight replacement for a dedicated thread per object.
+   class Strand : public std::enable_shared_from_this<Strand>
+   {
+   public:
+      using Task = Executor::Task;
+
+      static std::shared_ptr<Strand> create(const std::shared_ptr<Executor> &);
+      ~Strand() noexcept = default;
+
+      Strand(const Strand&) = delete;
+      Strand& operator = (const Strand&) = delete;
+
+      // returns false if strand is shut down
+      bool post(Task &&);
+      bool post(const Task &task) { return post(Task(task)); }
+
+      // Drops pending tasks and waits for the running one unless called from
+      // inside it. No tasks are run after it returns.
+      void shutdown();
+
+      bool runningInThisThread() const;
+
+   private:
+      explicit Strand(const std::shared_ptr<Executor> &);
+      void run();
+
+   private:
+      // limits time spent by one strand on a worker before yielding to others
+      static constexpr size_t kMaxTasksPerRun = 64;
+
+      std::shared_ptr<Executor>  executor_;
+      mutable std::mutex         mutex_;
+      std::condition_variable    idleCv_;
+      std::deque<Task>           tasks_;
+      bool                       scheduled_{ false };
+      bool                       running_{ false };
+      std::atomic_bool           stopped_{ false };
+      std::atomic<std::thread::id>  runningThread_{};
+   };
+
+}  // namespace bs
+
+#endif // BS_EXECUTOR_H
@@ -1,7 +1,7 @@
 /*
 
 ***********************************************************************************
-* Copyright (C) 2018 - 2020, BlockSettle AB
+* Copyright (C) 2018 - 2021, BlockSettle AB
 * Distributed under the GNU Affero General Public License (AGPL v3)
 * See LICENSE or http://www.gnu.org/licenses/agpl.html
 *
@@ -9,19 +9,166 @@
 
 */
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include "FastLock.h"
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace {
+   constexpr int kSpinCount = 64;      // pause-spins before yielding
+   constexpr int kYieldCount = 16;     // yields before parking (or sleeping for atomic_flag)
+
+   inline void cpuRelax()
+   {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+      _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+      asm volatile("yield" ::: "memory");
+#endif
+   }
+
+#if defined(__linux__)
+   void parkWait(std::atomic<uint32_t> &state, uint32_t expected)
+   {
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state), FUTEX_WAIT_PRIVATE
+         , expected, nullptr, nullptr, 0);
+   }
+
+   void parkWakeOne(std::atomic<uint32_t> &state)
+   {
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state), FUTEX_WAKE_PRIVATE
+         , 1, nullptr, nullptr, 0);
+   }
+#else
+   // Waiters re-check the state under bucket mutex and the unlocker changes
+   // state before taking it, so a wakeup can't be lost. Buckets may be shared
+   // by several locks, hence notify_all.
+   struct ParkingBucket
+   {
+      std::mutex              mutex;
+      std::condition_variable cv;
+   };
+
+   ParkingBucket &parkingBucket(const void *addr)
+   {
+      static ParkingBucket buckets[64];
+      return buckets[(reinterpret_cast<uintptr_t>(addr) >> 4) % 64];
+   }
+
+   void parkWait(std::atomic<uint32_t> &state, uint32_t expected)
+   {
+      auto &bucket = parkingBucket(&state);
+      std::unique_lock<std::mutex> lock(bucket.mutex);
+      if (state.load(std::memory_order_relaxed) == expected) {
+         bucket.cv.wait(lock);
+      }
+   }
+
+   void parkWakeOne(std::atomic<uint32_t> &state)
+   {
+      auto &bucket = parkingBucket(&state);
+      std::lock_guard<std::mutex> lock(bucket.mutex);
+      bucket.cv.notify_all();
+   }
+#endif
+}  // namespace
+
+
+void AdaptiveLock::lock()
+{
+   uint32_t expected = 0;
+   if (!state_.compare_exchange_strong(expected, 1, std::memory_order_acquire
+      , std::memory_order_relaxed)) {
+      lockSlow();
+   }
+}
+
+bool AdaptiveLock::try_lock()
+{
+   uint32_t expected = 0;
+   return state_.compare_exchange_strong(expected, 1, std::memory_order_acquire
+      , std::memory_order_relaxed);
+}
+
+void AdaptiveLock::lockSlow()
+{
+   for (int i = 0; i < kSpinCount + kYieldCount; ++i) {
+      if (i < kSpinCount) {
+         cpuRelax();
+      }
+      else {
+         std::this_thread::yield();
+      }
+      uint32_t state = state_.load(std::memory_order_relaxed);
+      if (state == 0) {
+         if (state_.compare_exchange_weak(state, 1, std::memory_order_acquire
+            , std::memory_order_relaxed)) {
+            return;
+         }
+      }
+      else if (state == 2) {  // others are already parked - join them
+         break;
+      }
+   }
+
+   // lock is taken with state 2 as we don't know if other waiters remain
+   while (state_.exchange(2, std::memory_order_acquire) != 0) {
+      parkWait(state_, 2);
+   }
+}
+
+void AdaptiveLock::unlock()
+{
+   if (state_.exchange(0, std::memory_order_release) == 2) {
+      parkWakeOne(state_);
+   }
+}
+
 
 FastLock::FastLock(std::atomic_flag &flag_to_lock)
-    : flag(flag_to_lock)
+    : flag(&flag_to_lock)
 {
-   while (std::atomic_flag_test_and_set_explicit(&flag, std::memory_order_acquire)) {
-      std::this_thread::sleep_for(std::chrono::microseconds(1));
+   int iteration = 0;
+   while (std::atomic_flag_test_and_set_explicit(flag, std::memory_order_acquire)) {
+      // atomic_flag can't be waited on, so bounded spin and yield are followed
+      // by short sleeps as before
+      if (iteration < kSpinCount) {
+         cpuRelax();
+         ++iteration;
+      }
+      else if (iteration < kSpinCount + kYieldCount) {
+         std::this_thread::yield();
+         ++iteration;
+      }
+      else {
+         std::this_thread::sleep_for(std::chrono::microseconds(1));
+      }
    }
 }
 
+FastLock::FastLock(AdaptiveLock &lock_to_lock)
+   : lock(&lock_to_lock)
+{
+   lock->lock();
+}
+
 FastLock::~FastLock()
 {
-   std::atomic_flag_clear_explicit(&flag, std::memory_order_release);
+   if (lock) {
+      lock->unlock();
+   }
+   else {
+      std::atomic_flag_clear_explicit(flag, std::memory_order_release);
+   }
 }
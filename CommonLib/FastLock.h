@@ -1,7 +1,7 @@
 /*
 
 ***********************************************************************************
-* Copyright (C) 2018 - 2020, BlockSettle AB
+* Copyright (C) 2018 - 2021, BlockSettle AB
 * Distributed under the GNU Affero General Public License (AGPL v3)
 * See LICENSE or http://www.gnu.org/licenses/agpl.html
 *
@@ -12,11 +12,36 @@
 #define __FAST_LOCK_H__
 
 #include <atomic>
+#include <cstdint>
+
+// Spins for a short while and then parks the thread until the owner releases
+// the lock, so contended waiters neither burn CPU nor oversleep.
+// Uses futex on Linux and a small address-keyed parking lot elsewhere.
+class AdaptiveLock
+{
+public:
+   AdaptiveLock() = default;
+
+   AdaptiveLock(const AdaptiveLock&) = delete;
+   AdaptiveLock& operator = (const AdaptiveLock&) = delete;
+
+   void lock();
+   bool try_lock();
+   void unlock();
+
+private:
+   void lockSlow();
+
+private:
+   // 0 - unlocked, 1 - locked, 2 - locked and there might be parked waiters
+   std::atomic<uint32_t>   state_{ 0 };
+};
 
 class FastLock
 {
 public:
     explicit FastLock(std::atomic_flag &);
+    explicit FastLock(AdaptiveLock &);
     ~FastLock();
 
     FastLock(const FastLock&) = delete;
@@ -25,7 +50,8 @@ public:
     FastLock(FastLock&&) = delete;
     FastLock& operator = (FastLock&&) = delete;
 private:
-     std::atomic_flag   &flag;
+     std::atomic_flag   *flag = nullptr;
+     AdaptiveLock       *lock = nullptr;
 };
 
-#endif // __FAST_LOCK_H__
\ No newline at end of file
+#endif // __FAST_LOCK_H__
@@ -11,6 +11,7 @@
 #ifndef __IDENTICAL_TIMERS_QUEUE_H__
 #define __IDENTICAL_TIMERS_QUEUE_H__
 
+#include "FastLock.h"
 #include "ManualResetEvent.h"
 
 #include <atomic>
@@ -24,6 +25,7 @@
 
 class SingleShotTimer;
 
+// Timers with the same fixed interval. See bs::TimerWheel for arbitrary timeouts.
 class IdenticalTimersQueue
 {
 public:
@@ -56,7 +58,7 @@ private:
 
    std::atomic<bool>    threadActive_;
 
-   std::atomic_flag     timersQueueLock_ = ATOMIC_FLAG_INIT;
+   AdaptiveLock         timersQueueLock_;
    std::deque<std::shared_ptr<SingleShotTimer>> activeTimers_;
 
    std::thread       waitingThread_;
@@ -9,7 +9,10 @@
 
 */
 #include "LogManager.h"
+#include <algorithm>
 #include <spdlog/spdlog.h>
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_sinks.h>
 #include "SystemFileUtils.h"
@@ -30,20 +33,24 @@ LogConfig::LogConfig()
    : pattern(LogManager::detectFormatOverride(DefaultFormat))
    , level(LogLevel::debug)
    , truncate(false)
+   , async(false)
 {
 }
 
-LogConfig::LogConfig(const std::string &fn, const std::string &ptn, const std::string &cat, const LogLevel lvl, bool trunc)
+LogConfig::LogConfig(const std::string &fn, const std::string &ptn, const std::string &cat, const LogLevel lvl
+   , bool trunc, bool async)
    : fileName(fn)
    , pattern(ptn)
    , category(cat)
    , level(lvl)
    , truncate(trunc)
+   , async(async)
 {
 }
 
-LogManager::LogManager(const OnErrorCallback &cb)
+LogManager::LogManager(const OnErrorCallback &cb, const AsyncLogConfig &asyncConfig)
    : cb_(cb)
+   , asyncConfig_(asyncConfig)
 {
    std::string override = detectFormatOverride();
    if (!override.empty()) {
@@ -53,6 +60,27 @@ LogManager::LogManager(const OnErrorCallback &cb)
    stderrSink_->set_level(spdlog::level::err);
 }
 
+LogManager::~LogManager() noexcept
+{
+   for (const auto &logger : loggers_) {
+      logger.second->flush();
+   }
+   if (defaultLogger_) {
+      defaultLogger_->flush();
+   }
+   // thread pool destructor writes out pending messages before joining
+}
+
+size_t LogManager::droppedMessages() const
+{
+   return threadPool_ ? threadPool_->overrun_counter() : 0;
+}
+
+size_t LogManager::queuedMessages() const
+{
+   return threadPool_ ? threadPool_->queue_size() : 0;
+}
+
 bool LogManager::add(const std::shared_ptr<spdlog::logger> &logger, const std::string &category)
 {
    if (!logger) {
@@ -140,7 +168,8 @@ std::shared_ptr<spdlog::logger> LogManager::create(const LogConfig &config)
    }
    const auto level = convertLevel(config.level);
    result->set_level(level);
-   result->flush_on(level);
+   // flushing each message would double the traffic through async queue
+   result->flush_on(config.async ? std::max(level, spdlog::level::warn) : level);
    return result;
 }
 
@@ -187,16 +216,35 @@ std::shared_ptr<spdlog::logger> LogManager::createOrAppend(const std::shared_ptr
    result->sinks().push_back(stderrSink_);
 #endif
 
+   if (config.async) {
+      return makeAsync(result);
+   }
    return result;
 }
 
+std::shared_ptr<spdlog::logger> LogManager::makeAsync(const std::shared_ptr<spdlog::logger> &logger)
+{
+   if (!threadPool_) {
+      threadPool_ = std::make_shared<spdlog::details::thread_pool>(
+         std::max<size_t>(asyncConfig_.queueSize, 1), std::max<size_t>(asyncConfig_.nbThreads, 1));
+   }
+   const auto policy = (asyncConfig_.overflowPolicy == LogOverflowPolicy::dropOldest)
+      ? spdlog::async_overflow_policy::overrun_oldest : spdlog::async_overflow_policy::block;
+   const auto &sinks = logger->sinks();
+   return std::make_shared<spdlog::async_logger>(logger->name(), std::begin(sinks)
+      , std::end(sinks), threadPool_, policy);
+}
+
 std::shared_ptr<spdlog::logger> LogManager::copy(const std::shared_ptr<spdlog::logger> &logger, const std::string &srcCat
    , const std::string &category)
 {
    const auto &sinks = logger->sinks();
-   const auto &result = std::make_shared<spdlog::logger>(category, std::begin(sinks), std::end(sinks));
+   std::shared_ptr<spdlog::logger> result = std::make_shared<spdlog::logger>(category, std::begin(sinks), std::end(sinks));
+   if (std::dynamic_pointer_cast<spdlog::async_logger>(logger)) {
+      result = makeAsync(result);
+   }
    result->set_level(logger->level());
-   result->flush_on(logger->level());
+   result->flush_on(logger->flush_level());
 
    const auto &itPattern = patterns_.find(srcCat);
    if ((itPattern != patterns_.end()) && !itPattern->second.empty()) {
@@ -19,6 +19,9 @@
 
 namespace spdlog {
    class logger;
+   namespace details {
+      class thread_pool;
+   }
    namespace sinks {
       class sink;
    }
@@ -43,10 +46,25 @@ namespace bs {
       std::string category;
       LogLevel    level;
       bool        truncate;
+      bool        async;      // formatting and I/O are done on LogManager's writer thread
 
       LogConfig();
       LogConfig(const std::string &fn, const std::string &ptn, const std::string &cat
-         , const LogLevel lvl = LogLevel::debug, bool trunc = false);
+         , const LogLevel lvl = LogLevel::debug, bool trunc = false, bool async = false);
+   };
+
+   enum class LogOverflowPolicy
+   {
+      block,         // caller waits for free space in the ring
+      dropOldest     // oldest queued message is overwritten and counted as dropped
+   };
+
+   // Shared by all async loggers of one LogManager
+   struct AsyncLogConfig
+   {
+      size_t            queueSize = 8192;    // messages
+      size_t            nbThreads = 1;
+      LogOverflowPolicy overflowPolicy = LogOverflowPolicy::block;
    };
 
    class LogManager
@@ -54,7 +72,8 @@ namespace bs {
    public:
       using OnErrorCallback = std::function<void(void)>;
 
-      LogManager(const OnErrorCallback &cb = nullptr);
+      LogManager(const OnErrorCallback &cb = nullptr, const AsyncLogConfig & = {});
+      ~LogManager() noexcept;
 
       bool add(const LogConfig &);
       void add(const std::vector<LogConfig> &);
@@ -62,16 +81,24 @@ namespace bs {
 
       std::shared_ptr<spdlog::logger> logger(const std::string &category = {});
 
+      // Async loggers hold only a weak reference to the writer thread, so
+      // LogManager should outlive them. Pending messages are written on destruction.
+      size_t droppedMessages() const;   // overwritten with dropOldest policy
+      size_t queuedMessages() const;
+
       // Returns spdlog format (uses BS_LOG_FORMAT env variable if set, defaultValue otherwise)
       static std::string detectFormatOverride(const std::string &defaultValue = {});
 
    private:
       std::shared_ptr<spdlog::logger> create(const LogConfig &);
       std::shared_ptr<spdlog::logger> createOrAppend(const std::shared_ptr<spdlog::logger> &, const LogConfig &);
+      std::shared_ptr<spdlog::logger> makeAsync(const std::shared_ptr<spdlog::logger> &);
       std::shared_ptr<spdlog::logger> copy(const std::shared_ptr<spdlog::logger> &, const std::string &srcCat, const std::string &category);
 
    private:
       const OnErrorCallback   cb_;
+      const AsyncLogConfig    asyncConfig_;
+      std::shared_ptr<spdlog::details::thread_pool>   threadPool_;   // created on first async logger
       std::unordered_map<std::string, std::shared_ptr<spdlog::logger>>        loggers_;
       std::unordered_map<std::string, std::shared_ptr<spdlog::sinks::sink>>   sinks_;
       std::shared_ptr<spdlog::sinks::sink> stderrSink_;
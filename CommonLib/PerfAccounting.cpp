@@ -10,6 +10,9 @@
 */
 #include "PerfAccounting.h"
 #include <spdlog/spdlog.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 using namespace bs::message;
 
@@ -17,6 +20,41 @@ static const int kQueueTime{ -1 };
 static const std::string kQTnameLong{ "Queue time" };
 static const std::string kQTnameShort{ " Q time" };
 
+static unsigned int highestBit(uint64_t value)
+{
+#if defined(_MSC_VER)
+   unsigned long result;
+   _BitScanReverse64(&result, value);
+   return static_cast<unsigned int>(result);
+#else
+   return 63 - __builtin_clzll(value);
+#endif
+}
+
+size_t PerfAccounting::Entry::bucketIndex(uint64_t value)
+{
+   if (value < kSubBuckets) {
+      return static_cast<size_t>(value);
+   }
+   if (value >= (uint64_t(1) << kMaxBits)) {
+      value = (uint64_t(1) << kMaxBits) - 1;
+   }
+   const auto msb = highestBit(value);
+   const auto shift = msb - kSubBucketBits;
+   return static_cast<size_t>((shift + 1) * kSubBuckets
+      + ((value >> shift) & (kSubBuckets - 1)));
+}
+
+uint64_t PerfAccounting::Entry::bucketUpperBound(size_t index)
+{
+   if (index < kSubBuckets) {
+      return index;
+   }
+   const auto shift = index / kSubBuckets - 1;
+   const auto lowerBound = (kSubBuckets + index % kSubBuckets) << shift;
+   return lowerBound + (uint64_t(1) << shift) - 1;
+}
+
 void PerfAccounting::Entry::add(const std::chrono::microseconds &interval)
 {
    if (!count_ || (interval < min_)) {
@@ -27,14 +65,41 @@ void PerfAccounting::Entry::add(const std::chrono::microseconds &interval)
    }
    total_ += interval;
    count_++;
+   buckets_[bucketIndex(interval.count() > 0 ? interval.count() : 0)]++;
 }
 
 void PerfAccounting::Entry::reset()
 {
    count_ = 0;
-   (void)min_.zero();
-   (void)max_.zero();
-   (void)total_.zero();
+   min_ = std::chrono::microseconds::zero();
+   max_ = std::chrono::microseconds::zero();
+   total_ = std::chrono::microseconds::zero();
+   buckets_.fill(0);
+}
+
+uint64_t PerfAccounting::Entry::percentileUs(double pct) const
+{
+   if (!count_) {
+      return 0;
+   }
+   auto target = static_cast<uint64_t>(pct / 100.0 * count_ + 0.5);
+   if (target < 1) {
+      target = 1;
+   }
+   uint64_t cumulative = 0;
+   for (size_t i = 0; i < kNbBuckets; ++i) {
+      cumulative += buckets_[i];
+      if (cumulative >= target) {
+         const auto result = bucketUpperBound(i);
+         return std::max<uint64_t>(std::min<uint64_t>(result, max_.count()), min_.count());
+      }
+   }
+   return max_.count();
+}
+
+double PerfAccounting::Entry::percentile(double pct) const
+{
+   return percentileUs(pct) / 1000.0;
 }
 
 void PerfAccounting::add(int key, const std::chrono::microseconds &interval)
@@ -54,35 +119,83 @@ void PerfAccounting::reset()
    }
 }
 
+std::chrono::microseconds PerfAccounting::percentile(int key, double pct) const
+{
+   const auto itEntry = entries_.find(key);
+   if (itEntry == entries_.end()) {
+      return std::chrono::microseconds::zero();
+   }
+   return std::chrono::microseconds(itEntry->second.percentileUs(pct));
+}
+
+std::string PerfAccounting::keyName(int key, const std::string &qName
+   , const std::map<int, std::string> &keyMapping)
+{
+   if (key == kQueueTime) {
+      if (qName.empty()) {
+         return kQTnameLong;
+      }
+      return qName + kQTnameShort;
+   }
+   const int userVal = key & ~0x1000;
+   const bool isBC = (key & 0x1000);
+   const auto itMapping = keyMapping.find(userVal);
+   const auto &name = (itMapping == keyMapping.end())
+      ? std::to_string(userVal) : itMapping->second;
+   return isBC ? "*" + name : name;
+}
+
 void PerfAccounting::report(const std::shared_ptr<spdlog::logger> &logger
    , const std::string &qName, const std::map<int, std::string> &keyMapping)
 {
    std::string output;
-   std::string name;
    for (const auto &entry : entries_) {
-      if (entry.first == kQueueTime) {
-         if (qName.empty()) {
-            name = kQTnameLong;
-         }
-         else {
-            name = qName + kQTnameShort;
-         }
-      }
-      else {
-         const int userVal = entry.first & ~0x1000;
-         const bool isBC = (entry.first & 0x1000);
-         const auto itMapping = keyMapping.find(userVal);
-         name = (itMapping == keyMapping.end())
-            ? std::to_string(userVal) : itMapping->second;
-         if (isBC) {
-            name = "*" + name;
-         }
-      }
-      output += fmt::format("\n\t{}:\t{:.3f} / {:.3f} / {:.3f}\t{}", name
+      output += fmt::format("\n\t{}:\t{:.3f} / {:.3f} / {:.3f}\t{:.3f} / {:.3f} / {:.3f}\t{}"
+         , keyName(entry.first, qName, keyMapping)
          , entry.second.min(), entry.second.avg(), entry.second.max()
-         , entry.second.count());
+         , entry.second.percentile(50), entry.second.percentile(99)
+         , entry.second.percentile(99.9), entry.second.count());
    }
-   logger->info("Performance accounting info{} [min/avg/max count] in "
+   logger->info("Performance accounting info{} [min/avg/max p50/p99/p999 count] in "
       "milliseconds (* is broadcast):{}", qName.empty() ? "" : " for " + qName
       , output);
 }
+
+static std::string jsonEscape(const std::string &str)
+{
+   std::string result;
+   result.reserve(str.size());
+   for (const char c : str) {
+      if ((c == '"') || (c == '\\')) {
+         result += '\\';
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+         continue;
+      }
+      result += c;
+   }
+   return result;
+}
+
+std::string PerfAccounting::snapshot(const std::string &qName
+   , const std::map<int, std::string> &keyMapping) const
+{
+   std::string entries;
+   for (const auto &entry : entries_) {
+      if (!entry.second.count()) {
+         continue;
+      }
+      if (!entries.empty()) {
+         entries += ",";
+      }
+      entries += fmt::format("{{\"key\":{},\"name\":\"{}\",\"count\":{}"
+         ",\"min_us\":{:.0f},\"avg_us\":{:.0f},\"max_us\":{:.0f},\"p50_us\":{}"
+         ",\"p90_us\":{},\"p99_us\":{},\"p999_us\":{}}}"
+         , entry.first, jsonEscape(keyName(entry.first, qName, keyMapping))
+         , entry.second.count(), entry.second.min() * 1000
+         , entry.second.avg() * 1000, entry.second.max() * 1000
+         , entry.second.percentileUs(50), entry.second.percentileUs(90)
+         , entry.second.percentileUs(99), entry.second.percentileUs(99.9));
+   }
+   return fmt::format("{{\"queue\":\"{}\",\"entries\":[{}]}}", jsonEscape(qName), entries);
+}
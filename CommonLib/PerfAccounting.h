@@ -11,6 +11,7 @@
 #ifndef PERF_ACCOUNTING_H
 #define PERF_ACCOUNTING_H
 
+#include <array>
 #include <chrono>
 #include <map>
 #include <memory>
@@ -29,10 +30,19 @@ namespace bs {
          void addQueueTime(const std::chrono::microseconds &interval);
          void reset();
 
+         // pct is in range (0..100], result is an upper bound with ~6% precision
+         std::chrono::microseconds percentile(int key, double pct) const;
+
          void report(const std::shared_ptr<spdlog::logger> &, const std::string &name
             , const std::map<int, std::string> &keyMapping);
 
+         // machine-readable JSON with the same data as report()
+         std::string snapshot(const std::string &name
+            , const std::map<int, std::string> &keyMapping) const;
+
       private:
+         // Log-linear histogram: values below 16us are counted exactly, the rest
+         // are split into 16 sub-buckets per power of 2 up to 2^40us
          class Entry
          {
          public:
@@ -43,14 +53,29 @@ namespace bs {
             double max() const { return max_.count() / 1000.0; }
             double avg() const { return total_.count() / 1000.0 / count_; }
             size_t count() const { return count_; }
+            double percentile(double pct) const;   // in milliseconds like the above
+            uint64_t percentileUs(double pct) const;
+
+         private:
+            static constexpr unsigned int kSubBucketBits = 4;
+            static constexpr uint64_t kSubBuckets = (1 << kSubBucketBits);
+            static constexpr unsigned int kMaxBits = 40;
+            static constexpr size_t kNbBuckets = kSubBuckets * (kMaxBits - kSubBucketBits + 1);
+
+            static size_t bucketIndex(uint64_t value);
+            static uint64_t bucketUpperBound(size_t index);
 
          private:
             size_t   count_{ 0 };
             std::chrono::microseconds  total_;
             std::chrono::microseconds  min_;
             std::chrono::microseconds  max_;
+            std::array<uint32_t, kNbBuckets> buckets_{};
          };
 
+         static std::string keyName(int key, const std::string &qName
+            , const std::map<int, std::string> &keyMapping);
+
          std::map<int, Entry> entries_;
       };
    } // namespace message
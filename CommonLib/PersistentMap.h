@@ -0,0 +1,327 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#ifndef PERSISTENT_MAP_H
+#define PERSISTENT_MAP_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace bs {
+
+   // Map with structural sharing between copies: a fixed-depth hash trie
+   // (two levels of Fanout node pointers) with small std::map buckets in
+   // leaves. Copy is O(1) - copies share all nodes. Modification clones only
+   // the path to the changed bucket if it's shared, so deriving new version
+   // costs O(changes) and previous versions stay intact.
+   //
+   // Mutable access is explicit (findMutable, operator[], emplace, erase),
+   // reads never clone. Iterators and pointers are invalidated by
+   // modification. A version that is shared with other threads should only
+   // be read, new versions are derived from it by copying.
+   // Iteration follows key hashes, not key order.
+   template<class K, class V, class Hash = std::hash<K>, class Compare = std::less<K>
+      , size_t Fanout = 64>
+   class PersistentMap
+   {
+      static_assert(Fanout > 0, "fanout should be positive");
+   public:
+      using key_type = K;
+      using mapped_type = V;
+      using Bucket = std::map<K, V, Compare>;
+      using value_type = typename Bucket::value_type;
+
+   private:
+      static constexpr size_t kLeaves = Fanout * Fanout;
+
+      using BucketPtr = std::shared_ptr<Bucket>;
+      struct Node
+      {
+         std::array<BucketPtr, Fanout> buckets;
+      };
+      using NodePtr = std::shared_ptr<Node>;
+      struct Root
+      {
+         std::array<NodePtr, Fanout> nodes;
+      };
+      using RootPtr = std::shared_ptr<Root>;
+
+      static const Bucket *bucketAt(const Root *root, size_t leaf)
+      {
+         if (!root) {
+            return nullptr;
+         }
+         const auto &node = root->nodes[leaf / Fanout];
+         return node ? node->buckets[leaf % Fanout].get() : nullptr;
+      }
+
+   public:
+      class const_iterator
+      {
+      public:
+         using iterator_category = std::forward_iterator_tag;
+         using value_type = typename PersistentMap::value_type;
+         using difference_type = std::ptrdiff_t;
+         using pointer = const value_type *;
+         using reference = const value_type &;
+
+         const_iterator() = default;
+
+         reference operator*() const { return *it_; }
+         pointer operator->() const { return &*it_; }
+
+         const_iterator &operator++()
+         {
+            ++it_;
+            settle();
+            return *this;
+         }
+         const_iterator operator++(int)
+         {
+            auto result = *this;
+            ++(*this);
+            return result;
+         }
+
+         bool operator==(const const_iterator &other) const
+         {
+            return (leaf_ == other.leaf_) && ((leaf_ == kLeaves) || (it_ == other.it_));
+         }
+         bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+      private:
+         friend class PersistentMap;
+
+         const_iterator(const Root *root, size_t leaf, const Bucket *bucket
+            , typename Bucket::const_iterator it)
+            : root_(root), leaf_(leaf), bucket_(bucket), it_(it)
+         {}
+
+         // moves forward to the first element in non-empty bucket
+         void settle()
+         {
+            while (!bucket_ || (it_ == bucket_->end())) {
+               if (++leaf_ >= kLeaves) {
+                  leaf_ = kLeaves;
+                  bucket_ = nullptr;
+                  return;
+               }
+               bucket_ = bucketAt(root_, leaf_);
+               if (bucket_) {
+                  it_ = bucket_->begin();
+               }
+            }
+         }
+
+      private:
+         const Root *root_{ nullptr };
+         size_t   leaf_{ kLeaves };
+         const Bucket *bucket_{ nullptr };
+         typename Bucket::const_iterator it_{};
+      };
+
+      PersistentMap() = default;
+
+      size_t size() const { return size_; }
+      bool empty() const { return (size_ == 0); }
+
+      const_iterator begin() const
+      {
+         if (!root_ || (size_ == 0)) {
+            return end();
+         }
+         const auto bucket = bucketAt(root_.get(), 0);
+         const_iterator result(root_.get(), 0, bucket
+            , bucket ? bucket->begin() : typename Bucket::const_iterator{});
+         result.settle();
+         return result;
+      }
+      const_iterator end() const { return {}; }
+
+      const_iterator find(const K &key) const
+      {
+         const auto leaf = leafOf(key);
+         const auto bucket = bucketAt(root_.get(), leaf);
+         if (!bucket) {
+            return end();
+         }
+         const auto it = bucket->find(key);
+         if (it == bucket->end()) {
+            return end();
+         }
+         return const_iterator(root_.get(), leaf, bucket, it);
+      }
+
+      size_t count(const K &key) const { return (find(key) == end()) ? 0 : 1; }
+
+      // Pointer is valid until next modification of the map
+      V *findMutable(const K &key)
+      {
+         const auto leaf = leafOf(key);
+         const auto bucket = bucketAt(root_.get(), leaf);
+         if (!bucket || (bucket->find(key) == bucket->end())) {
+            return nullptr;
+         }
+         return &mutableBucket(leaf).find(key)->second;
+      }
+
+      V &operator[](const K &key)
+      {
+         return *emplace(key).first;
+      }
+
+      // Doesn't overwrite existing value, like std::map::emplace
+      template<class... Args>
+      std::pair<V *, bool> emplace(const K &key, Args&&... args)
+      {
+         const auto leaf = leafOf(key);
+         const auto bucket = bucketAt(root_.get(), leaf);
+         if (bucket) {
+            const auto it = bucket->find(key);
+            if (it != bucket->end()) {
+               return { &mutableBucket(leaf).find(key)->second, false };
+            }
+         }
+         auto result = mutableBucket(leaf).emplace(std::piecewise_construct
+            , std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+         ++size_;
+         return { &result.first->second, true };
+      }
+
+      bool erase(const K &key)
+      {
+         const auto leaf = leafOf(key);
+         const auto bucket = bucketAt(root_.get(), leaf);
+         if (!bucket || (bucket->find(key) == bucket->end())) {
+            return false;
+         }
+         auto &mutBucket = mutableBucket(leaf);
+         mutBucket.erase(key);
+         --size_;
+         if (mutBucket.empty()) {
+            root_->nodes[leaf / Fanout]->buckets[leaf % Fanout].reset();
+         }
+         return true;
+      }
+
+      void clear()
+      {
+         root_.reset();
+         size_ = 0;
+      }
+
+      // Calls cb(key, const V *baseValue, const V *value) for keys that were
+      // added (baseValue is null), erased (value is null) or could have been
+      // modified since this version was derived from base - values in cloned
+      // buckets are reported even if they are equal, caller should compare.
+      // Nodes shared with base are skipped, so cost is proportional to the
+      // changes, not to the map size. Works against any version, e.g. an
+      // empty map reports all entries as added.
+      template<class F>
+      void diff(const PersistentMap &base, const F &cb) const
+      {
+         if (root_ == base.root_) {
+            return;
+         }
+         for (size_t i = 0; i < Fanout; ++i) {
+            const Node *node = root_ ? root_->nodes[i].get() : nullptr;
+            const Node *baseNode = base.root_ ? base.root_->nodes[i].get() : nullptr;
+            if (node == baseNode) {
+               continue;
+            }
+            for (size_t j = 0; j < Fanout; ++j) {
+               const Bucket *bucket = node ? node->buckets[j].get() : nullptr;
+               const Bucket *baseBucket = baseNode ? baseNode->buckets[j].get() : nullptr;
+               if (bucket != baseBucket) {
+                  diffBuckets(baseBucket, bucket, cb);
+               }
+            }
+         }
+      }
+
+   private:
+      template<class F>
+      static void diffBuckets(const Bucket *base, const Bucket *bucket, const F &cb)
+      {
+         static const Bucket empty;
+         if (!base) {
+            base = &empty;
+         }
+         if (!bucket) {
+            bucket = &empty;
+         }
+         const Compare less{};
+         auto it = bucket->begin();
+         auto baseIt = base->begin();
+         while ((it != bucket->end()) || (baseIt != base->end())) {
+            if ((baseIt == base->end())
+               || ((it != bucket->end()) && less(it->first, baseIt->first))) {
+               cb(it->first, nullptr, &it->second);
+               ++it;
+            }
+            else if ((it == bucket->end()) || less(baseIt->first, it->first)) {
+               cb(baseIt->first, &baseIt->second, nullptr);
+               ++baseIt;
+            }
+            else {
+               cb(it->first, &baseIt->second, &it->second);
+               ++it;
+               ++baseIt;
+            }
+         }
+      }
+
+      static size_t leafOf(const K &key)
+      {
+         // multiplicative mixing in case Hash is identity (e.g. for integers)
+         const auto hash = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ULL;
+         return static_cast<size_t>(hash >> 32) % kLeaves;
+      }
+
+      // Clones shared nodes on the path, so the bucket is owned only by this map
+      Bucket &mutableBucket(size_t leaf)
+      {
+         if (!root_) {
+            root_ = std::make_shared<Root>();
+         }
+         else if (root_.use_count() > 1) {
+            root_ = std::make_shared<Root>(*root_);
+         }
+         auto &node = root_->nodes[leaf / Fanout];
+         if (!node) {
+            node = std::make_shared<Node>();
+         }
+         else if (node.use_count() > 1) {
+            node = std::make_shared<Node>(*node);
+         }
+         auto &bucket = node->buckets[leaf % Fanout];
+         if (!bucket) {
+            bucket = std::make_shared<Bucket>();
+         }
+         else if (bucket.use_count() > 1) {
+            bucket = std::make_shared<Bucket>(*bucket);
+         }
+         return *bucket;
+      }
+
+   private:
+      RootPtr  root_;
+      size_t   size_{ 0 };
+   };
+
+}  // namespace bs
+
+#endif // PERSISTENT_MAP_H
@@ -12,15 +12,105 @@
 #ifndef __PROCESSING_THREAD_H__
 #define __PROCESSING_THREAD_H__
 
+#include <algorithm>
 #include <atomic>
-#include <memory>
-#include <queue>
+#include <chrono>
+#include <mutex>
 #include <thread>
 #include <type_traits>
+#include <vector>
 
+#include "Executor.h"
 #include "FastLock.h"
 #include "ManualResetEvent.h"
 
+// Optional statistics of batched processing loops, collected per wakeup.
+// Latency is the time the oldest item of a batch spent in queue.
+struct ProcessingBatchStats
+{
+   uint64_t batches{ 0 };
+   uint64_t items{ 0 };
+   size_t   maxBatchSize{ 0 };
+   std::chrono::microseconds  totalLatency{ 0 };
+   std::chrono::microseconds  maxLatency{ 0 };
+   std::chrono::microseconds  processingTime{ 0 };
+
+   void add(size_t batchSize, const std::chrono::microseconds &latency
+      , const std::chrono::microseconds &elapsed)
+   {
+      batches++;
+      items += batchSize;
+      maxBatchSize = std::max(maxBatchSize, batchSize);
+      totalLatency += latency;
+      maxLatency = std::max(maxLatency, latency);
+      processingTime += elapsed;
+   }
+
+   double avgBatchSize() const { return batches ? (double)items / batches : 0; }
+};
+
+// Thread-safe holder of ProcessingBatchStats - doesn't touch the clock when disabled
+class ProcessingBatchMetrics
+{
+public:
+   using Clock = std::chrono::steady_clock;
+
+   void enable(bool on) { enabled_ = on; }
+   bool enabled() const { return enabled_; }
+
+   ProcessingBatchStats stats() const
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return stats_;
+   }
+
+   void reset()
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_ = {};
+   }
+
+   // should be called under queue lock when adding to empty queue
+   void markFirstQueued()
+   {
+      if (enabled_) {
+         firstQueued_ = Clock::now();
+      }
+   }
+
+   // should be called under queue lock when taking the batch
+   Clock::time_point takeFirstQueued()
+   {
+      const auto result = firstQueued_;
+      firstQueued_ = {};
+      return result;
+   }
+
+   void add(size_t batchSize, const Clock::time_point &firstQueued
+      , const Clock::time_point &started)
+   {
+      if (!enabled_ || !batchSize) {
+         return;
+      }
+      const auto timeNow = Clock::now();
+      const auto latency = (firstQueued == Clock::time_point{}) ? std::chrono::microseconds{}
+         : std::chrono::duration_cast<std::chrono::microseconds>(started - firstQueued);
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.add(batchSize, latency
+         , std::chrono::duration_cast<std::chrono::microseconds>(timeNow - started));
+   }
+
+private:
+   std::atomic_bool     enabled_{ false };
+   Clock::time_point    firstQueued_;     // guarded by owner's queue lock
+   mutable std::mutex   mutex_;
+   ProcessingBatchStats stats_;
+};
+
+// Packets are stored by value. Processing thread takes all pending packets
+// under one lock and processes them without further synchronization.
+// If constructed with executor, batches are processed on its strand instead
+// of a dedicated thread.
 template <typename T>
 class ProcessingThread
 {
@@ -32,10 +122,17 @@ public:
 
    }
 
+   explicit ProcessingThread(const std::shared_ptr<bs::Executor> &executor)
+      : strand_(bs::Strand::create(executor))
+   {}
+
    virtual ~ProcessingThread() noexcept
    {
       haltProcessing();
       continueExecution_ = false;
+      if (strand_) {
+         strand_->shutdown();
+      }
       pendingPacketsEvent_.SetEvent();
       if (processingThread_.joinable()) {
          processingThread_.join();
@@ -50,10 +147,31 @@ public:
 
    void SchedulePacketProcessing(const T& packet)
    {
-      if (!processingHalted_) {
+      SchedulePacketProcessing(T(packet));
+   }
+
+   void SchedulePacketProcessing(T&& packet)
+   {
+      if (processingHalted_) {
+         return;
+      }
+      bool postToStrand = false;
+      {
          FastLock locker{pendingPacketsLock_};
-         pendingPackets_.emplace(std::make_shared<T>(packet));
-         pendingPacketsEvent_.SetEvent();
+         if (pendingPackets_.empty()) {
+            batchMetrics_.markFirstQueued();
+         }
+         pendingPackets_.emplace_back(std::move(packet));
+         if (!strand_) {
+            pendingPacketsEvent_.SetEvent();
+         }
+         else if (!batchPosted_) {
+            batchPosted_ = true;
+            postToStrand = true;
+         }
+      }
+      if (postToStrand) {
+         strand_->post([this] { processPending(strandBatch_); });
       }
    }
 
@@ -70,53 +188,69 @@ public:
       processingHalted_ = false;
    }
 
+   void enableBatchStats(bool on = true) { batchMetrics_.enable(on); }
+   ProcessingBatchStats batchStats() const { return batchMetrics_.stats(); }
+   void resetBatchStats() { batchMetrics_.reset(); }
+
 private:
    void cleanQueue()
    {
       FastLock locker{pendingPacketsLock_};
-      decltype(pendingPackets_) cleanQueue;
-      pendingPackets_.swap(cleanQueue);
+      pendingPackets_.clear();
    }
 
 private:
    void processingLoop()
    {
+      std::vector<T> batch;   // reused to avoid reallocations
+
       while (continueExecution_) {
          pendingPacketsEvent_.WaitForEvent();
 
          if (!continueExecution_) {
             break;
          }
+         processPending(batch);
+      }
+   }
 
-         std::shared_ptr<T> packet;
-
-         {
-            FastLock locker{pendingPacketsLock_};
-
-            if (!pendingPackets_.empty()) {
-               packet = pendingPackets_.front();
-               pendingPackets_.pop();
-            }
-
-            if (pendingPackets_.empty()) {
-               pendingPacketsEvent_.ResetEvent();
-            }
-         }
+   void processPending(std::vector<T> &batch)
+   {
+      ProcessingBatchMetrics::Clock::time_point firstQueued;
+      {
+         FastLock locker{pendingPacketsLock_};
+         pendingPackets_.swap(batch);
+         firstQueued = batchMetrics_.takeFirstQueued();
+         batchPosted_ = false;
+         pendingPacketsEvent_.ResetEvent();
+      }
 
-         if (packet == nullptr) {
-            continue;
+      const auto started = batchMetrics_.enabled()
+         ? ProcessingBatchMetrics::Clock::now() : ProcessingBatchMetrics::Clock::time_point{};
+      size_t nbProcessed = 0;
+      for (const auto &packet : batch) {
+         if (!continueExecution_ || processingHalted_) {
+            break;   // the rest is dropped as cleanQueue() would do
          }
-         processPacket(*packet);
+         processPacket(packet);
+         nbProcessed++;
       }
+      batchMetrics_.add(nbProcessed, firstQueued, started);
+      batch.clear();
    }
 
 private:
    std::thread processingThread_;
    std::atomic_bool                       continueExecution_{ true };
    std::atomic_bool                       processingHalted_{ false };
-   mutable std::atomic_flag               pendingPacketsLock_ = ATOMIC_FLAG_INIT;
+   mutable AdaptiveLock                   pendingPacketsLock_;
    ManualResetEvent                       pendingPacketsEvent_;
-   std::queue<std::shared_ptr<T>>         pendingPackets_;
+   std::vector<T>                         pendingPackets_;
+   ProcessingBatchMetrics                 batchMetrics_;
+
+   std::shared_ptr<bs::Strand>            strand_;
+   bool                                   batchPosted_{ false };  // guarded by pendingPacketsLock_
+   std::vector<T>                         strandBatch_;
 };
 
 #endif // __PROCESSING_THREAD_H__
@@ -11,8 +11,13 @@
 #ifndef THREAD_SAFE_CONTAINERS_H
 #define THREAD_SAFE_CONTAINERS_H
 
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace bs {
 
@@ -50,6 +55,284 @@ namespace bs {
       std::unordered_map<K, V> data_;
    };
 
+   namespace detail {
+      // spreads std::hash (identity for integers) over shards
+      inline size_t shardIndex(size_t hash, size_t nbShards)
+      {
+         return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 40) % nbShards;
+      }
+   }
+
+   // Lock-striped hash map: keys are spread over NbShards independent maps,
+   // each with its own mutex, so unrelated keys don't contend.
+   // Values are returned by copy - references can't outlive shard lock.
+   // Callbacks of erase_if/for_each are invoked under shard lock and shouldn't
+   // access the same map.
+   template<class K, class V, class Hash = std::hash<K>, size_t NbShards = 16>
+   class ConcurrentHashMap
+   {
+      static_assert(NbShards > 0, "at least one shard is required");
+   public:
+      std::optional<V> find(const K &key) const
+      {
+         const auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         const auto it = shard.data.find(key);
+         if (it == shard.data.end()) {
+            return std::nullopt;
+         }
+         return it->second;
+      }
+
+      bool contains(const K &key) const
+      {
+         const auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         return (shard.data.find(key) != shard.data.end());
+      }
+
+      // returns true if inserted, false if assigned
+      bool insert_or_assign(const K &key, V value)
+      {
+         auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         return shard.data.insert_or_assign(key, std::move(value)).second;
+      }
+
+      // doesn't overwrite existing value
+      bool insert(const K &key, V value)
+      {
+         auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         return shard.data.emplace(key, std::move(value)).second;
+      }
+
+      bool erase(const K &key)
+      {
+         auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         return (shard.data.erase(key) > 0);
+      }
+
+      // pred(const K &, V &) -> bool, returns number of erased entries
+      template<class Pred>
+      size_t erase_if(Pred pred)
+      {
+         size_t result = 0;
+         for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.data.begin(); it != shard.data.end(); ) {
+               if (pred(it->first, it->second)) {
+                  it = shard.data.erase(it);
+                  result++;
+               }
+               else {
+                  ++it;
+               }
+            }
+         }
+         return result;
+      }
+
+      // f(const K &, V &) - shard by shard, not an atomic snapshot of whole map
+      template<class F>
+      void for_each(F f)
+      {
+         for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto &entry : shard.data) {
+               f(entry.first, entry.second);
+            }
+         }
+      }
+
+      template<class F>
+      void for_each(F f) const
+      {
+         for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto &entry : shard.data) {
+               f(entry.first, entry.second);
+            }
+         }
+      }
+
+      size_t size() const
+      {
+         size_t result = 0;
+         for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result += shard.data.size();
+         }
+         return result;
+      }
+
+      bool empty() const { return (size() == 0); }
+
+      void clear()
+      {
+         for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.data.clear();
+         }
+      }
+
+      // ThreadSafeMap-compatible interface
+      void put(K key, V value)
+      {
+         insert_or_assign(key, std::move(value));
+      }
+
+      V take(const K &key)
+      {
+         auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         auto it = shard.data.find(key);
+         if (it == shard.data.end()) {
+            return V{};
+         }
+         auto result = std::move(it->second);
+         shard.data.erase(it);
+         return result;
+      }
+
+      std::unordered_map<K, V, Hash> takeAll()
+      {
+         std::unordered_map<K, V, Hash> result;
+         for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (result.empty()) {
+               result = std::move(shard.data);
+               shard.data.clear();
+            }
+            else {
+               for (auto &entry : shard.data) {
+                  result.emplace(entry.first, std::move(entry.second));
+               }
+               shard.data.clear();
+            }
+         }
+         return result;
+      }
+
+   private:
+      struct alignas(64) Shard   // avoid false sharing between shard mutexes
+      {
+         mutable std::mutex mutex;
+         std::unordered_map<K, V, Hash> data;
+      };
+
+      Shard &shardFor(const K &key)
+      {
+         return shards_[detail::shardIndex(Hash{}(key), NbShards)];
+      }
+      const Shard &shardFor(const K &key) const
+      {
+         return shards_[detail::shardIndex(Hash{}(key), NbShards)];
+      }
+
+   private:
+      std::array<Shard, NbShards> shards_;
+   };
+
+   template<class K, class Hash = std::hash<K>, size_t NbShards = 16>
+   class ConcurrentHashSet
+   {
+      static_assert(NbShards > 0, "at least one shard is required");
+   public:
+      bool contains(const K &key) const
+      {
+         const auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         return (shard.data.find(key) != shard.data.end());
+      }
+
+      // returns false if already present
+      bool insert(K key)
+      {
+         auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         return shard.data.insert(std::move(key)).second;
+      }
+
+      bool erase(const K &key)
+      {
+         auto &shard = shardFor(key);
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         return (shard.data.erase(key) > 0);
+      }
+
+      // pred(const K &) -> bool, returns number of erased entries
+      template<class Pred>
+      size_t erase_if(Pred pred)
+      {
+         size_t result = 0;
+         for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.data.begin(); it != shard.data.end(); ) {
+               if (pred(*it)) {
+                  it = shard.data.erase(it);
+                  result++;
+               }
+               else {
+                  ++it;
+               }
+            }
+         }
+         return result;
+      }
+
+      template<class F>
+      void for_each(F f) const
+      {
+         for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto &key : shard.data) {
+               f(key);
+            }
+         }
+      }
+
+      size_t size() const
+      {
+         size_t result = 0;
+         for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result += shard.data.size();
+         }
+         return result;
+      }
+
+      bool empty() const { return (size() == 0); }
+
+      void clear()
+      {
+         for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.data.clear();
+         }
+      }
+
+   private:
+      struct alignas(64) Shard
+      {
+         mutable std::mutex mutex;
+         std::unordered_set<K, Hash> data;
+      };
+
+      Shard &shardFor(const K &key)
+      {
+         return shards_[detail::shardIndex(Hash{}(key), NbShards)];
+      }
+      const Shard &shardFor(const K &key) const
+      {
+         return shards_[detail::shardIndex(Hash{}(key), NbShards)];
+      }
+
+   private:
+      std::array<Shard, NbShards> shards_;
+   };
+
 }
 
 #endif // THREAD_SAFE_CONTAINERS_H
@@ -0,0 +1,239 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#include "TimerWheel.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include "ThreadName.h"
+
+using namespace bs;
+
+namespace {
+   uint64_t roundUpPow2(size_t value)
+   {
+      uint64_t result = 1;
+      while (result < value) {
+         result <<= 1;
+      }
+      return result;
+   }
+}
+
+TimerWheel::TimerWheel(const std::shared_ptr<spdlog::logger> &logger
+   , std::chrono::milliseconds tick, size_t nbSlots)
+   : logger_(logger)
+   , tick_(std::max(tick, std::chrono::milliseconds{ 1 }))
+   , mask_(roundUpPow2(std::max<size_t>(nbSlots, 2)) - 1)
+   , start_(Clock::now())
+{
+   slots_.assign(mask_ + 1, kNone);
+   thread_ = std::thread(&TimerWheel::run, this);
+}
+
+TimerWheel::~TimerWheel() noexcept
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+   }
+   cv_.notify_one();
+   if (thread_.joinable()) {
+      thread_.join();
+   }
+}
+
+void TimerWheel::setBatchDispatcher(const BatchDispatcher &dispatcher)
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   dispatcher_ = dispatcher;
+}
+
+uint64_t TimerWheel::tickAt(const Clock::time_point &timePoint) const
+{
+   return (timePoint - start_) / tick_;
+}
+
+TimerWheel::Handle TimerWheel::activate(std::chrono::milliseconds timeout, Callback &&cb)
+{
+   const auto expireTime = Clock::now() + timeout;
+   Handle handle;
+   bool wasIdle = false;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!running_) {
+         return handle;
+      }
+      const auto index = allocNode();
+      auto &node = nodes_[index];
+      node.cb = std::move(cb);
+      // round up - timer never fires before its timeout
+      const auto sinceStart = expireTime - start_;
+      node.deadline = (sinceStart + tick_ - Clock::duration{ 1 }) / tick_;
+      node.deadline = std::max(node.deadline, processedTick_ + 1);
+      node.active = true;
+      link(index);
+
+      wasIdle = (nbActive_++ == 0);
+      handle.index = index;
+      handle.generation = node.generation;
+   }
+   if (wasIdle) {
+      cv_.notify_one();
+   }
+   return handle;
+}
+
+bool TimerWheel::cancel(const Handle &handle)
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   if (!handle.isValid() || (handle.index >= nodes_.size())) {
+      return false;
+   }
+   auto &node = nodes_[handle.index];
+   if (!node.active || (node.generation != handle.generation)) {
+      return false;
+   }
+   unlink(handle.index);
+   freeNode(handle.index);
+   nbActive_--;
+   return true;
+}
+
+bool TimerWheel::isActive(const Handle &handle) const
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   if (!handle.isValid() || (handle.index >= nodes_.size())) {
+      return false;
+   }
+   const auto &node = nodes_[handle.index];
+   return (node.active && (node.generation == handle.generation));
+}
+
+size_t TimerWheel::activeCount() const
+{
+   std::lock_guard<std::mutex> lock(mutex_);
+   return nbActive_;
+}
+
+uint32_t TimerWheel::allocNode()
+{
+   if (freeList_ != kNone) {
+      const auto index = freeList_;
+      freeList_ = nodes_[index].next;
+      nodes_[index].next = kNone;
+      return index;
+   }
+   nodes_.emplace_back();
+   return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TimerWheel::freeNode(uint32_t index)
+{
+   auto &node = nodes_[index];
+   node.cb = nullptr;
+   node.active = false;
+   node.generation++;     // invalidates outstanding handles
+   node.prev = kNone;
+   node.next = freeList_;
+   freeList_ = index;
+}
+
+void TimerWheel::link(uint32_t index)
+{
+   auto &node = nodes_[index];
+   auto &head = slots_[node.deadline & mask_];
+   node.prev = kNone;
+   node.next = head;
+   if (head != kNone) {
+      nodes_[head].prev = index;
+   }
+   head = index;
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+   auto &node = nodes_[index];
+   if (node.prev != kNone) {
+      nodes_[node.prev].next = node.next;
+   }
+   else {
+      slots_[node.deadline & mask_] = node.next;
+   }
+   if (node.next != kNone) {
+      nodes_[node.next].prev = node.prev;
+   }
+   node.prev = node.next = kNone;
+}
+
+void TimerWheel::collectExpired(uint64_t nowTick, std::vector<Callback> &expired)
+{
+   // after a long sleep each slot is visited only once
+   const auto nbTicks = std::min(nowTick - processedTick_, mask_ + 1);
+   for (uint64_t tick = processedTick_ + 1; tick <= processedTick_ + nbTicks; ++tick) {
+      auto index = slots_[tick & mask_];
+      while (index != kNone) {
+         const auto next = nodes_[index].next;
+         if (nodes_[index].deadline <= nowTick) {    // others are due in later rounds
+            expired.emplace_back(std::move(nodes_[index].cb));
+            unlink(index);
+            freeNode(index);
+            nbActive_--;
+         }
+         index = next;
+      }
+   }
+   processedTick_ = nowTick;
+}
+
+void TimerWheel::dispatch(const BatchDispatcher &dispatcher, std::vector<Callback> &&expired)
+{
+   if (dispatcher) {
+      dispatcher(std::move(expired));
+      return;
+   }
+   for (auto &cb : expired) {
+      try {
+         cb();
+      }
+      catch (const std::exception &e) {
+         if (logger_) {
+            logger_->error("[TimerWheel::dispatch] timer callback failed: {}", e.what());
+         }
+      }
+   }
+}
+
+void TimerWheel::run()
+{
+   bs::setCurrentThreadName("TimerWheel");
+   std::vector<Callback> expired;
+
+   std::unique_lock<std::mutex> lock(mutex_);
+   while (running_) {
+      if (nbActive_ == 0) {
+         cv_.wait(lock, [this] { return !running_ || (nbActive_ > 0); });
+         continue;
+      }
+      const auto nowTick = tickAt(Clock::now());
+      if (nowTick <= processedTick_) {
+         cv_.wait_until(lock, start_ + tick_ * (processedTick_ + 1));
+         continue;
+      }
+      collectExpired(nowTick, expired);
+      if (expired.empty()) {
+         continue;
+      }
+      const auto dispatcher = dispatcher_;
+      lock.unlock();
+      dispatch(dispatcher, std::move(expired));
+      expired.clear();
+      lock.lock();
+   }
+}
@@ -0,0 +1,116 @@
+/*
+
+***********************************************************************************
+* Copyright (C) 2021, BlockSettle AB
+* Distributed under the GNU Affero General Public License (AGPL v3)
+* See LICENSE or http://www.gnu.org/licenses/agpl.html
+*
+**********************************************************************************
+
+*/
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spdlog {
+   class logger;
+}
+
+namespace bs {
+
+   // Hashed timing wheel driven by its own thread. Unlike IdenticalTimersQueue
+   // each timer has its own timeout. Activation and cancellation are O(1) via
+   // handles, timeouts are rounded up to the tick.
+   // Timers expired in the same tick are collected and dispatched together
+   // outside of the lock - inline on wheel thread by default.
+   class TimerWheel
+   {
+   public:
+      using Clock = std::chrono::steady_clock;
+      using Callback = std::function<void()>;
+      using BatchDispatcher = std::function<void(std::vector<Callback> &&)>;
+
+      struct Handle
+      {
+         uint32_t index{ UINT32_MAX };
+         uint32_t generation{ 0 };
+
+         bool isValid() const { return (index != UINT32_MAX); }
+      };
+
+      TimerWheel(const std::shared_ptr<spdlog::logger> &
+         , std::chrono::milliseconds tick = std::chrono::milliseconds{ 10 }
+         , size_t nbSlots = 1024);
+      ~TimerWheel() noexcept;
+
+      TimerWheel(const TimerWheel&) = delete;
+      TimerWheel& operator = (const TimerWheel&) = delete;
+      TimerWheel(TimerWheel&&) = delete;
+      TimerWheel& operator = (TimerWheel&&) = delete;
+
+      // could be used to post expired batch to Executor, for example
+      // should be set before activating timers
+      void setBatchDispatcher(const BatchDispatcher &);
+
+      Handle activate(std::chrono::milliseconds timeout, Callback &&);
+
+      // returns false if timer already expired or was cancelled
+      // callback could still run if it was already taken for dispatching
+      bool cancel(const Handle &);
+
+      bool isActive(const Handle &) const;
+      size_t activeCount() const;
+
+   private:
+      static constexpr uint32_t kNone = UINT32_MAX;
+
+      struct Node
+      {
+         Callback cb;
+         uint64_t deadline{ 0 };    // in ticks
+         uint32_t prev{ kNone };
+         uint32_t next{ kNone };
+         uint32_t generation{ 0 };
+         bool     active{ false };
+      };
+
+      void run();
+      uint64_t tickAt(const Clock::time_point &) const;
+      uint32_t allocNode();
+      void freeNode(uint32_t index);
+      void link(uint32_t index);
+      void unlink(uint32_t index);
+      void collectExpired(uint64_t nowTick, std::vector<Callback> &);
+      void dispatch(const BatchDispatcher &, std::vector<Callback> &&);
+
+   private:
+      std::shared_ptr<spdlog::logger>  logger_;
+      const Clock::duration   tick_;
+      const uint64_t          mask_;
+      const Clock::time_point start_;
+
+      mutable std::mutex      mutex_;
+      std::condition_variable cv_;
+      std::vector<Node>       nodes_;
+      std::vector<uint32_t>   slots_;     // list heads
+      uint32_t                freeList_{ kNone };
+      size_t                  nbActive_{ 0 };
+      uint64_t                processedTick_{ 0 };
+      BatchDispatcher         dispatcher_;
+      bool                    running_{ true };
+
+      std::thread             thread_;
+   };
+
+}  // namespace bs
+
+#endif // __TIMER_WHEEL_H__